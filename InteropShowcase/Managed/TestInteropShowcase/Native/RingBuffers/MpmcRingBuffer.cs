@@ -0,0 +1,65 @@
+﻿
+using System.Runtime.InteropServices;
+
+
+namespace michele.natale.RingBufferNative;
+
+
+
+/// <summary>
+/// Provides managed wrappers for the native multi‑producer/multi‑consumer ring buffer.
+/// The buffer is message based: every write occupies one fixed‑size slot and every
+/// read returns exactly one message. Any number of threads may write and read
+/// concurrently without a managed lock.
+/// </summary>
+internal static partial class MpmcRingBuffer
+{
+  private const string DllName = "InteropShowcaseLib.dll";
+
+  /// <summary>
+  /// Creates a new native MPMC ring buffer.
+  /// </summary>
+  /// <param name="slotCount">The minimum number of messages (rounded up to a power of two).</param>
+  /// <param name="slotSize">The maximum payload size of a single message in bytes.</param>
+  /// <returns>A pointer to the new ring buffer, or <see cref="IntPtr.Zero"/> on failure.</returns>
+  [LibraryImport(DllName, EntryPoint = "mpmc_rb_create")]
+  public static partial IntPtr Create(uint slotCount, uint slotSize);
+
+  /// <summary>
+  /// Frees a previously created native MPMC ring buffer.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer to free.</param>
+  [LibraryImport(DllName, EntryPoint = "mpmc_rb_free")]
+  public static partial void Free(IntPtr rb);
+
+  /// <summary>
+  /// Writes one message into the ring buffer.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <param name="data">The message payload.</param>
+  /// <param name="length">The payload length in bytes (at least 1).</param>
+  /// <returns>The number of bytes written, or 0 if the ring is full or the message too large or empty.</returns>
+  [LibraryImport(DllName, EntryPoint = "mpmc_rb_write")]
+  public static partial uint Write(IntPtr rb, ReadOnlySpan<byte> data, uint length);
+
+  /// <summary>
+  /// Reads one message from the ring buffer.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <param name="dest">The destination buffer (at least <see cref="SlotSize"/> bytes).</param>
+  /// <param name="length">The size of the destination buffer.</param>
+  /// <returns>
+  /// The number of bytes read, or 0 if the ring is empty. A result greater than
+  /// <paramref name="length"/> is the size of the next message, which stays in the ring.
+  /// </returns>
+  [LibraryImport(DllName, EntryPoint = "mpmc_rb_read")]
+  public static partial uint Read(IntPtr rb, Span<byte> dest, uint length);
+
+  /// <summary>
+  /// Gets the maximum payload size of a single message.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <returns>The slot payload size in bytes.</returns>
+  [LibraryImport(DllName, EntryPoint = "mpmc_rb_slot_size")]
+  public static partial uint SlotSize(IntPtr rb);
+}
@@ -24,6 +24,68 @@ internal static partial class RingBuffer
     public IntPtr Ptr;
   }
 
+  /// <summary>
+  /// Describes a region inside the native ring buffer storage, as handed out
+  /// by <see cref="Reserve"/> and <see cref="Peek"/>. A region that wraps
+  /// around the end of the buffer consists of two contiguous parts.
+  /// </summary>
+  [StructLayout(LayoutKind.Sequential)]
+  public struct RbSpan
+  {
+    public IntPtr First;
+    public uint FirstLength;
+    public IntPtr Second;
+    public uint SecondLength;
+  }
+
+  /// <summary>
+  /// Describes one (pointer, length) segment for <see cref="WriteV"/> and <see cref="ReadV"/>.
+  /// The memory must stay pinned for the duration of the call.
+  /// </summary>
+  [StructLayout(LayoutKind.Sequential)]
+  public struct RbSegment
+  {
+    public IntPtr Data;
+    public uint Length;
+  }
+
+  /// <summary>
+  /// Storage options for <see cref="CreateEx"/>. Each option is a request;
+  /// <see cref="AllocGranted"/> reports what the OS actually granted.
+  /// </summary>
+  [Flags]
+  public enum AllocFlags : uint
+  {
+    Default = 0,
+    Huge2M = 1u << 0,
+    Huge1G = 1u << 1,
+    Prefault = 1u << 2,
+    NumaBind = 1u << 3,
+  }
+
+  /// <summary>
+  /// What <see cref="WriteEx"/> does when a message does not fit.
+  /// Apart from <see cref="Partial"/> a message is written whole or not at all.
+  /// </summary>
+  public enum WritePolicy : uint
+  {
+    Partial = 0,
+    AllOrNothing = 1,
+    Block = 2,
+    Drop = 3,
+  }
+
+  /// <summary>
+  /// Creation parameters for <see cref="CreateEx"/>.
+  /// </summary>
+  [StructLayout(LayoutKind.Sequential)]
+  public struct RbCreateOptions
+  {
+    public uint Capacity;
+    public AllocFlags Flags;
+    public int NumaNode;
+  }
+
   /// <summary>
   /// Creates a new native ring buffer with the specified capacity.
   /// </summary>
@@ -32,6 +94,33 @@ internal static partial class RingBuffer
   [LibraryImport(DllName, EntryPoint = "rb_create")]
   public static partial IntPtr Create(uint capacity);
 
+  /// <summary>
+  /// Creates a new native ring buffer whose storage is mapped twice, back to back.
+  /// Reserved and peeked regions are then always a single contiguous part.
+  /// </summary>
+  /// <param name="capacity">The minimum number of bytes (rounded up to a power of two 
+  /// of at least the page or allocation granularity).</param>
+  /// <returns>A pointer to the new ring buffer, or <see cref="IntPtr.Zero"/> on failure.</returns>
+  [LibraryImport(DllName, EntryPoint = "rb_create_mirrored")]
+  public static partial IntPtr CreateMirrored(uint capacity);
+
+  /// <summary>
+  /// Creates a new native ring buffer with page‑level storage options
+  /// (huge pages, pre‑faulting, NUMA placement).
+  /// </summary>
+  /// <param name="options">The capacity and requested <see cref="AllocFlags"/>.</param>
+  /// <returns>A pointer to the new ring buffer, or <see cref="IntPtr.Zero"/> on failure.</returns>
+  [LibraryImport(DllName, EntryPoint = "rb_create_ex")]
+  public static partial IntPtr CreateEx(in RbCreateOptions options);
+
+  /// <summary>
+  /// Gets the storage options actually granted for the ring buffer.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <returns>The granted <see cref="AllocFlags"/>.</returns>
+  [LibraryImport(DllName, EntryPoint = "rb_alloc_granted")]
+  public static partial AllocFlags AllocGranted(IntPtr rb);
+
   /// <summary>
   /// Frees a previously created native ring buffer.
   /// </summary>
@@ -74,6 +163,115 @@ internal static partial class RingBuffer
   /// <returns>The number of writable bytes.</returns>
   [LibraryImport(DllName, EntryPoint = "rb_available_to_write")]
   public static partial uint AvailableToWrite(IntPtr rb);
+
+  /// <summary>
+  /// Reserves free space inside the ring buffer for in‑place writing.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <param name="length">The requested number of bytes.</param>
+  /// <param name="span">Receives the reserved region.</param>
+  /// <returns>The number of bytes actually reserved.</returns>
+  [LibraryImport(DllName, EntryPoint = "rb_reserve")]
+  public static partial uint Reserve(IntPtr rb, uint length, out RbSpan span);
+
+  /// <summary>
+  /// Publishes bytes previously written into a reserved region.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <param name="length">The number of bytes to publish.</param>
+  [LibraryImport(DllName, EntryPoint = "rb_commit")]
+  public static partial void Commit(IntPtr rb, uint length);
+
+  /// <summary>
+  /// Exposes readable bytes in place without consuming them.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <param name="length">The maximum number of bytes to expose.</param>
+  /// <param name="span">Receives the readable region.</param>
+  /// <returns>The number of bytes exposed.</returns>
+  [LibraryImport(DllName, EntryPoint = "rb_peek")]
+  public static partial uint Peek(IntPtr rb, uint length, out RbSpan span);
+
+  /// <summary>
+  /// Releases bytes previously exposed by <see cref="Peek"/>.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <param name="length">The number of bytes to release.</param>
+  [LibraryImport(DllName, EntryPoint = "rb_consume")]
+  public static partial void Consume(IntPtr rb, uint length);
+
+  /// <summary>
+  /// Writes a batch of segments into the ring buffer with a single publish
+  /// and a single managed→native transition.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <param name="segments">The source segments.</param>
+  /// <param name="count">The number of segments.</param>
+  /// <returns>The total number of bytes actually written.</returns>
+  [LibraryImport(DllName, EntryPoint = "rb_writev")]
+  public static partial uint WriteV(IntPtr rb, ReadOnlySpan<RbSegment> segments, uint count);
+
+  /// <summary>
+  /// Reads from the ring buffer into a batch of destination segments with a
+  /// single publish and a single managed→native transition.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <param name="segments">The destination segments.</param>
+  /// <param name="count">The number of segments.</param>
+  /// <returns>The total number of bytes actually read.</returns>
+  [LibraryImport(DllName, EntryPoint = "rb_readv")]
+  public static partial uint ReadV(IntPtr rb, ReadOnlySpan<RbSegment> segments, uint count);
+
+  /// <summary>
+  /// Blocks until at least <paramref name="minBytes"/> can be read.
+  /// The native side spins briefly, then parks on a futex until the producer publishes.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <param name="minBytes">The number of bytes to wait for.</param>
+  /// <param name="timeoutMs">The timeout in milliseconds; 0 polls, negative waits forever.</param>
+  /// <returns>The number of readable bytes, or 0 on timeout.</returns>
+  [LibraryImport(DllName, EntryPoint = "rb_wait_readable")]
+  public static partial uint WaitReadable(IntPtr rb, uint minBytes, int timeoutMs);
+
+  /// <summary>
+  /// Blocks until at least <paramref name="minBytes"/> can be written.
+  /// The native side spins briefly, then parks on a futex until the consumer publishes.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <param name="minBytes">The number of bytes to wait for.</param>
+  /// <param name="timeoutMs">The timeout in milliseconds; 0 polls, negative waits forever.</param>
+  /// <returns>The number of writable bytes, or 0 on timeout.</returns>
+  [LibraryImport(DllName, EntryPoint = "rb_wait_writable")]
+  public static partial uint WaitWritable(IntPtr rb, uint minBytes, int timeoutMs);
+
+  /// <summary>
+  /// Sets the number of spin iterations the wait calls perform before parking.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <param name="spins">The number of spin iterations.</param>
+  [LibraryImport(DllName, EntryPoint = "rb_set_wait_spins")]
+  public static partial void SetWaitSpins(IntPtr rb, uint spins);
+
+  /// <summary>
+  /// Writes data according to a <see cref="WritePolicy"/>. <see cref="WritePolicy.Block"/>
+  /// parks on a futex until the consumer's read frees enough space.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <param name="data">The data to write.</param>
+  /// <param name="length">The number of bytes to write.</param>
+  /// <param name="policy">What to do when the data does not fit.</param>
+  /// <param name="timeoutMs">The timeout for <see cref="WritePolicy.Block"/>; negative waits forever.</param>
+  /// <returns><paramref name="length"/> or 0 (any count for <see cref="WritePolicy.Partial"/>).</returns>
+  [LibraryImport(DllName, EntryPoint = "rb_write_ex")]
+  public static partial uint WriteEx(IntPtr rb, ReadOnlySpan<byte> data, uint length, WritePolicy policy, int timeoutMs);
+
+  /// <summary>
+  /// Gets the number of messages discarded by <see cref="WritePolicy.Drop"/>.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <returns>The dropped message count.</returns>
+  [LibraryImport(DllName, EntryPoint = "rb_dropped")]
+  public static partial ulong Dropped(IntPtr rb);
 }
 
 
@@ -0,0 +1,53 @@
+﻿
+using System.Runtime.InteropServices;
+
+
+namespace michele.natale.RingBufferNative;
+
+
+
+/// <summary>
+/// Provides managed wrappers for the native ring buffer benchmarks.
+/// Producer and consumer run on native threads, so the results measure
+/// the ring buffer implementations and not the P/Invoke transition.
+/// </summary>
+internal static partial class RingBufferBench
+{
+  private const string DllName = "InteropShowcaseLib.dll";
+
+  /// <summary>
+  /// Ring buffer implementation measured by <see cref="Throughput"/>.
+  /// </summary>
+  public enum Kind : int
+  {
+    /// <summary>The classic <c>ringbuffer_t</c>.</summary>
+    Classic = 0,
+
+    /// <summary>The cache‑line‑isolated <c>spsc_rb_t</c>.</summary>
+    Spsc = 1,
+  }
+
+  /// <summary>
+  /// Streams <paramref name="totalBytes"/> from a native producer thread to a 
+  /// native consumer thread and measures the throughput.
+  /// </summary>
+  /// <param name="kind">The ring buffer implementation.</param>
+  /// <param name="capacity">The ring buffer capacity in bytes.</param>
+  /// <param name="messageSize">The number of bytes per write/read call.</param>
+  /// <param name="totalBytes">The total number of bytes to transfer.</param>
+  /// <returns>The throughput in MB/s, or a negative value on invalid arguments.</returns>
+  [LibraryImport(DllName, EntryPoint = "rb_bench_throughput")]
+  public static partial double Throughput(Kind kind, uint capacity, uint messageSize, ulong totalBytes);
+
+  /// <summary>
+  /// Runs the given number of native producer and consumer threads against
+  /// one MPMC ring buffer and measures the combined message rate.
+  /// </summary>
+  /// <param name="producers">The number of producer threads.</param>
+  /// <param name="consumers">The number of consumer threads.</param>
+  /// <param name="messageSize">The payload bytes per message.</param>
+  /// <param name="messagesPerProducer">The messages written by each producer.</param>
+  /// <returns>The throughput in million messages per second, or a negative value on invalid arguments.</returns>
+  [LibraryImport(DllName, EntryPoint = "rb_bench_mpmc")]
+  public static partial double Mpmc(uint producers, uint consumers, uint messageSize, ulong messagesPerProducer);
+}
@@ -0,0 +1,151 @@
+﻿
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+
+
+namespace michele.natale.RingBufferNative;
+
+
+
+/// <summary>
+/// Provides managed wrappers for the native typed slot rings.
+/// The native side exports one ring per element size (8, 16, 32, 64 bytes);
+/// the generic helpers pick the matching export from <c>sizeof(T)</c>, so any
+/// blittable struct of that size is moved as whole elements without
+/// per‑byte bookkeeping or partial reads.
+/// </summary>
+internal static unsafe partial class SlotRing
+{
+  private const string DllName = "InteropShowcaseLib.dll";
+
+  /// <summary>
+  /// Creates a new native slot ring for elements of type <typeparamref name="T"/>.
+  /// </summary>
+  /// <typeparam name="T">A blittable struct of 8, 16, 32 or 64 bytes.</typeparam>
+  /// <returns>A pointer to the new slot ring.</returns>
+  public static IntPtr Create<T>() where T : unmanaged => Unsafe.SizeOf<T>() switch
+  {
+    8 => Create8(),
+    16 => Create16(),
+    32 => Create32(),
+    64 => Create64(),
+    _ => throw new NotSupportedException($"No slot ring for {Unsafe.SizeOf<T>()}-byte elements."),
+  };
+
+  /// <summary>
+  /// Frees a slot ring created by <see cref="Create{T}"/>.
+  /// </summary>
+  /// <typeparam name="T">The element type the ring was created for.</typeparam>
+  /// <param name="ring">A pointer to the slot ring.</param>
+  public static void Free<T>(IntPtr ring) where T : unmanaged
+  {
+    switch (Unsafe.SizeOf<T>())
+    {
+      case 8: Free8(ring); break;
+      case 16: Free16(ring); break;
+      case 32: Free32(ring); break;
+      case 64: Free64(ring); break;
+      default: throw new NotSupportedException($"No slot ring for {Unsafe.SizeOf<T>()}-byte elements.");
+    }
+  }
+
+  /// <summary>
+  /// Pushes as many elements as fit (producer side only).
+  /// </summary>
+  /// <typeparam name="T">The element type the ring was created for.</typeparam>
+  /// <param name="ring">A pointer to the slot ring.</param>
+  /// <param name="items">The elements to push.</param>
+  /// <returns>The number of elements pushed.</returns>
+  public static uint PushN<T>(IntPtr ring, ReadOnlySpan<T> items) where T : unmanaged
+  {
+    fixed (T* p = items)
+      return Unsafe.SizeOf<T>() switch
+      {
+        8 => PushN8(ring, p, (uint)items.Length),
+        16 => PushN16(ring, p, (uint)items.Length),
+        32 => PushN32(ring, p, (uint)items.Length),
+        64 => PushN64(ring, p, (uint)items.Length),
+        _ => throw new NotSupportedException($"No slot ring for {Unsafe.SizeOf<T>()}-byte elements."),
+      };
+  }
+
+  /// <summary>
+  /// Pops up to <c>items.Length</c> elements (consumer side only).
+  /// </summary>
+  /// <typeparam name="T">The element type the ring was created for.</typeparam>
+  /// <param name="ring">A pointer to the slot ring.</param>
+  /// <param name="items">The destination elements.</param>
+  /// <returns>The number of elements popped.</returns>
+  public static uint PopN<T>(IntPtr ring, Span<T> items) where T : unmanaged
+  {
+    fixed (T* p = items)
+      return Unsafe.SizeOf<T>() switch
+      {
+        8 => PopN8(ring, p, (uint)items.Length),
+        16 => PopN16(ring, p, (uint)items.Length),
+        32 => PopN32(ring, p, (uint)items.Length),
+        64 => PopN64(ring, p, (uint)items.Length),
+        _ => throw new NotSupportedException($"No slot ring for {Unsafe.SizeOf<T>()}-byte elements."),
+      };
+  }
+
+  /// <summary>
+  /// Gets the number of elements currently stored.
+  /// </summary>
+  /// <typeparam name="T">The element type the ring was created for.</typeparam>
+  /// <param name="ring">A pointer to the slot ring.</param>
+  /// <returns>The element count.</returns>
+  public static uint Size<T>(IntPtr ring) where T : unmanaged => Unsafe.SizeOf<T>() switch
+  {
+    8 => Size8(ring),
+    16 => Size16(ring),
+    32 => Size32(ring),
+    64 => Size64(ring),
+    _ => throw new NotSupportedException($"No slot ring for {Unsafe.SizeOf<T>()}-byte elements."),
+  };
+
+  /// <summary>
+  /// Gets the compile‑time slot count of the exported rings.
+  /// </summary>
+  /// <typeparam name="T">The element type the ring was created for.</typeparam>
+  /// <param name="ring">A pointer to the slot ring.</param>
+  /// <returns>The number of slots.</returns>
+  public static uint Capacity<T>(IntPtr ring) where T : unmanaged => Unsafe.SizeOf<T>() switch
+  {
+    8 => Capacity8(ring),
+    16 => Capacity16(ring),
+    32 => Capacity32(ring),
+    64 => Capacity64(ring),
+    _ => throw new NotSupportedException($"No slot ring for {Unsafe.SizeOf<T>()}-byte elements."),
+  };
+
+  [LibraryImport(DllName, EntryPoint = "slot_ring8_create")] private static partial IntPtr Create8();
+  [LibraryImport(DllName, EntryPoint = "slot_ring16_create")] private static partial IntPtr Create16();
+  [LibraryImport(DllName, EntryPoint = "slot_ring32_create")] private static partial IntPtr Create32();
+  [LibraryImport(DllName, EntryPoint = "slot_ring64_create")] private static partial IntPtr Create64();
+
+  [LibraryImport(DllName, EntryPoint = "slot_ring8_free")] private static partial void Free8(IntPtr ring);
+  [LibraryImport(DllName, EntryPoint = "slot_ring16_free")] private static partial void Free16(IntPtr ring);
+  [LibraryImport(DllName, EntryPoint = "slot_ring32_free")] private static partial void Free32(IntPtr ring);
+  [LibraryImport(DllName, EntryPoint = "slot_ring64_free")] private static partial void Free64(IntPtr ring);
+
+  [LibraryImport(DllName, EntryPoint = "slot_ring8_push_n")] private static partial uint PushN8(IntPtr ring, void* items, uint count);
+  [LibraryImport(DllName, EntryPoint = "slot_ring16_push_n")] private static partial uint PushN16(IntPtr ring, void* items, uint count);
+  [LibraryImport(DllName, EntryPoint = "slot_ring32_push_n")] private static partial uint PushN32(IntPtr ring, void* items, uint count);
+  [LibraryImport(DllName, EntryPoint = "slot_ring64_push_n")] private static partial uint PushN64(IntPtr ring, void* items, uint count);
+
+  [LibraryImport(DllName, EntryPoint = "slot_ring8_pop_n")] private static partial uint PopN8(IntPtr ring, void* items, uint count);
+  [LibraryImport(DllName, EntryPoint = "slot_ring16_pop_n")] private static partial uint PopN16(IntPtr ring, void* items, uint count);
+  [LibraryImport(DllName, EntryPoint = "slot_ring32_pop_n")] private static partial uint PopN32(IntPtr ring, void* items, uint count);
+  [LibraryImport(DllName, EntryPoint = "slot_ring64_pop_n")] private static partial uint PopN64(IntPtr ring, void* items, uint count);
+
+  [LibraryImport(DllName, EntryPoint = "slot_ring8_size")] private static partial uint Size8(IntPtr ring);
+  [LibraryImport(DllName, EntryPoint = "slot_ring16_size")] private static partial uint Size16(IntPtr ring);
+  [LibraryImport(DllName, EntryPoint = "slot_ring32_size")] private static partial uint Size32(IntPtr ring);
+  [LibraryImport(DllName, EntryPoint = "slot_ring64_size")] private static partial uint Size64(IntPtr ring);
+
+  [LibraryImport(DllName, EntryPoint = "slot_ring8_capacity")] private static partial uint Capacity8(IntPtr ring);
+  [LibraryImport(DllName, EntryPoint = "slot_ring16_capacity")] private static partial uint Capacity16(IntPtr ring);
+  [LibraryImport(DllName, EntryPoint = "slot_ring32_capacity")] private static partial uint Capacity32(IntPtr ring);
+  [LibraryImport(DllName, EntryPoint = "slot_ring64_capacity")] private static partial uint Capacity64(IntPtr ring);
+}
@@ -0,0 +1,78 @@
+﻿
+using System.Runtime.InteropServices;
+
+
+namespace michele.natale.RingBufferNative;
+
+
+
+/// <summary>
+/// Provides managed wrappers for the native cache‑line‑isolated SPSC ring buffer.
+/// Producer and consumer indices live on separate cache lines and each side
+/// caches the other side's index, which removes the per‑call cache line
+/// ping‑pong of the classic <see cref="RingBuffer"/>.
+/// </summary>
+internal static partial class SpscRingBuffer
+{
+  private const string DllName = "InteropShowcaseLib.dll";
+
+  /// <summary>
+  /// Creates a new native SPSC ring buffer.
+  /// The capacity is rounded up to the next power of two.
+  /// </summary>
+  /// <param name="capacity">The minimum number of bytes the ring buffer can hold.</param>
+  /// <returns>A pointer to the new ring buffer, or <see cref="IntPtr.Zero"/> on failure.</returns>
+  [LibraryImport(DllName, EntryPoint = "spsc_rb_create")]
+  public static partial IntPtr Create(uint capacity);
+
+  /// <summary>
+  /// Frees a previously created native SPSC ring buffer.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer to free.</param>
+  [LibraryImport(DllName, EntryPoint = "spsc_rb_free")]
+  public static partial void Free(IntPtr rb);
+
+  /// <summary>
+  /// Writes data into the ring buffer (producer side only).
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <param name="data">The data to write.</param>
+  /// <param name="length">The number of bytes to write.</param>
+  /// <returns>The number of bytes actually written.</returns>
+  [LibraryImport(DllName, EntryPoint = "spsc_rb_write")]
+  public static partial uint Write(IntPtr rb, ReadOnlySpan<byte> data, uint length);
+
+  /// <summary>
+  /// Reads data from the ring buffer (consumer side only).
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <param name="dest">The destination buffer to fill.</param>
+  /// <param name="length">The maximum number of bytes to read.</param>
+  /// <returns>The number of bytes actually read.</returns>
+  [LibraryImport(DllName, EntryPoint = "spsc_rb_read")]
+  public static partial uint Read(IntPtr rb, Span<byte> dest, uint length);
+
+  /// <summary>
+  /// Gets the number of bytes currently available to read.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <returns>The number of readable bytes.</returns>
+  [LibraryImport(DllName, EntryPoint = "spsc_rb_available_to_read")]
+  public static partial uint AvailableToRead(IntPtr rb);
+
+  /// <summary>
+  /// Gets the number of bytes currently available to write.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <returns>The number of writable bytes.</returns>
+  [LibraryImport(DllName, EntryPoint = "spsc_rb_available_to_write")]
+  public static partial uint AvailableToWrite(IntPtr rb);
+
+  /// <summary>
+  /// Gets the effective (power‑of‑two) capacity of the ring buffer.
+  /// </summary>
+  /// <param name="rb">A pointer to the ring buffer.</param>
+  /// <returns>The capacity in bytes.</returns>
+  [LibraryImport(DllName, EntryPoint = "spsc_rb_capacity")]
+  public static partial uint Capacity(IntPtr rb);
+}
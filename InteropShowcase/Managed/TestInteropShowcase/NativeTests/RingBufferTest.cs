@@ -1,5 +1,6 @@
 ﻿
 using System.Text;
+using System.Runtime.InteropServices;
 
 namespace michele.natale;
 
@@ -41,6 +42,13 @@ internal class RingBufferTest
   public static void Start() 
   {
     TestRingBuffer();
+    TestReserveCommit();
+    TestVectored();
+    TestMirrored();
+    TestBlockingWait();
+    TestWritePolicies();
+    TestHugePages();
+    TestSlotRing();
   }
 
   /// <summary>
@@ -98,4 +106,277 @@ internal class RingBufferTest
 
     Console.WriteLine($"Consumer: Received text = {Encoding.UTF8.GetString(buffer, 0, (int)read)}");
   }
+
+  /// <summary>
+  /// Demonstrates the zero‑copy API:
+  /// <para>• The producer reserves space and serializes directly into the ring</para>
+  /// <para>• The consumer peeks at the data in place and then releases it</para>
+  /// The capacity is deliberately small, so the second message wraps around 
+  /// the end of the buffer and is handed out as two parts.
+  /// </summary>
+  private static unsafe void TestReserveCommit()
+  {
+    Console.WriteLine($"{nameof(TestReserveCommit)}:");
+
+    var rb = RingBuffer.Create(32u);
+
+    foreach (var txt in new[] { "Zero-Copy Message #1", "Zero-Copy Message #2" })
+    {
+      var data = Encoding.UTF8.GetBytes(txt);
+
+      // Producer: serialize straight into the ring buffer storage
+      var reserved = RingBuffer.Reserve(rb, (uint)data.Length, out var wspan);
+      data.AsSpan(0, (int)wspan.FirstLength)
+        .CopyTo(new Span<byte>((void*)wspan.First, (int)wspan.FirstLength));
+      data.AsSpan((int)wspan.FirstLength, (int)wspan.SecondLength)
+        .CopyTo(new Span<byte>((void*)wspan.Second, (int)wspan.SecondLength));
+      RingBuffer.Commit(rb, reserved);
+
+      // Consumer: parse in place, then hand the space back
+      var peeked = RingBuffer.Peek(rb, 256u, out var rspan);
+      var first = new ReadOnlySpan<byte>((void*)rspan.First, (int)rspan.FirstLength);
+      var second = new ReadOnlySpan<byte>((void*)rspan.Second, (int)rspan.SecondLength);
+      Console.WriteLine($"Consumer: {peeked} bytes in {(rspan.SecondLength > 0 ? 2 : 1)} part(s) = " +
+        $"{Encoding.UTF8.GetString(first)}{Encoding.UTF8.GetString(second)}");
+      RingBuffer.Consume(rb, peeked);
+    }
+
+    RingBuffer.Free(rb);
+    Console.WriteLine();
+  }
+
+  /// <summary>
+  /// Demonstrates the vectored API:
+  /// <para>• Several small messages are written with one <c>rb_writev</c> call</para>
+  /// <para>• They are read back into several buffers with one <c>rb_readv</c> call</para>
+  /// One managed→native transition moves the whole batch.
+  /// </summary>
+  private static void TestVectored()
+  {
+    Console.WriteLine($"{nameof(TestVectored)}:");
+
+    var rb = RingBuffer.Create(4096u);
+
+    // Pinned arrays, so the native side may hold their addresses during the call
+    var messages = new[] { "Batch #1", "Batch #2", "Batch #3" }
+      .Select(txt =>
+      {
+        var bytes = Encoding.UTF8.GetBytes(txt);
+        var pinned = GC.AllocateUninitializedArray<byte>(bytes.Length, pinned: true);
+        bytes.CopyTo(pinned, 0);
+        return pinned;
+      })
+      .ToArray();
+
+    var wsegs = messages
+      .Select(m => new RingBuffer.RbSegment
+      {
+        Data = Marshal.UnsafeAddrOfPinnedArrayElement(m, 0),
+        Length = (uint)m.Length
+      })
+      .ToArray();
+
+    var written = RingBuffer.WriteV(rb, wsegs, (uint)wsegs.Length);
+    Console.WriteLine($"Producer: Wrote {written} bytes from {wsegs.Length} segments");
+
+    var dests = messages
+      .Select(m => GC.AllocateUninitializedArray<byte>(m.Length, pinned: true))
+      .ToArray();
+
+    var rsegs = dests
+      .Select(d => new RingBuffer.RbSegment
+      {
+        Data = Marshal.UnsafeAddrOfPinnedArrayElement(d, 0),
+        Length = (uint)d.Length
+      })
+      .ToArray();
+
+    var read = RingBuffer.ReadV(rb, rsegs, (uint)rsegs.Length);
+    Console.WriteLine($"Consumer: Read {read} bytes into {rsegs.Length} segments = " +
+      string.Join(" | ", dests.Select(d => Encoding.UTF8.GetString(d))));
+
+    RingBuffer.Free(rb);
+    Console.WriteLine();
+  }
+
+  /// <summary>
+  /// Demonstrates the mirrored ring buffer:
+  /// <para>• The storage pages are mapped twice, back to back</para>
+  /// <para>• A message that straddles the end of the buffer is still one contiguous block</para>
+  /// The consumer can therefore parse it in place without stitching two parts.
+  /// </summary>
+  private static unsafe void TestMirrored()
+  {
+    Console.WriteLine($"{nameof(TestMirrored)}:");
+
+    var rb = RingBuffer.CreateMirrored(1u);
+    if (rb == IntPtr.Zero)
+    {
+      Console.WriteLine("Mirrored mapping is not available on this system.");
+      Console.WriteLine();
+      return;
+    }
+
+    // Move the indices close to the end of the buffer
+    var capacity = RingBuffer.AvailableToWrite(rb);
+    var filler = new byte[capacity - 8];
+    RingBuffer.Write(rb, filler, (uint)filler.Length);
+    RingBuffer.Read(rb, filler, (uint)filler.Length);
+
+    var data = Encoding.UTF8.GetBytes("Wrapped, but contiguous!");
+    RingBuffer.Write(rb, data, (uint)data.Length);
+
+    var peeked = RingBuffer.Peek(rb, 256u, out var span);
+    var view = new ReadOnlySpan<byte>((void*)span.First, (int)span.FirstLength);
+    Console.WriteLine($"Capacity = {capacity}; {peeked} bytes in {(span.SecondLength > 0 ? 2 : 1)} part(s) = " +
+      $"{Encoding.UTF8.GetString(view)}");
+    RingBuffer.Consume(rb, peeked);
+
+    RingBuffer.Free(rb);
+    Console.WriteLine();
+  }
+
+  /// <summary>
+  /// Demonstrates the blocking wait API:
+  /// <para>• The consumer parks in <c>rb_wait_readable</c> instead of spinning or sleeping</para>
+  /// <para>• The producer's write wakes it up as soon as the data is published</para>
+  /// </summary>
+  private static void TestBlockingWait()
+  {
+    Console.WriteLine($"{nameof(TestBlockingWait)}:");
+
+    var rb = RingBuffer.Create(4096u);
+    RingBuffer.SetWaitSpins(rb, 1000);
+
+    var data = Encoding.UTF8.GetBytes("Wake up!");
+    var sw = System.Diagnostics.Stopwatch.StartNew();
+
+    var consumer = new Thread(() =>
+    {
+      var readable = RingBuffer.WaitReadable(rb, (uint)data.Length, 1000);
+      var buffer = new byte[readable];
+      RingBuffer.Read(rb, buffer, readable);
+      Console.WriteLine($"Consumer: Woke up after {sw.Elapsed.TotalMilliseconds:F3} ms " +
+        $"with text = {Encoding.UTF8.GetString(buffer)}");
+    });
+    consumer.Start();
+
+    // Let the consumer park, then publish
+    Thread.Sleep(50);
+    sw.Restart();
+    RingBuffer.Write(rb, data, (uint)data.Length);
+
+    consumer.Join();
+    RingBuffer.Free(rb);
+    Console.WriteLine();
+  }
+
+  /// <summary>
+  /// Demonstrates the write policies on a full ring:
+  /// <para>• All‑or‑nothing and drop refuse the message instead of truncating it</para>
+  /// <para>• Block parks the producer until the consumer's read makes room</para>
+  /// </summary>
+  private static void TestWritePolicies()
+  {
+    Console.WriteLine($"{nameof(TestWritePolicies)}:");
+
+    var rb = RingBuffer.Create(64u);
+    var data = new byte[40];
+
+    var first = RingBuffer.WriteEx(rb, data, (uint)data.Length, RingBuffer.WritePolicy.AllOrNothing, 0);
+    var second = RingBuffer.WriteEx(rb, data, (uint)data.Length, RingBuffer.WritePolicy.AllOrNothing, 0);
+    RingBuffer.WriteEx(rb, data, (uint)data.Length, RingBuffer.WritePolicy.Drop, 0);
+    Console.WriteLine($"AllOrNothing: {first} then {second} bytes, Drop: {RingBuffer.Dropped(rb)} dropped");
+
+    var sw = System.Diagnostics.Stopwatch.StartNew();
+    var consumer = new Thread(() =>
+    {
+      Thread.Sleep(50);
+      RingBuffer.Read(rb, new byte[data.Length], (uint)data.Length);
+    });
+    consumer.Start();
+
+    var blocked = RingBuffer.WriteEx(rb, data, (uint)data.Length, RingBuffer.WritePolicy.Block, 1000);
+    Console.WriteLine($"Block: {blocked} bytes after {sw.Elapsed.TotalMilliseconds:F1} ms");
+
+    consumer.Join();
+    RingBuffer.Free(rb);
+    Console.WriteLine();
+  }
+
+  /// <summary>
+  /// Demonstrates page‑level storage options:
+  /// <para>• The ring asks for 2 MB pages, pre‑faulted and bound to NUMA node 0</para>
+  /// <para>• Whatever the OS refuses falls back silently and is reported back</para>
+  /// Huge pages usually need setup (Linux: vm.nr_hugepages, Windows: the
+  /// "Lock pages in memory" right), so the fallback is the common case.
+  /// </summary>
+  private static void TestHugePages()
+  {
+    Console.WriteLine($"{nameof(TestHugePages)}:");
+
+    var options = new RingBuffer.RbCreateOptions
+    {
+      Capacity = 4u << 20,
+      Flags = RingBuffer.AllocFlags.Huge2M | RingBuffer.AllocFlags.Prefault | RingBuffer.AllocFlags.NumaBind,
+      NumaNode = 0
+    };
+
+    var rb = RingBuffer.CreateEx(options);
+    if (rb == IntPtr.Zero)
+    {
+      Console.WriteLine("No memory could be mapped.");
+      Console.WriteLine();
+      return;
+    }
+
+    Console.WriteLine($"Requested = {options.Flags}; granted = {RingBuffer.AllocGranted(rb)}");
+
+    var data = Encoding.UTF8.GetBytes("Hello from a page-mapped ring!");
+    RingBuffer.Write(rb, data, (uint)data.Length);
+
+    var buffer = new byte[data.Length];
+    var read = RingBuffer.Read(rb, buffer, (uint)buffer.Length);
+    Console.WriteLine($"Consumer: Received text = {Encoding.UTF8.GetString(buffer, 0, (int)read)}");
+
+    RingBuffer.Free(rb);
+    Console.WriteLine();
+  }
+
+  /// <summary>
+  /// A blittable 16‑byte message for the typed slot ring.
+  /// </summary>
+  [StructLayout(LayoutKind.Sequential)]
+  private struct Tick
+  {
+    public long Id;
+    public double Price;
+  }
+
+  /// <summary>
+  /// Demonstrates the typed slot ring:
+  /// <para>• Whole <c>Tick</c> structs are pushed and popped in bulk</para>
+  /// <para>• There are no partial messages and no byte counts to check</para>
+  /// </summary>
+  private static void TestSlotRing()
+  {
+    Console.WriteLine($"{nameof(TestSlotRing)}:");
+
+    var ring = SlotRing.Create<Tick>();
+
+    var ticks = Enumerable.Range(1, 5)
+      .Select(i => new Tick { Id = i, Price = 100.0 + i * 0.25 })
+      .ToArray();
+
+    var pushed = SlotRing.PushN<Tick>(ring, ticks);
+    Console.WriteLine($"Producer: Pushed {pushed} ticks; size = {SlotRing.Size<Tick>(ring)} of {SlotRing.Capacity<Tick>(ring)} slots");
+
+    var received = new Tick[8];
+    var popped = SlotRing.PopN<Tick>(ring, received);
+    Console.WriteLine($"Consumer: Popped {popped} ticks = " +
+      string.Join(" | ", received.Take((int)popped).Select(t => $"#{t.Id} {t.Price:F2}")));
+
+    SlotRing.Free<Tick>(ring);
+    Console.WriteLine();
+  }
 }
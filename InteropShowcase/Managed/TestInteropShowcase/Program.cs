@@ -8,6 +8,7 @@ public class Program
   public static void Main()
   {
     RingBufferTest.Start();
+    RingBufferBenchmarkTest.Start();
     ReversePInvokeTest.Start();
     VTableTest.Start();
 
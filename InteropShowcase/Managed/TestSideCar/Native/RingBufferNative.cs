@@ -6,6 +6,43 @@ using System.Runtime.InteropServices;
 namespace michele.natale.Native;
 
 
+/// <summary>
+/// Options for <see cref="RingBufferNative.RbCreateEx"/> and <see cref="RingBufferNative.RbOpenEx"/>
+/// (native <c>shared_rb_flags_t</c>).
+/// </summary>
+[Flags]
+internal enum SharedRbFlags : uint
+{
+  /// <summary>Plain mapping, pages are faulted in on first touch.</summary>
+  Default = 0,
+  /// <summary>Map the payload twice, back to back.</summary>
+  Mirrored = 1u << 0,
+  /// <summary>Fault in every page while mapping (MAP_POPULATE on Linux).</summary>
+  Prefault = 1u << 1,
+  /// <summary>Lock the pages in RAM (mlock / VirtualLock).</summary>
+  Lock = 1u << 2,
+  /// <summary>The payload carries length-prefixed records (<see cref="RingBufferNative.RbWriteRecord"/>).</summary>
+  Framed = 1u << 3,
+}
+
+
+/// <summary>
+/// What the policy-aware writes do when a message does not fit
+/// (native <c>shared_rb_write_policy_t</c>).
+/// </summary>
+internal enum SharedRbWritePolicy : uint
+{
+  /// <summary>Write as much as fits.</summary>
+  Partial = 0,
+  /// <summary>Write the whole message or nothing, never wait.</summary>
+  AllOrNothing = 1,
+  /// <summary>Park until the consumer frees enough space, or time out.</summary>
+  Block = 2,
+  /// <summary>Discard the message and count it in <see cref="SharedRbStats.Dropped"/>.</summary>
+  Drop = 3,
+}
+
+
 /// <summary>
 /// Provides low-level P/Invoke bindings for the native shared ring buffer API.
 /// </summary>
@@ -38,6 +75,50 @@ internal static partial class RingBufferNative
   [LibraryImport(DllName, EntryPoint = "shared_rb_open")]
   public static unsafe partial IntPtr RbOpen(sbyte* name);
 
+  /// <summary>
+  /// Creates a new mirrored shared-memory ring buffer.
+  /// The payload is mapped twice, back to back, so records never split at the wrap point.
+  /// </summary>
+  /// <param name="name">Pointer to a null-terminated ASCII string representing the shared memory name.</param>
+  /// <param name="capacity">The minimum size of the ring buffer in bytes.</param>
+  /// <returns>
+  /// A native handle to the ring buffer, or <see cref="IntPtr.Zero"/> if creation failed.
+  /// </returns>
+  [LibraryImport(DllName, EntryPoint = "shared_rb_create_mirrored")]
+  public static unsafe partial IntPtr RbCreateMirrored(sbyte* name, uint capacity);
+
+  /// <summary>
+  /// Creates a new shared-memory ring buffer with options.
+  /// </summary>
+  /// <param name="name">Pointer to a null-terminated ASCII string representing the shared memory name.</param>
+  /// <param name="capacity">The size of the ring buffer in bytes (minimum size if mirrored).</param>
+  /// <param name="flags">The requested <see cref="SharedRbFlags"/>.</param>
+  /// <returns>
+  /// A native handle to the ring buffer, or <see cref="IntPtr.Zero"/> if creation failed.
+  /// </returns>
+  [LibraryImport(DllName, EntryPoint = "shared_rb_create_ex")]
+  public static unsafe partial IntPtr RbCreateEx(sbyte* name, uint capacity, SharedRbFlags flags);
+
+  /// <summary>
+  /// Opens an existing shared-memory ring buffer with options.
+  /// </summary>
+  /// <param name="name">Pointer to a null-terminated ASCII string representing the shared memory name.</param>
+  /// <param name="capacity">Ignored; the native side reads the exact capacity from the shared header.</param>
+  /// <param name="flags">The requested <see cref="SharedRbFlags"/>.</param>
+  /// <returns>
+  /// A native handle to the ring buffer, or <see cref="IntPtr.Zero"/> if the buffer does not exist.
+  /// </returns>
+  [LibraryImport(DllName, EntryPoint = "shared_rb_open_ex")]
+  public static unsafe partial IntPtr RbOpenEx(sbyte* name, uint capacity, SharedRbFlags flags);
+
+  /// <summary>
+  /// Gets the options actually applied to the mapping.
+  /// </summary>
+  /// <param name="rb">The native ring buffer handle.</param>
+  /// <returns>The granted <see cref="SharedRbFlags"/>.</returns>
+  [LibraryImport(DllName, EntryPoint = "shared_rb_granted")]
+  public static partial SharedRbFlags RbGranted(IntPtr rb);
+
   /// <summary>
   /// Closes a previously created or opened ring buffer.
   /// </summary>
@@ -58,6 +139,19 @@ internal static partial class RingBufferNative
   [LibraryImport(DllName, EntryPoint = "shared_rb_write")]
   public static unsafe partial uint RbWrite(IntPtr rb, byte* data, uint length);
 
+  /// <summary>
+  /// Writes data into the ring buffer according to a write policy.
+  /// </summary>
+  /// <param name="rb">The native ring buffer handle.</param>
+  /// <param name="data">Pointer to the data to write.</param>
+  /// <param name="length">The number of bytes to write.</param>
+  /// <param name="policy">What to do when the data does not fit.</param>
+  /// <param name="timeoutMs">The timeout for <see cref="SharedRbWritePolicy.Block"/>; negative waits forever.</param>
+  /// <returns><paramref name="length"/> or 0 (any count for <see cref="SharedRbWritePolicy.Partial"/>).</returns>
+  [LibraryImport(DllName, EntryPoint = "shared_rb_write_ex")]
+  public static unsafe partial uint RbWriteEx(IntPtr rb, byte* data, uint length,
+    SharedRbWritePolicy policy, int timeoutMs);
+
   /// <summary>
   /// Reads data from the ring buffer.
   /// </summary>
@@ -94,5 +188,79 @@ internal static partial class RingBufferNative
   /// <returns>The ring buffer capacity.</returns>
   [LibraryImport(DllName, EntryPoint = "shared_rb_capacity")]
   public static partial uint RbCapacity(IntPtr rb);
+
+  /// <summary>
+  /// Configures the spin and yield phases of <see cref="RbWaitReadable"/>.
+  /// </summary>
+  /// <param name="rb">The native ring buffer handle (consumer side).</param>
+  /// <param name="spins">Busy-spin iterations with a pause instruction.</param>
+  /// <param name="yields">Time-slice yields after spinning.</param>
+  [LibraryImport(DllName, EntryPoint = "shared_rb_set_wait_strategy")]
+  public static partial void RbSetWaitStrategy(IntPtr rb, uint spins, uint yields);
+
+  /// <summary>
+  /// Blocks until at least <paramref name="minBytes"/> can be read.
+  /// The native side spins, yields, then parks until the producer writes;
+  /// the wakeup works across processes.
+  /// </summary>
+  /// <param name="rb">The native ring buffer handle (consumer side).</param>
+  /// <param name="minBytes">The number of bytes to wait for.</param>
+  /// <param name="timeoutMs">The timeout in milliseconds; 0 polls, negative waits forever.</param>
+  /// <returns>The number of readable bytes, or 0 on timeout.</returns>
+  [LibraryImport(DllName, EntryPoint = "shared_rb_wait_readable")]
+  public static partial uint RbWaitReadable(IntPtr rb, uint minBytes, int timeoutMs);
+
+  /// <summary>
+  /// Wakes a consumer parked in <see cref="RbWaitReadable"/> unconditionally.
+  /// </summary>
+  /// <param name="rb">The native ring buffer handle.</param>
+  [LibraryImport(DllName, EntryPoint = "shared_rb_notify")]
+  public static partial void RbNotify(IntPtr rb);
+
+  /// <summary>
+  /// Blocks until at least <paramref name="minBytes"/> can be written.
+  /// The native side parks until the consumer reads; the wakeup works across processes.
+  /// </summary>
+  /// <param name="rb">The native ring buffer handle (producer side).</param>
+  /// <param name="minBytes">The number of bytes to wait for.</param>
+  /// <param name="timeoutMs">The timeout in milliseconds; 0 polls, negative waits forever.</param>
+  /// <returns>The number of writable bytes, or 0 on timeout.</returns>
+  [LibraryImport(DllName, EntryPoint = "shared_rb_wait_writable")]
+  public static partial uint RbWaitWritable(IntPtr rb, uint minBytes, int timeoutMs);
+
+  /// <summary>
+  /// Writes one whole record (header + payload) into a framed ring.
+  /// </summary>
+  /// <param name="rb">The native ring buffer handle (created with <see cref="SharedRbFlags.Framed"/>).</param>
+  /// <param name="type">Application-defined record type.</param>
+  /// <param name="flags">Application-defined record flags.</param>
+  /// <param name="data">Pointer to the payload.</param>
+  /// <param name="length">The number of payload bytes.</param>
+  /// <returns>1 if the record was written, 0 if it does not fit (nothing is written).</returns>
+  [LibraryImport(DllName, EntryPoint = "shared_rb_write_record")]
+  public static unsafe partial uint RbWriteRecord(IntPtr rb, ushort type, ushort flags, byte* data, uint length);
+
+  /// <summary>
+  /// Writes one whole record into a framed ring according to a write policy.
+  /// </summary>
+  /// <param name="rb">The native ring buffer handle (created with <see cref="SharedRbFlags.Framed"/>).</param>
+  /// <param name="type">Application-defined record type.</param>
+  /// <param name="flags">Application-defined record flags.</param>
+  /// <param name="data">Pointer to the payload.</param>
+  /// <param name="length">The number of payload bytes.</param>
+  /// <param name="policy">What to do when the record does not fit.</param>
+  /// <param name="timeoutMs">The timeout for <see cref="SharedRbWritePolicy.Block"/>; negative waits forever.</param>
+  /// <returns>1 if the record was written, 0 if it was rejected, dropped or timed out.</returns>
+  [LibraryImport(DllName, EntryPoint = "shared_rb_write_record_ex")]
+  public static unsafe partial uint RbWriteRecordEx(IntPtr rb, ushort type, ushort flags, byte* data, uint length,
+    SharedRbWritePolicy policy, int timeoutMs);
+
+  /// <summary>
+  /// Gets the statistics block inside the shared memory region.
+  /// </summary>
+  /// <param name="rb">The native ring buffer handle.</param>
+  /// <returns>A pointer that stays valid until <see cref="RbClose"/>.</returns>
+  [LibraryImport(DllName, EntryPoint = "shared_rb_stats")]
+  public static unsafe partial SharedRbStats* RbStats(IntPtr rb);
 }
 
@@ -0,0 +1,98 @@
+﻿using System.Runtime.InteropServices;
+
+namespace michele.natale.Native;
+
+
+/// <summary>
+/// Provides low-level P/Invoke bindings for the native shared payload arena.
+/// </summary>
+/// <remarks>
+/// This class exposes raw interop calls and is not intended for direct use.
+/// Use the managed wrapper <c>SharedArena</c> instead.
+/// </remarks>
+internal static partial class SharedArenaNative
+{
+  private const string DllName = "SidecarModelLib.dll";
+
+  /// <summary>
+  /// Creates a new arena of fixed-size blocks.
+  /// </summary>
+  /// <param name="name">Pointer to a null-terminated ASCII string representing the shared memory name.</param>
+  /// <param name="blockSize">Bytes per block, rounded up to a multiple of 64.</param>
+  /// <param name="blockCount">The number of blocks.</param>
+  /// <returns>A native handle to the arena, or <see cref="IntPtr.Zero"/> if creation failed.</returns>
+  [LibraryImport(DllName, EntryPoint = "shared_arena_create")]
+  public static unsafe partial IntPtr ArenaCreate(sbyte* name, uint blockSize, uint blockCount);
+
+  /// <summary>
+  /// Opens an existing arena; block size and count come from its header.
+  /// </summary>
+  /// <param name="name">Pointer to a null-terminated ASCII string representing the shared memory name.</param>
+  /// <returns>A native handle to the arena, or <see cref="IntPtr.Zero"/> if it does not exist.</returns>
+  [LibraryImport(DllName, EntryPoint = "shared_arena_open")]
+  public static unsafe partial IntPtr ArenaOpen(sbyte* name);
+
+  /// <summary>
+  /// Unmaps the arena and frees the handle.
+  /// </summary>
+  /// <param name="arena">The native arena handle.</param>
+  [LibraryImport(DllName, EntryPoint = "shared_arena_close")]
+  public static partial void ArenaClose(IntPtr arena);
+
+  /// <summary>
+  /// Allocates a run of free blocks without blocking.
+  /// </summary>
+  /// <param name="arena">The native arena handle.</param>
+  /// <param name="length">The number of payload bytes.</param>
+  /// <param name="desc">Receives the descriptor of the run.</param>
+  /// <returns>A writable pointer to the run, or null if no free run of that size exists right now.</returns>
+  [LibraryImport(DllName, EntryPoint = "shared_arena_alloc")]
+  public static unsafe partial byte* ArenaAlloc(IntPtr arena, uint length, SharedArenaDesc* desc);
+
+  /// <summary>
+  /// Resolves a descriptor to its payload.
+  /// </summary>
+  /// <param name="arena">The native arena handle.</param>
+  /// <param name="desc">The descriptor.</param>
+  /// <returns>A pointer to the run, or null if it is out of range or was released.</returns>
+  [LibraryImport(DllName, EntryPoint = "shared_arena_resolve")]
+  public static unsafe partial byte* ArenaResolve(IntPtr arena, SharedArenaDesc* desc);
+
+  /// <summary>
+  /// Releases the run of a descriptor.
+  /// </summary>
+  /// <param name="arena">The native arena handle.</param>
+  /// <param name="desc">The descriptor.</param>
+  /// <returns>1 on success, 0 if the descriptor does not resolve.</returns>
+  [LibraryImport(DllName, EntryPoint = "shared_arena_release")]
+  public static unsafe partial int ArenaRelease(IntPtr arena, SharedArenaDesc* desc);
+
+  /// <summary>
+  /// Gets the block size in bytes.
+  /// </summary>
+  /// <param name="arena">The native arena handle.</param>
+  [LibraryImport(DllName, EntryPoint = "shared_arena_block_size")]
+  public static partial uint ArenaBlockSize(IntPtr arena);
+
+  /// <summary>
+  /// Gets the number of blocks.
+  /// </summary>
+  /// <param name="arena">The native arena handle.</param>
+  [LibraryImport(DllName, EntryPoint = "shared_arena_block_count")]
+  public static partial uint ArenaBlockCount(IntPtr arena);
+
+  /// <summary>
+  /// Gets the number of free blocks right now.
+  /// </summary>
+  /// <param name="arena">The native arena handle.</param>
+  [LibraryImport(DllName, EntryPoint = "shared_arena_free_blocks")]
+  public static partial uint ArenaFreeBlocks(IntPtr arena);
+
+  /// <summary>
+  /// Gets the statistics block inside the shared memory region.
+  /// </summary>
+  /// <param name="arena">The native arena handle.</param>
+  /// <returns>A pointer that stays valid until <see cref="ArenaClose"/>.</returns>
+  [LibraryImport(DllName, EntryPoint = "shared_arena_stats")]
+  public static unsafe partial SharedArenaStats* ArenaStats(IntPtr arena);
+}
@@ -5,6 +5,64 @@ using System.Runtime.InteropServices;
 namespace michele.natale.Native;
 
 
+/// <summary>
+/// Event ids the native Sidecar emits itself (native <c>sidecar_event_id_t</c>).
+/// </summary>
+internal enum SidecarEventId
+{
+  /// <summary>"OK" after every plain (non-RPC) command.</summary>
+  Ack = 1,
+  /// <summary>Payload: <see cref="SidecarRpcHeader"/> + response bytes.</summary>
+  RpcResponse = 2,
+}
+
+
+/// <summary>
+/// Latency stages of a traced command (native <c>sidecar_trace_stage_t</c>).
+/// </summary>
+internal enum SidecarTraceStage
+{
+  /// <summary>Host write to Sidecar read: time in the ring, including the wakeup.</summary>
+  Queue = 0,
+  /// <summary>Sidecar read to callback start.</summary>
+  Dispatch = 1,
+  /// <summary>The <c>Process</c> / <c>ProcessBatch</c> call.</summary>
+  Process = 2,
+  /// <summary>Callback end to ack or response written.</summary>
+  Emit = 3,
+  /// <summary>Host write to ack or response written.</summary>
+  Total = 4,
+}
+
+
+/// <summary>
+/// How the Sidecar picks the input lane of the next batch (native <c>sidecar_lane_policy_t</c>).
+/// </summary>
+internal enum SidecarLanePolicy
+{
+  /// <summary>The readable lane with the highest priority; a busy high lane starves the others.</summary>
+  Strict = 0,
+  /// <summary>Weighted round-robin: each readable lane in turn gets up to weight batches.</summary>
+  Weighted = 1,
+}
+
+
+/// <summary>
+/// States of a supervised SidecarWorker process (native <c>sidecar_process_state_t</c>).
+/// </summary>
+internal enum SidecarProcessState
+{
+  /// <summary>Stopped by the host.</summary>
+  Stopped = 0,
+  /// <summary>The worker process is alive.</summary>
+  Running = 1,
+  /// <summary>The worker died; the supervisor waits out the restart delay.</summary>
+  Restarting = 2,
+  /// <summary>Restarts used up, or the worker reported a configuration error.</summary>
+  Failed = 3,
+}
+
+
 /// <summary>
 /// Provides low-level P/Invoke bindings for the native Sidecar API.
 /// </summary>
@@ -44,6 +102,27 @@ internal static partial class SidecarNative
   [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
   internal static unsafe partial void SidecarStart(SidecarHostVTable* host, SidecarRingBufferDesc* rb);
 
+  /// <summary>
+  /// Starts the native sidecar worker thread with a duplex channel.
+  /// </summary>
+  /// <param name="host">
+  /// Pointer to a <see cref="SidecarHostVTable"/> structure. <c>OnEvent</c> may be null,
+  /// because events are delivered through the event ring instead.
+  /// </param>
+  /// <param name="channel">
+  /// Pointer to a <see cref="SidecarChannelDesc"/> structure describing the
+  /// command ring and the event ring.
+  /// </param>
+  /// <remarks>
+  /// The sidecar writes its events as records into the event ring, and the host
+  /// drains them in batches on its own thread, so no managed callback runs
+  /// on the sidecar thread per event.
+  /// Stop the sidecar with <see cref="SidecarStop"/>.
+  /// </remarks>
+  [LibraryImport(DllName, EntryPoint = "sidecar_start_duplex")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static unsafe partial void SidecarStartDuplex(SidecarHostVTable* host, SidecarChannelDesc* channel);
+
   /// <summary>
   /// Stops the native sidecar worker thread.
   /// </summary>
@@ -60,4 +139,291 @@ internal static partial class SidecarNative
   [LibraryImport(DllName, EntryPoint = "sidecar_stop")]
   [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
   internal static partial void SidecarStop();
+
+  /// <summary>
+  /// Creates a sidecar instance without starting it.
+  /// </summary>
+  /// <param name="host">
+  /// Pointer to a <see cref="SidecarHostVTable"/>. The table is copied by the native side.
+  /// </param>
+  /// <param name="channel">
+  /// Pointer to a <see cref="SidecarChannelDesc"/>. <c>Events.Name</c> may be zero,
+  /// in which case events are delivered through <c>OnEvent</c>.
+  /// </param>
+  /// <returns>The native instance handle, or <see cref="IntPtr.Zero"/> if a ring cannot be opened.</returns>
+  /// <remarks>
+  /// Every instance owns its rings and worker thread, so several sidecars can run
+  /// side by side in one process.
+  /// </remarks>
+  [LibraryImport(DllName, EntryPoint = "sidecar_create")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static unsafe partial IntPtr SidecarCreate(SidecarHostVTable* host, SidecarChannelDesc* channel);
+
+  /// <summary>
+  /// Starts the worker thread of a sidecar instance.
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  [LibraryImport(DllName, EntryPoint = "sidecar_start_ex")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial void SidecarStartEx(IntPtr sidecar);
+
+  /// <summary>
+  /// Stops the worker thread of a sidecar instance. The rings stay open.
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  [LibraryImport(DllName, EntryPoint = "sidecar_stop_ex")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial void SidecarStopEx(IntPtr sidecar);
+
+  /// <summary>
+  /// Stops a sidecar instance if needed, closes its rings and frees it.
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  [LibraryImport(DllName, EntryPoint = "sidecar_destroy")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial void SidecarDestroy(IntPtr sidecar);
+
+  /// <summary>
+  /// Configures how the worker loop waits while the command ring is empty:
+  /// spin, then yield, then park until the host writes a command.
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  /// <param name="spins">Busy-spin iterations with a pause instruction.</param>
+  /// <param name="yields">Time-slice yields after spinning.</param>
+  [LibraryImport(DllName, EntryPoint = "sidecar_set_wait_strategy")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial void SidecarSetWaitStrategy(IntPtr sidecar, uint spins, uint yields);
+
+  /// <summary>
+  /// Limits how many messages and payload bytes the worker drains per batch.
+  /// Takes effect on the next <see cref="SidecarStartEx"/>.
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  /// <param name="maxCount">Maximum number of messages per batch.</param>
+  /// <param name="maxBytes">Maximum number of payload bytes per batch.</param>
+  [LibraryImport(DllName, EntryPoint = "sidecar_set_batch_limits")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial void SidecarSetBatchLimits(IntPtr sidecar, uint maxCount, uint maxBytes);
+
+  /// <summary>
+  /// Enables or disables zero-copy delivery: <c>Process</c>/<c>ProcessBatch</c>
+  /// receive pointers straight into the shared command ring, and the tail is
+  /// advanced only after the callback returns.
+  /// Takes effect on the next <see cref="SidecarStartEx"/>.
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  /// <param name="enabled">Non-zero enables in-place delivery.</param>
+  [LibraryImport(DllName, EntryPoint = "sidecar_set_zero_copy")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial void SidecarSetZeroCopy(IntPtr sidecar, int enabled);
+
+  /// <summary>
+  /// Answers an RPC request. Only valid inside <c>Process</c>/<c>ProcessBatch</c>
+  /// on the Sidecar thread; requests left unanswered get an empty status-0 response.
+  /// </summary>
+  /// <param name="correlationId">The <see cref="SidecarMessage.CorrelationId"/> of the request.</param>
+  /// <param name="status">Application status (0 = success).</param>
+  /// <param name="data">Pointer to the response payload.</param>
+  /// <param name="length">The number of payload bytes.</param>
+  /// <returns>1 if the response was sent; 0 outside a callback, for an unknown id or a second answer.</returns>
+  [LibraryImport(DllName, EntryPoint = "sidecar_respond")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static unsafe partial int SidecarRespond(ulong correlationId, int status, byte* data, uint length);
+
+  /// <summary>
+  /// Sets the affinity, scheduling policy and name of the worker thread.
+  /// Takes effect on the next <see cref="SidecarStartEx"/>.
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  /// <param name="options">The options; null restores the defaults.</param>
+  [LibraryImport(DllName, EntryPoint = "sidecar_set_thread_options")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static unsafe partial void SidecarSetThreadOptions(IntPtr sidecar, SidecarThreadOptions* options);
+
+  /// <summary>
+  /// Gets the thread options the worker applied when it was last started.
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  /// <returns>The applied <see cref="SidecarThreadGranted"/> bits.</returns>
+  [LibraryImport(DllName, EntryPoint = "sidecar_thread_granted")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial SidecarThreadGranted SidecarThreadGranted(IntPtr sidecar);
+
+  /// <summary>
+  /// Gets the trace clock in nanoseconds, shared by all processes on the machine.
+  /// </summary>
+  [LibraryImport(DllName, EntryPoint = "sidecar_trace_now")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial ulong SidecarTraceNow();
+
+  /// <summary>
+  /// Enables or disables latency tracing of <see cref="SidecarMessageFlags.Traced"/> commands.
+  /// Only while stopped; takes effect on the next <see cref="SidecarStartEx"/>.
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  /// <param name="enabled">Non-zero enables tracing.</param>
+  /// <param name="maxSpans">Number of traced commands kept for <see cref="SidecarTraceDump"/>.</param>
+  [LibraryImport(DllName, EntryPoint = "sidecar_set_tracing")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial void SidecarSetTracing(IntPtr sidecar, int enabled, uint maxSpans);
+
+  /// <summary>
+  /// Gets the number of traced commands recorded for a stage.
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  /// <param name="stage">The latency stage.</param>
+  [LibraryImport(DllName, EntryPoint = "sidecar_trace_count")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial ulong SidecarTraceCount(IntPtr sidecar, SidecarTraceStage stage);
+
+  /// <summary>
+  /// Gets a latency percentile of a stage from the Sidecar's histograms.
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  /// <param name="stage">The latency stage.</param>
+  /// <param name="percentile">0..100 (e.g. 50, 99, 99.9).</param>
+  /// <returns>The latency in nanoseconds, or 0 without samples.</returns>
+  [LibraryImport(DllName, EntryPoint = "sidecar_trace_percentile")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial ulong SidecarTracePercentile(IntPtr sidecar, SidecarTraceStage stage, double percentile);
+
+  /// <summary>
+  /// Writes the recorded spans as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  /// <param name="path">The output file.</param>
+  /// <returns>The number of commands written, or -1 on failure.</returns>
+  [LibraryImport(DllName, EntryPoint = "sidecar_trace_dump", StringMarshalling = StringMarshalling.Utf8)]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial int SidecarTraceDump(IntPtr sidecar, string path);
+
+  /// <summary>
+  /// Records every drained command into a memory-mapped, segment-rotated journal,
+  /// or stops journaling (<paramref name="path"/> = null). Only while stopped.
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  /// <param name="path">The file prefix of the segments, or null.</param>
+  /// <param name="segmentBytes">The size of one segment file; 0 for the default (64 MB).</param>
+  /// <returns>1 on success, 0 if the first segment cannot be created.</returns>
+  [LibraryImport(DllName, EntryPoint = "sidecar_set_journal", StringMarshalling = StringMarshalling.Utf8)]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial int SidecarSetJournal(IntPtr sidecar, string? path, ulong segmentBytes);
+
+  /// <summary>
+  /// Gets the number of commands journaled so far.
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  [LibraryImport(DllName, EntryPoint = "sidecar_journal_count")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial ulong SidecarJournalCount(IntPtr sidecar);
+
+  /// <summary>
+  /// Replays a command journal into a command ring on the calling thread.
+  /// </summary>
+  /// <param name="path">The file prefix given to <see cref="SidecarSetJournal"/>.</param>
+  /// <param name="rb">The command ring (producer side).</param>
+  /// <param name="speed">1.0 keeps the recorded timing, 2.0 plays twice as fast; 0 writes flat out.</param>
+  /// <param name="timeoutMs">The longest wait for ring space per command; negative waits forever.</param>
+  /// <returns>The number of commands written, or -1 if the journal cannot be opened.</returns>
+  [LibraryImport(DllName, EntryPoint = "sidecar_journal_replay", StringMarshalling = StringMarshalling.Utf8)]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial long SidecarJournalReplay(string path, IntPtr rb, double speed, int timeoutMs);
+
+  /// <summary>
+  /// Attaches a shared payload arena for <see cref="SidecarMessageFlags.Arena"/> commands,
+  /// or detaches it (<paramref name="name"/> = null). Only while stopped.
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  /// <param name="name">The shared memory name of an arena the host created, or null.</param>
+  /// <returns>1 on success, 0 if the arena cannot be opened.</returns>
+  [LibraryImport(DllName, EntryPoint = "sidecar_set_arena", StringMarshalling = StringMarshalling.Utf8)]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial int SidecarSetArena(IntPtr sidecar, string? name);
+
+  /// <summary>
+  /// Adds an input lane: an extra command ring with its own priority and weight.
+  /// Only while the instance is stopped.
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  /// <param name="ring">The ring created by the host; the Sidecar opens it by name.</param>
+  /// <param name="priority">Higher is served first (<see cref="SidecarLanePolicy.Strict"/>).</param>
+  /// <param name="weight">Batches per round (<see cref="SidecarLanePolicy.Weighted"/>).</param>
+  /// <returns>The lane index, or -1 on failure.</returns>
+  [LibraryImport(DllName, EntryPoint = "sidecar_add_lane")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static unsafe partial int SidecarAddLane(IntPtr sidecar, SidecarRingBufferDesc* ring, int priority, uint weight);
+
+  /// <summary>
+  /// Changes the priority and weight of a lane (0 is the command ring).
+  /// Only while the instance is stopped.
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  /// <param name="lane">The lane index.</param>
+  /// <param name="priority">Higher is served first (<see cref="SidecarLanePolicy.Strict"/>).</param>
+  /// <param name="weight">Batches per round (<see cref="SidecarLanePolicy.Weighted"/>).</param>
+  /// <returns>1 on success, 0 if the lane does not exist or the instance is running.</returns>
+  [LibraryImport(DllName, EntryPoint = "sidecar_set_lane")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial int SidecarSetLane(IntPtr sidecar, uint lane, int priority, uint weight);
+
+  /// <summary>
+  /// Selects the lane scheduling policy. Takes effect on the next <see cref="SidecarStartEx"/>.
+  /// </summary>
+  /// <param name="sidecar">The native instance handle.</param>
+  /// <param name="policy">The lane policy.</param>
+  [LibraryImport(DllName, EntryPoint = "sidecar_set_lane_policy")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial void SidecarSetLanePolicy(IntPtr sidecar, SidecarLanePolicy policy);
+
+  /// <summary>
+  /// Starts a SidecarWorker process on the host's rings and supervises it:
+  /// a worker that dies is restarted with the same arguments.
+  /// </summary>
+  /// <param name="desc">The process description; copied by the native side.</param>
+  /// <returns>The process handle, or <see cref="IntPtr.Zero"/> if the executable cannot be started.</returns>
+  [LibraryImport(DllName, EntryPoint = "sidecar_process_spawn")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static unsafe partial IntPtr SidecarProcessSpawn(SidecarProcessDesc* desc);
+
+  /// <summary>
+  /// Gets the state of a supervised worker.
+  /// </summary>
+  /// <param name="process">The process handle.</param>
+  [LibraryImport(DllName, EntryPoint = "sidecar_process_state")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial SidecarProcessState SidecarProcessGetState(IntPtr process);
+
+  /// <summary>
+  /// Gets the pid of the current worker process, or 0 while none runs.
+  /// </summary>
+  /// <param name="process">The process handle.</param>
+  [LibraryImport(DllName, EntryPoint = "sidecar_process_pid")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial long SidecarProcessPid(IntPtr process);
+
+  /// <summary>
+  /// Gets the number of restarts so far.
+  /// </summary>
+  /// <param name="process">The process handle.</param>
+  [LibraryImport(DllName, EntryPoint = "sidecar_process_restarts")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial uint SidecarProcessRestarts(IntPtr process);
+
+  /// <summary>
+  /// Gets the exit code of the last worker that exited, or -1 if none has.
+  /// </summary>
+  /// <param name="process">The process handle.</param>
+  [LibraryImport(DllName, EntryPoint = "sidecar_process_exit_code")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial int SidecarProcessExitCode(IntPtr process);
+
+  /// <summary>
+  /// Stops a supervised worker (closes its standard input, kills it after the
+  /// timeout) and frees the handle.
+  /// </summary>
+  /// <param name="process">The process handle.</param>
+  /// <param name="timeoutMs">The time the worker gets to exit; negative waits forever.</param>
+  [LibraryImport(DllName, EntryPoint = "sidecar_process_stop")]
+  [UnmanagedCallConv(CallConvs = [typeof(System.Runtime.CompilerServices.CallConvCdecl)])]
+  internal static partial void SidecarProcessStop(IntPtr process, int timeoutMs);
 }
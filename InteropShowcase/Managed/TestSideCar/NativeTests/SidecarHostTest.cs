@@ -21,7 +21,7 @@ internal class SidecarHostTest
   /// <item>Creates a <see cref="SidecarHost"/> instance using a shared ring buffer.</item>
   /// <item>Starts the native Sidecar worker thread.</item>
   /// <item>Sends a test command (<c>PING</c>) to the Sidecar.</item>
-  /// <item>Yields the current thread to allow the Sidecar to process the command.</item>
+  /// <item>Waits briefly, then drains the Sidecar's events from the event ring.</item>
   /// <item>Waits for the user to press ENTER.</item>
   /// <item>Stops and disposes the Sidecar.</item>
   /// </list>
@@ -30,20 +30,520 @@ internal class SidecarHostTest
   /// </remarks>
   public static void Start()
   {
-    using var sidecar = new SidecarHost("SidecarRB", 4096);
+    // Pre-fault the shared pages, so the first command does not page-fault.
+    // Events come back through a second ring and are drained on this thread.
+    using var sidecar = new SidecarHost("SidecarRB", 4096, Native.SharedRbFlags.Prefault, eventCapacity: 4096);
 
     sidecar.Start();
 
     var cmd = System.Text.Encoding.ASCII.GetBytes("PING");
     sidecar.SendCommand(cmd);
 
-    // Give the Sidecar thread a scheduling opportunity
-    Thread.Yield();
+    // Give the Sidecar thread time to process the command
+    Thread.Sleep(50);
+
+    var drained = sidecar.DrainEvents((eventId, data) =>
+      Console.WriteLine($"[Host] Event {eventId}: {System.Text.Encoding.ASCII.GetString(data)}"));
+    Console.WriteLine($"[Host] Drained {drained} event(s) from the event ring");
+
+    TestMultiInstance();
+    TestWakeLatency();
+    TestBatch();
+    TestZeroCopy();
+    TestRpc();
+    TestThreadOptions();
+    TestStats();
+    TestTracing();
+    TestBackpressure();
+    TestJournal();
+    TestLanes();
+    TestProcess();
+    TestArena();
 
     Console.WriteLine("Press ENTER to exit...\n");
     Console.ReadLine();
 
     sidecar.Stop();
   }
-}
 
+  /// <summary>
+  /// Runs several independent Sidecars side by side.
+  /// </summary>
+  /// <remarks>
+  /// Every <see cref="SidecarHost"/> owns its own native instance (rings, worker
+  /// thread, callback table), so throughput scales with the number of sidecars,
+  /// e.g. one per core or per tenant.
+  /// </remarks>
+  private static void TestMultiInstance()
+  {
+    const int count = 3;
+
+    var sidecars = Enumerable.Range(0, count)
+      .Select(i => new SidecarHost($"SidecarRB_{i}", 4096, eventCapacity: 4096))
+      .ToArray();
+
+    foreach (var sidecar in sidecars)
+      sidecar.Start();
+
+    for (var i = 0; i < count; i++)
+      sidecars[i].SendCommand(System.Text.Encoding.ASCII.GetBytes($"PING {i}"));
+
+    Thread.Sleep(50);
+
+    for (var i = 0; i < count; i++)
+    {
+      var drained = sidecars[i].DrainEvents((_, _) => { });
+      Console.WriteLine($"[Host] Sidecar {i}: drained {drained} event(s)");
+    }
+
+    foreach (var sidecar in sidecars)
+      sidecar.Dispose();
+  }
+
+  /// <summary>
+  /// Measures the round trip of a command sent after an idle gap.
+  /// </summary>
+  /// <remarks>
+  /// While idle, the worker is parked (no CPU use); the host's write wakes it,
+  /// so the first command after a pause is not delayed by a sleep interval.
+  /// </remarks>
+  private static void TestWakeLatency()
+  {
+    const int rounds = 20;
+
+    using var sidecar = new SidecarHost("SidecarRB_Wake", 4096, eventCapacity: 4096);
+    sidecar.Start();
+
+    var cmd = System.Text.Encoding.ASCII.GetBytes("PING");
+    var samples = new double[rounds];
+
+    for (var i = 0; i < rounds; i++)
+    {
+      // Let the worker run through spin and yield and park
+      Thread.Sleep(10);
+
+      var start = System.Diagnostics.Stopwatch.GetTimestamp();
+      sidecar.SendCommand(cmd);
+      while (sidecar.DrainEvents((_, _) => { }) == 0)
+        Thread.Yield();
+
+      samples[i] = System.Diagnostics.Stopwatch.GetElapsedTime(start).TotalMicroseconds;
+    }
+
+    Array.Sort(samples);
+    Console.WriteLine($"[Host] Round trip after idle: p50 {samples[rounds / 2]:F1} us, max {samples[^1]:F1} us");
+  }
+
+  /// <summary>
+  /// Queues a backlog of commands before the Sidecar starts, so its first loop
+  /// iterations hand them to <c>ProcessBatch</c> in a few large batches.
+  /// </summary>
+  /// <remarks>
+  /// The command ring is framed, so the 40 commands arrive as 40 messages
+  /// (and produce 40 events) even though they were written back to back.
+  /// </remarks>
+  private static void TestBatch()
+  {
+    using var sidecar = new SidecarHost("SidecarRB_Batch", 64 * 1024, eventCapacity: 64 * 1024, batched: true);
+    sidecar.SetBatchLimits(32, 16 * 1024);
+
+    var cmd = new byte[1024];
+    for (var i = 0; i < 40; i++)
+      sidecar.SendCommand((ushort)i, cmd);
+
+    sidecar.Start();
+    Thread.Sleep(50);
+
+    var drained = sidecar.DrainEvents((_, _) => { });
+    Console.WriteLine($"[Host] Batch: drained {drained} event(s)");
+    sidecar.Stop();
+  }
+
+  /// <summary>
+  /// Sends a command larger than the 1 KB copy buffer through a mirrored ring
+  /// with zero-copy delivery, so it reaches <c>ProcessBatch</c> as one message
+  /// that points straight into shared memory.
+  /// </summary>
+  private static void TestZeroCopy()
+  {
+    using var sidecar = new SidecarHost("SidecarRB_ZeroCopy", 64 * 1024,
+      Native.SharedRbFlags.Mirrored, eventCapacity: 4096, batched: true);
+    sidecar.SetZeroCopy(true);
+    sidecar.Start();
+
+    sidecar.SendCommand(new byte[8 * 1024]);
+    Thread.Sleep(50);
+
+    var drained = sidecar.DrainEvents((_, _) => { });
+    Console.WriteLine($"[Host] Zero-copy: drained {drained} event(s)");
+    sidecar.Stop();
+  }
+
+  /// <summary>
+  /// Pipelines RPC requests: keeps sending while earlier requests are still in
+  /// flight and matches every response to its request by correlation id.
+  /// </summary>
+  /// <remarks>
+  /// The demo <c>ProcessBatch</c> callback echoes each request, so every
+  /// response payload must equal the request payload that caused it.
+  /// </remarks>
+  private static void TestRpc()
+  {
+    const int count = 500;
+
+    using var sidecar = new SidecarHost("SidecarRB_Rpc", 16 * 1024, eventCapacity: 16 * 1024, batched: true);
+    sidecar.Start();
+
+    var calls = new (string Request, Task<SidecarResponse> Response)[count];
+    var max_in_flight = 0;
+
+    for (var i = 0; i < count;)
+    {
+      var request = $"request {i}";
+      if (sidecar.TrySendRequest(1, System.Text.Encoding.ASCII.GetBytes(request), out var response))
+        calls[i++] = (request, response);
+
+      max_in_flight = Math.Max(max_in_flight, sidecar.PendingRequests);
+
+      // Complete what has arrived; keeps the event ring from filling up
+      sidecar.DrainEvents();
+    }
+
+    while (sidecar.PendingRequests > 0)
+      sidecar.DrainEvents();
+
+    var matched = calls.Count(c => c.Response.IsCompletedSuccessfully
+      && System.Text.Encoding.ASCII.GetString(c.Response.Result.Data) == c.Request);
+
+    Console.WriteLine($"[Host] RPC: {matched}/{count} responses matched, up to {max_in_flight} in flight");
+    sidecar.Stop();
+  }
+
+  /// <summary>
+  /// Pins the Sidecar worker to the last CPU and names it.
+  /// </summary>
+  /// <remarks>
+  /// Keeping the worker off the host's cores gives stable tail latency.
+  /// The options are best effort, e.g. a real-time policy needs privileges;
+  /// <see cref="SidecarHost.ThreadGranted"/> reports what took effect.
+  /// </remarks>
+  private static void TestThreadOptions()
+  {
+    var cpu = Math.Min(Environment.ProcessorCount, 64) - 1;
+
+    using var sidecar = new SidecarHost("SidecarRB_Thread", 4096);
+    sidecar.SetThreadOptions(1ul << cpu, SidecarSchedPolicy.Other, -5, "sidecar-pinned");
+    sidecar.Start();
+
+    Console.WriteLine($"[Host] Worker on CPU {cpu}: granted {sidecar.ThreadGranted}");
+    sidecar.Stop();
+  }
+
+  /// <summary>
+  /// Floods a small command ring and reads the shared counters.
+  /// </summary>
+  /// <remarks>
+  /// Rejected writes and the high-water mark show backpressure; empty polls,
+  /// sleeps and the callback time show how busy the Sidecar is.
+  /// </remarks>
+  private static void TestStats()
+  {
+    const int count = 2000;
+
+    // Acks go to a small event ring: the Sidecar parks while it is full (write sleeps
+    // there) until this thread drains it
+    using var sidecar = new SidecarHost("SidecarRB_Stats", 4096, eventCapacity: 4096, batched: true);
+    sidecar.Start();
+
+    var command = new byte[100];
+    var rejected = 0;
+    for (var i = 0; i < count; i++)
+      if (!sidecar.SendCommand(command))
+        rejected++;
+
+    while (sidecar.Stats.MessagesRead < (ulong)(count - rejected))
+      if (sidecar.DrainEvents() == 0)
+        Thread.Yield();
+
+    Console.WriteLine($"[Host] Stats: {sidecar.Stats}");
+    Console.WriteLine($"[Host] Event stats: {sidecar.EventStats}");
+    sidecar.Stop();
+  }
+
+  /// <summary>
+  /// Traces every 10th RPC request through ring, dispatch, callback and response.
+  /// </summary>
+  /// <remarks>
+  /// Prints the median and 99th percentile per stage and writes a Chrome trace
+  /// (open it in ui.perfetto.dev) next to the executable.
+  /// </remarks>
+  private static void TestTracing()
+  {
+    const int count = 2000;
+
+    using var sidecar = new SidecarHost("SidecarRB_Trace", 16 * 1024, eventCapacity: 16 * 1024, batched: true);
+    sidecar.SetTracing(sampleEvery: 10, maxSpans: 1000);
+    sidecar.Start();
+
+    var request = System.Text.Encoding.ASCII.GetBytes("traced request");
+    for (var i = 0; i < count;)
+    {
+      if (sidecar.TrySendRequest(1, request, out _))
+        i++;
+      sidecar.DrainEvents();
+    }
+
+    while (sidecar.PendingRequests > 0)
+      sidecar.DrainEvents();
+
+    foreach (var stage in Enum.GetValues<Native.SidecarTraceStage>())
+      Console.WriteLine($"[Host] Trace {stage,-8}: p50 {sidecar.TracePercentile(stage, 50).TotalMicroseconds,8:F1} µs, " +
+        $"p99 {sidecar.TracePercentile(stage, 99).TotalMicroseconds,8:F1} µs");
+
+    var path = Path.Combine(AppContext.BaseDirectory, "sidecar_trace.json");
+    Console.WriteLine($"[Host] Trace: {sidecar.DumpTrace(path)} command(s) written to {path}");
+    sidecar.Stop();
+  }
+
+  /// <summary>
+  /// Floods a small command ring again, this time with blocking and dropping writes.
+  /// </summary>
+  /// <remarks>
+  /// With <see cref="Native.SharedRbWritePolicy.Block"/> every command gets through:
+  /// the sender parks while the ring is full and the Sidecar's reads wake it.
+  /// With <see cref="Native.SharedRbWritePolicy.Drop"/> against a stopped Sidecar
+  /// every command that does not fit is counted as dropped.
+  /// </remarks>
+  private static void TestBackpressure()
+  {
+    const int count = 2000;
+
+    using var sidecar = new SidecarHost("SidecarRB_Backpressure", 4096, batched: true);
+    sidecar.SetBackpressure(Native.SharedRbWritePolicy.Block, timeoutMs: 1000);
+    sidecar.Start();
+
+    var command = new byte[100];
+    var sent = 0;
+    for (var i = 0; i < count; i++)
+      if (sidecar.SendCommand(command))
+        sent++;
+
+    while (sidecar.Stats.MessagesRead < (ulong)sent)
+      Thread.Yield();
+
+    Console.WriteLine($"[Host] Backpressure Block: {sent}/{count} sent, " +
+      $"{sidecar.Stats.WriteSleeps} write sleep(s), {sidecar.Stats.FullRejections} rejected");
+    sidecar.Stop();
+
+    sidecar.SetBackpressure(Native.SharedRbWritePolicy.Drop);
+    sent = 0;
+    for (var i = 0; i < count; i++)
+      if (sidecar.SendCommand(command))
+        sent++;
+
+    Console.WriteLine($"[Host] Backpressure Drop: {sent}/{count} sent, {sidecar.Stats.Dropped} dropped");
+  }
+
+  /// <summary>
+  /// Records a bursty command stream and replays it into a second Sidecar.
+  /// </summary>
+  /// <remarks>
+  /// The replay keeps the recorded gaps at speed 1, compresses them at speed 4
+  /// and ignores them at speed 0 (flat out), so the same input can drive a
+  /// latency test or a throughput test.
+  /// </remarks>
+  private static void TestJournal()
+  {
+    const int count = 500;
+    var path = Path.Combine(Path.GetTempPath(), "sidecar_journal");
+
+    using (var recorder = new SidecarHost("SidecarRB_Record", 16 * 1024, batched: true))
+    {
+      recorder.SetJournal(path, segmentBytes: 16 * 1024);
+      recorder.Start();
+
+      var command = new byte[100];
+      for (var i = 0; i < count; i++)
+      {
+        command[0] = (byte)i;
+        while (!recorder.SendCommand((ushort)(i % 4), command))
+          Thread.Yield();
+        if (i % 50 == 49)
+          Thread.Sleep(5);
+      }
+
+      while (recorder.JournalCount < count)
+        Thread.Yield();
+
+      recorder.Stop();
+      Console.WriteLine($"[Host] Journal: {recorder.JournalCount} command(s) recorded to {path}.*");
+    }
+
+    using var player = new SidecarHost("SidecarRB_Replay", 4096, batched: true);
+    player.Start();
+
+    foreach (var speed in new[] { 1.0, 4.0, 0.0 })
+    {
+      var read = player.Stats.MessagesRead;
+      var sw = System.Diagnostics.Stopwatch.StartNew();
+      var replayed = player.Replay(path, speed, timeoutMs: 1000);
+
+      while (player.Stats.MessagesRead - read < (ulong)replayed)
+        Thread.Yield();
+
+      Console.WriteLine($"[Host] Replay x{speed}: {replayed} command(s) in {sw.Elapsed.TotalMilliseconds:F1} ms");
+    }
+    player.Stop();
+  }
+
+  /// <summary>
+  /// Sends control commands through their own lane while bulk commands
+  /// saturate the command ring, under both lane policies.
+  /// </summary>
+  /// <remarks>
+  /// With strict priority a control command only waits for the batch being
+  /// processed; with weighted round-robin (bulk weight 4) for up to four bulk
+  /// batches. On the bulk ring it would wait for everything queued before it.
+  /// </remarks>
+  private static void TestLanes()
+  {
+    const int bulk = 3000, probes = 10;
+
+    using var sidecar = new SidecarHost("SidecarRB_Lanes", 64 * 1024, batched: true);
+    var control = sidecar.AddLane("SidecarRB_Lanes_Control", 4096, priority: 10);
+    sidecar.SetBackpressure(Native.SharedRbWritePolicy.Block);
+    sidecar.SetBatchLimits(16, 64 * 1024);
+
+    foreach (var policy in new[] { Native.SidecarLanePolicy.Strict, Native.SidecarLanePolicy.Weighted })
+    {
+      sidecar.SetLanePolicy(policy);
+      sidecar.SetLane(0, priority: 0, weight: 4);
+      sidecar.Start();
+
+      var producer = new Thread(() =>
+      {
+        var command = new byte[512];
+        for (var i = 0; i < bulk; i++)
+          sidecar.SendToLane(0, 1, command);
+      });
+      producer.Start();
+
+      // Probe the control lane while the bulk ring is full
+      Thread.Sleep(10);
+      var ticks = 0L;
+      var probe = new byte[8];
+      for (var i = 0; i < probes; i++)
+      {
+        var read = sidecar.LaneStats(control).MessagesRead;
+        var sw = System.Diagnostics.Stopwatch.StartNew();
+        sidecar.SendToLane(control, 2, probe);
+        while (sidecar.LaneStats(control).MessagesRead <= read)
+          Thread.Yield();
+        ticks += sw.ElapsedTicks;
+      }
+      producer.Join();
+      sidecar.Stop();
+
+      var ms = ticks * 1000.0 / System.Diagnostics.Stopwatch.Frequency / probes;
+      Console.WriteLine($"[Host] Lanes {policy}: control command read after {ms:F3} ms on average");
+    }
+
+    for (var lane = 0; lane < sidecar.LaneCount; lane++)
+    {
+      var stats = sidecar.LaneStats(lane);
+      Console.WriteLine($"[Host] Lane {lane}: {stats.MessagesRead} read, {stats.ProcessCalls} batch(es), " +
+        $"{stats.HighWater} byte(s) high water");
+    }
+  }
+
+  /// <summary>
+  /// Runs the Sidecar in a SidecarWorker process, kills the worker, and keeps
+  /// sending RPC requests to the restarted one.
+  /// </summary>
+  /// <remarks>
+  /// Without a plugin the worker answers every request with its payload. The
+  /// rings live on while the worker is gone, so requests written in between
+  /// are answered once the supervisor has restarted it.
+  /// </remarks>
+  private static void TestProcess()
+  {
+    var worker = Path.Combine(AppContext.BaseDirectory, OperatingSystem.IsWindows() ? "SidecarWorker.exe" : "SidecarWorker");
+    if (!File.Exists(worker))
+    {
+      Console.WriteLine($"[Host] Process: {worker} not found, skipped");
+      return;
+    }
+
+    using var sidecar = new SidecarHost("SidecarRB_Process", 16 * 1024, eventCapacity: 16 * 1024);
+    sidecar.StartProcess(worker, maxRestarts: 3);
+
+    var roundtrip = (string text) =>
+    {
+      if (!sidecar.TrySendRequest(1, System.Text.Encoding.ASCII.GetBytes(text), out var response))
+        return "(ring full)";
+      var wait = System.Diagnostics.Stopwatch.StartNew();
+      while (!response.IsCompleted && wait.ElapsedMilliseconds < 5000)
+        sidecar.DrainEvents();
+      return response.IsCompletedSuccessfully ? System.Text.Encoding.ASCII.GetString(response.Result.Data) : "(no response)";
+    };
+
+    var pid = sidecar.ProcessId;
+    Console.WriteLine($"[Host] Process: worker {pid} answered '{roundtrip("hello")}'");
+
+    System.Diagnostics.Process.GetProcessById((int)pid).Kill();
+    var sw = System.Diagnostics.Stopwatch.StartNew();
+    var answer = roundtrip("after crash");
+    Console.WriteLine($"[Host] Process: worker {pid} killed, worker {sidecar.ProcessId} answered '{answer}' " +
+      $"after {sw.ElapsedMilliseconds} ms ({sidecar.ProcessRestarts} restart(s), state {sidecar.ProcessState})");
+
+    sw.Restart();
+    sidecar.Stop();
+    Console.WriteLine($"[Host] Process: worker stopped in {sw.ElapsedMilliseconds} ms");
+  }
+
+  /// <summary>
+  /// Sends large payloads through a shared arena while small commands keep
+  /// flowing through a 4 KB command ring.
+  /// </summary>
+  /// <remarks>
+  /// Each 256 KB payload is written once, straight into the arena; the ring only
+  /// carries its 16-byte descriptor. The Sidecar reads the payload in place and
+  /// frees its blocks before the ack, so after the last ack all blocks are free.
+  /// </remarks>
+  private static void TestArena()
+  {
+    const int payloads = 20;
+    const uint size = 256 * 1024;
+
+    using var sidecar = new SidecarHost("SidecarRB_Arena", 4096, eventCapacity: 16 * 1024, batched: true);
+    sidecar.SetArena("SidecarRB_Arena_Blocks", 64 * 1024, 64);
+    sidecar.SetBackpressure(Native.SharedRbWritePolicy.Block);
+    sidecar.Start();
+
+    var acks = 0;
+    var command = new byte[16];
+    var sw = System.Diagnostics.Stopwatch.StartNew();
+    for (var i = 0; i < payloads; i++)
+    {
+      // A full arena frees up as the Sidecar acks earlier payloads
+      Span<byte> payload;
+      SharedArenaDesc desc;
+      while ((payload = sidecar.AllocArena(size, out desc)).IsEmpty)
+        acks += sidecar.DrainEvents();
+
+      payload.Fill((byte)i);
+      sidecar.SendArena(1, in desc);
+      sidecar.SendCommand(2, command);
+      acks += sidecar.DrainEvents();
+    }
+
+    while (acks < 2 * payloads && sw.ElapsedMilliseconds < 5000)
+      acks += sidecar.DrainEvents();
+    sw.Stop();
+    sidecar.Stop();
+
+    Console.WriteLine($"[Host] Arena: {payloads} x {size / 1024} KB + {payloads} small command(s) through a " +
+      $"4 KB ring in {sw.Elapsed.TotalMilliseconds:F1} ms, {acks} ack(s), {sidecar.ArenaFreeBlocks} block(s) free");
+    Console.WriteLine($"[Host] Arena: {sidecar.ArenaStats}");
+  }
+}
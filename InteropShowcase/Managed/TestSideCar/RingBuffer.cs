@@ -17,6 +17,7 @@ using Native;
 internal sealed unsafe class RingBuffer : IDisposable
 {
   private IntPtr MHandle;
+  private SharedRbStats* MStats;
 
   /// <summary>
   /// Gets the total capacity of the ring buffer in bytes.
@@ -28,26 +29,53 @@ internal sealed unsafe class RingBuffer : IDisposable
   /// </summary>
   public bool IsDisposed => this.MHandle == IntPtr.Zero;
 
+  /// <summary>
+  /// Gets the native ring buffer handle, for native calls that take the ring itself.
+  /// </summary>
+  internal IntPtr Handle => this.MHandle;
+
   /// <summary>
   /// Creates a new shared-memory ring buffer.
   /// </summary>
   /// <param name="capacity">The size of the ring buffer in bytes.</param>
   /// <param name="name">The unique shared memory name used to create the buffer.</param>
+  /// <param name="mirrored">
+  /// <c>true</c> to map the payload twice, back to back, so records never split at
+  /// the wrap point. The capacity is then rounded up by the native side.
+  /// </param>
+  /// <exception cref="InvalidOperationException">
+  /// Thrown when the native ring buffer cannot be created.
+  /// </exception>
+  public RingBuffer(uint capacity, string name, bool mirrored = false)
+    : this(capacity, name, mirrored ? SharedRbFlags.Mirrored : SharedRbFlags.Default)
+  {
+  }
+
+  /// <summary>
+  /// Creates a new shared-memory ring buffer with options.
+  /// </summary>
+  /// <param name="capacity">The size of the ring buffer in bytes.</param>
+  /// <param name="name">The unique shared memory name used to create the buffer.</param>
+  /// <param name="flags">
+  /// The requested <see cref="SharedRbFlags"/>, e.g. <see cref="SharedRbFlags.Prefault"/>
+  /// so the first writes after startup do not page-fault.
+  /// <see cref="Granted"/> reports what was actually applied.
+  /// </param>
   /// <exception cref="InvalidOperationException">
   /// Thrown when the native ring buffer cannot be created.
   /// </exception>
-  public RingBuffer(uint capacity, string name)
+  public RingBuffer(uint capacity, string name, SharedRbFlags flags)
   {
     var name_bytes = System.Text.Encoding.ASCII.GetBytes(name + "\0");
     fixed (byte* name_ptr = name_bytes)
     {
-      this.MHandle = RingBufferNative.RbCreate((sbyte*)name_ptr, capacity);
+      this.MHandle = RingBufferNative.RbCreateEx((sbyte*)name_ptr, capacity, flags);
     }
 
     if (this.MHandle == IntPtr.Zero)
       throw new InvalidOperationException("Failed to create shared ring buffer.");
 
-    this.Capacity = capacity;
+    this.Capacity = RingBufferNative.RbCapacity(this.MHandle);
   }
 
   /// <summary>
@@ -85,6 +113,64 @@ internal sealed unsafe class RingBuffer : IDisposable
       return RingBufferNative.RbWrite(this.MHandle, ptr, (uint)data.Length);
   }
 
+  /// <summary>
+  /// Writes data into the ring buffer according to a write policy.
+  /// </summary>
+  /// <param name="data">The data to write.</param>
+  /// <param name="policy">What to do when the data does not fit.</param>
+  /// <param name="timeoutMs">The timeout for <see cref="SharedRbWritePolicy.Block"/>; negative waits forever.</param>
+  /// <returns>
+  /// The number of bytes written: all of <paramref name="data"/> or 0, except for
+  /// <see cref="SharedRbWritePolicy.Partial"/>.
+  /// </returns>
+  public uint Write(ReadOnlySpan<byte> data, SharedRbWritePolicy policy, int timeoutMs = -1)
+  {
+    fixed (byte* ptr = data)
+      return RingBufferNative.RbWriteEx(this.MHandle, ptr, (uint)data.Length, policy, timeoutMs);
+  }
+
+  /// <summary>
+  /// Blocks until at least <paramref name="minBytes"/> can be written.
+  /// </summary>
+  /// <param name="minBytes">The number of bytes to wait for.</param>
+  /// <param name="timeoutMs">The timeout in milliseconds; 0 polls, negative waits forever.</param>
+  /// <returns>The number of writable bytes, or 0 on timeout.</returns>
+  public uint WaitWritable(uint minBytes, int timeoutMs = -1) =>
+    RingBufferNative.RbWaitWritable(this.MHandle, minBytes, timeoutMs);
+
+  /// <summary>
+  /// Writes one whole record into a framed ring (<see cref="SharedRbFlags.Framed"/>).
+  /// </summary>
+  /// <param name="type">Application-defined record type.</param>
+  /// <param name="data">The record payload.</param>
+  /// <param name="flags">Application-defined record flags.</param>
+  /// <returns>
+  /// <c>true</c> if the record was written; <c>false</c> if it does not fit right now.
+  /// A record is never split: the reader gets exactly this payload in one piece.
+  /// </returns>
+  public bool WriteRecord(ushort type, ReadOnlySpan<byte> data, ushort flags = 0)
+  {
+    fixed (byte* ptr = data)
+      return RingBufferNative.RbWriteRecord(this.MHandle, type, flags, ptr, (uint)data.Length) != 0;
+  }
+
+  /// <summary>
+  /// Writes one whole record into a framed ring according to a write policy.
+  /// </summary>
+  /// <param name="type">Application-defined record type.</param>
+  /// <param name="data">The record payload.</param>
+  /// <param name="flags">Application-defined record flags.</param>
+  /// <param name="policy">What to do when the record does not fit.</param>
+  /// <param name="timeoutMs">The timeout for <see cref="SharedRbWritePolicy.Block"/>; negative waits forever.</param>
+  /// <returns><c>true</c> if the record was written; <c>false</c> if it was rejected, dropped or timed out.</returns>
+  public bool WriteRecord(ushort type, ReadOnlySpan<byte> data, ushort flags,
+    SharedRbWritePolicy policy, int timeoutMs = -1)
+  {
+    fixed (byte* ptr = data)
+      return RingBufferNative.RbWriteRecordEx(this.MHandle, type, flags, ptr, (uint)data.Length,
+        policy, timeoutMs) != 0;
+  }
+
   /// <summary>
   /// Reads data from the ring buffer.
   /// </summary>
@@ -99,6 +185,29 @@ internal sealed unsafe class RingBuffer : IDisposable
       return RingBufferNative.RbRead(this.MHandle, ptr, (uint)dest.Length);
   }
 
+  /// <summary>
+  /// Gets the options actually applied to the shared mapping.
+  /// </summary>
+  public SharedRbFlags Granted =>
+      RingBufferNative.RbGranted(this.MHandle);
+
+  /// <summary>
+  /// Gets a snapshot of the ring's counters.
+  /// </summary>
+  /// <remarks>
+  /// Reads the statistics block straight from shared memory; after the first
+  /// access this is no native call, and both sides may update it meanwhile.
+  /// </remarks>
+  public SharedRbStats Stats
+  {
+    get
+    {
+      if (this.MStats is null)
+        this.MStats = RingBufferNative.RbStats(this.MHandle);
+      return *this.MStats;
+    }
+  }
+
   /// <summary>
   /// Gets the number of bytes currently available to read.
   /// </summary>
@@ -120,6 +229,7 @@ internal sealed unsafe class RingBuffer : IDisposable
   /// </remarks>
   public void Dispose()
   {
+    this.MStats = null;
     var h = Interlocked.Exchange(ref this.MHandle, IntPtr.Zero);
     if (h != IntPtr.Zero)
       RingBufferNative.RbClose(h);
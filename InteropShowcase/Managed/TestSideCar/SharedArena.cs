@@ -0,0 +1,126 @@
+﻿ 
+
+
+namespace michele.natale;
+
+using Native;
+
+/// <summary>
+/// Provides a managed wrapper around a native shared-memory payload arena.
+/// </summary>
+/// <remarks>
+/// The arena holds payloads too large for the command ring. The host allocates a
+/// run of blocks, fills it in place and sends only its <see cref="SharedArenaDesc"/>;
+/// the Sidecar reads the payload where it is and releases the run afterwards.
+/// </remarks>
+internal sealed unsafe class SharedArena : IDisposable
+{
+  private IntPtr MHandle;
+  private SharedArenaStats* MStats;
+
+  /// <summary>
+  /// Gets the shared memory name of the arena.
+  /// </summary>
+  public string Name { get; }
+
+  /// <summary>
+  /// Gets the size of one block in bytes.
+  /// </summary>
+  public uint BlockSize { get; } = 0;
+
+  /// <summary>
+  /// Gets the number of blocks.
+  /// </summary>
+  public uint BlockCount { get; } = 0;
+
+  /// <summary>
+  /// Indicates whether the arena has already been disposed.
+  /// </summary>
+  public bool IsDisposed => this.MHandle == IntPtr.Zero;
+
+  /// <summary>
+  /// Creates a new shared-memory arena.
+  /// </summary>
+  /// <param name="name">The unique shared memory name used to create the arena.</param>
+  /// <param name="blockSize">Bytes per block; rounded up to a multiple of 64 by the native side.</param>
+  /// <param name="blockCount">The number of blocks.</param>
+  /// <exception cref="InvalidOperationException">
+  /// Thrown when the native arena cannot be created.
+  /// </exception>
+  public SharedArena(string name, uint blockSize, uint blockCount)
+  {
+    var name_bytes = System.Text.Encoding.ASCII.GetBytes(name + "\0");
+    fixed (byte* name_ptr = name_bytes)
+    {
+      this.MHandle = SharedArenaNative.ArenaCreate((sbyte*)name_ptr, blockSize, blockCount);
+    }
+
+    if (this.MHandle == IntPtr.Zero)
+      throw new InvalidOperationException("Failed to create shared arena.");
+
+    this.Name = name;
+    this.BlockSize = SharedArenaNative.ArenaBlockSize(this.MHandle);
+    this.BlockCount = SharedArenaNative.ArenaBlockCount(this.MHandle);
+  }
+
+  /// <summary>
+  /// Allocates a run of blocks for a payload, without blocking.
+  /// </summary>
+  /// <param name="length">The number of payload bytes.</param>
+  /// <param name="desc">Receives the descriptor to send, or to <see cref="Release"/> if it is never sent.</param>
+  /// <returns>
+  /// The writable payload, or an empty span if no free run of that size exists right now;
+  /// the Sidecar frees blocks as it finishes messages, so retry later.
+  /// </returns>
+  public Span<byte> Alloc(uint length, out SharedArenaDesc desc)
+  {
+    SharedArenaDesc d;
+    var ptr = SharedArenaNative.ArenaAlloc(this.MHandle, length, &d);
+    desc = ptr is null ? default : d;
+    return ptr is null ? [] : new Span<byte>(ptr, (int)length);
+  }
+
+  /// <summary>
+  /// Releases a run that was allocated but never sent.
+  /// </summary>
+  /// <param name="desc">The descriptor from <see cref="Alloc"/>.</param>
+  /// <returns><c>true</c> if the run was released; <c>false</c> if the descriptor is stale.</returns>
+  public bool Release(in SharedArenaDesc desc)
+  {
+    fixed (SharedArenaDesc* ptr = &desc)
+      return SharedArenaNative.ArenaRelease(this.MHandle, ptr) != 0;
+  }
+
+  /// <summary>
+  /// Gets the number of free blocks right now.
+  /// </summary>
+  public uint FreeBlocks =>
+      SharedArenaNative.ArenaFreeBlocks(this.MHandle);
+
+  /// <summary>
+  /// Gets a snapshot of the arena's counters, read straight from shared memory.
+  /// </summary>
+  public SharedArenaStats Stats
+  {
+    get
+    {
+      if (this.MStats is null)
+        this.MStats = SharedArenaNative.ArenaStats(this.MHandle);
+      return *this.MStats;
+    }
+  }
+
+  /// <summary>
+  /// Releases the native arena handle.
+  /// </summary>
+  /// <remarks>
+  /// This method is safe to call multiple times. Runs still in flight are dropped.
+  /// </remarks>
+  public void Dispose()
+  {
+    this.MStats = null;
+    var h = Interlocked.Exchange(ref this.MHandle, IntPtr.Zero);
+    if (h != IntPtr.Zero)
+      SharedArenaNative.ArenaClose(h);
+  }
+}
@@ -1,4 +1,5 @@
 ﻿
+using System.Collections.Concurrent;
 using System.Runtime.InteropServices;
 
 
@@ -17,10 +18,15 @@ using Native;
 /// <item>Pinning the shared memory name for native interop</item>
 /// <item>Providing unmanaged callback functions via <see cref="SidecarHostVTable"/></item>
 /// <item>Starting and stopping the native Sidecar worker thread</item>
-/// <item>Forwarding commands and receiving events</item>
+/// <item>Forwarding commands and receiving events (callback or event ring)</item>
+/// <item>Pipelined RPC: requests carry correlation ids, responses complete per-request tasks</item>
+/// <item>Optional input lanes: extra command rings served by priority or weight</item>
+/// <item>Optionally running the worker out of process (SidecarWorker), supervised and restarted</item>
 /// </list>
 /// The <see cref="SidecarHost"/> must remain alive for the entire lifetime of the
 /// Sidecar worker, as it owns the pinned memory and callback table.
+/// Each host drives its own native sidecar instance, so several hosts
+/// (with different names) can run side by side.
 /// </remarks>
 internal sealed unsafe class SidecarHost : IDisposable
 {
@@ -28,6 +34,40 @@ internal sealed unsafe class SidecarHost : IDisposable
   private readonly RingBuffer MRb;
   private readonly byte[] MNameBytes;
   private readonly SidecarHostVTable MVTable;
+  private IntPtr MSidecar;
+
+  private GCHandle MEventsNameHandle;
+  private readonly RingBuffer? MEvents;
+  private byte[] MEventBuffer = new byte[256];
+  private (uint Spins, uint Yields)? MWaitStrategy;
+  private (uint Count, uint Bytes)? MBatchLimits;
+  private bool MZeroCopy;
+  private (ulong AffinityMask, SidecarSchedPolicy Policy, int Priority, string? Name)? MThreadOptions;
+  private (uint SampleEvery, uint MaxSpans)? MTracing;
+  private uint MTraceEvery;
+  private uint MTraceCount;
+  private SharedRbWritePolicy MWritePolicy = SharedRbWritePolicy.AllOrNothing;
+  private int MWriteTimeoutMs;
+  private (string? Path, ulong SegmentBytes)? MJournal;
+  private SharedArena? MArena;
+  private bool MArenaApplied;
+  private readonly List<(RingBuffer Ring, string Name, int Priority, uint Weight)> MLanes = [];
+  private (int Priority, uint Weight) MCommandLane = (0, 1);
+  private SidecarLanePolicy MLanePolicy = SidecarLanePolicy.Strict;
+  private int MLanesApplied;
+  private IntPtr MProcess;
+  private const int ProcessStopTimeoutMs = 2000;   // Time a worker process gets to exit before it is killed
+
+  private readonly ConcurrentDictionary<ulong, TaskCompletionSource<SidecarResponse>> MPending = new();
+  private byte[] MRequestBuffer = new byte[256];
+  private long MNextCorrelationId;
+
+  /// <summary>
+  /// Handles one event drained from the event ring.
+  /// </summary>
+  /// <param name="eventId">Numeric event identifier.</param>
+  /// <param name="data">The event payload; only valid during the call.</param>
+  public delegate void EventHandler(int eventId, ReadOnlySpan<byte> data);
 
   /// <summary>
   /// Gets a value indicating whether the Sidecar worker has been started.
@@ -39,28 +79,51 @@ internal sealed unsafe class SidecarHost : IDisposable
   /// </summary>
   /// <param name="name">The shared memory name used for the ring buffer.</param>
   /// <param name="capacity">The size of the ring buffer in bytes.</param>
+  /// <param name="flags">
+  /// Mapping options for the ring buffer (prefault, lock, mirrored). The command ring
+  /// is always <see cref="SharedRbFlags.Framed"/>, so every command reaches the
+  /// sidecar as exactly one message.
+  /// </param>
+  /// <param name="eventCapacity">
+  /// Size of the event ring in bytes. 0 delivers events through the <c>OnEvent</c>
+  /// callback on the sidecar thread; otherwise the sidecar writes them into a second
+  /// shared ring (<c>name + "_events"</c>) that is drained with <see cref="DrainEvents"/>.
+  /// </param>
+  /// <param name="batched">
+  /// Receive commands through <c>ProcessBatch</c> (one transition per batch)
+  /// instead of one <c>Process</c> call per message.
+  /// </param>
   /// <remarks>
   /// This constructor:
   /// <list type="bullet">
-  /// <item>Creates a new shared ring buffer</item>
+  /// <item>Creates a new shared ring buffer (and the event ring, if requested)</item>
   /// <item>Pins the shared memory name for native use</item>
   /// <item>Initializes the unmanaged callback table</item>
   /// </list>
   /// </remarks>
-  public SidecarHost(string name, uint capacity)
+  public SidecarHost(string name, uint capacity, SharedRbFlags flags = SharedRbFlags.Default,
+    uint eventCapacity = 0, bool batched = false)
   {
-    this.MRb = new RingBuffer(capacity, name);
+    this.MRb = new RingBuffer(capacity, name, flags | SharedRbFlags.Framed);
 
     this.MNameBytes = System.Text.Encoding.ASCII.GetBytes(name + "\0");
     this.MNameHandle = GCHandle.Alloc(this.MNameBytes, GCHandleType.Pinned);
 
+    if (eventCapacity > 0)
+    {
+      this.MEvents = new RingBuffer(eventCapacity, name + "_events", flags);
+      var events_name = System.Text.Encoding.ASCII.GetBytes(name + "_events\0");
+      this.MEventsNameHandle = GCHandle.Alloc(events_name, GCHandleType.Pinned);
+    }
+
     this.MVTable = new SidecarHostVTable
     {
       //Funktionen mitnehmen
       Init = &InitImpl,
       Dispose = &DisposeImpl,
       Process = &ProcessImpl,
-      OnEvent = &OnEventImpl
+      OnEvent = this.MEvents is null ? &OnEventImpl : null,
+      ProcessBatch = batched ? &ProcessBatchImpl : null
     };
   }
 
@@ -70,9 +133,9 @@ internal sealed unsafe class SidecarHost : IDisposable
   /// <remarks>
   /// This method:
   /// <list type="bullet">
-  /// <item>Builds a <see cref="SidecarRingBufferDesc"/> pointing to the shared memory</item>
-  /// <item>Passes the callback table and descriptor to the native <c>sidecar_start</c></item>
-  /// <item>Ensures the worker thread begins processing commands</item>
+  /// <item>Builds a <see cref="SidecarChannelDesc"/> pointing to the shared memory</item>
+  /// <item>Creates the native sidecar instance on first use (<c>sidecar_create</c>)</item>
+  /// <item>Starts its worker thread (<c>sidecar_start_ex</c>)</item>
   /// </list>
   /// Calling this method multiple times has no effect.
   /// </remarks>
@@ -81,16 +144,72 @@ internal sealed unsafe class SidecarHost : IDisposable
     if (this.IsStarted) return;
     this.IsStarted = true;
 
-    var desc = new SidecarRingBufferDesc
+    if (this.MSidecar == IntPtr.Zero)
     {
-      Name = this.MNameHandle.AddrOfPinnedObject(),
-      Capacity = this.MRb.Capacity
-    };
+      var channel = this.ChannelDesc();
+
+      fixed (SidecarHostVTable* v = &this.MVTable)
+      {
+        this.MSidecar = SidecarNative.SidecarCreate(v, &channel);
+      }
+
+      if (this.MSidecar == IntPtr.Zero)
+      {
+        this.IsStarted = false;
+        throw new InvalidOperationException("Failed to create the native sidecar.");
+      }
 
-    fixed (SidecarHostVTable* v = &this.MVTable)
+      if (this.MWaitStrategy is { } wait)
+        SidecarNative.SidecarSetWaitStrategy(this.MSidecar, wait.Spins, wait.Yields);
+      if (this.MBatchLimits is { } batch)
+        SidecarNative.SidecarSetBatchLimits(this.MSidecar, batch.Count, batch.Bytes);
+      if (this.MZeroCopy)
+        SidecarNative.SidecarSetZeroCopy(this.MSidecar, 1);
+      if (this.MThreadOptions is { } thread)
+        this.ApplyThreadOptions(thread.AffinityMask, thread.Policy, thread.Priority, thread.Name);
+    }
+
+    SidecarNative.SidecarSetLane(this.MSidecar, 0, this.MCommandLane.Priority, this.MCommandLane.Weight);
+    SidecarNative.SidecarSetLanePolicy(this.MSidecar, this.MLanePolicy);
+    for (; this.MLanesApplied < this.MLanes.Count; this.MLanesApplied++)
     {
-      SidecarNative.SidecarStart(v, &desc);
+      var lane = this.MLanes[this.MLanesApplied];
+      if (this.AddNativeLane(lane.Ring, lane.Name, lane.Priority, lane.Weight) < 0)
+      {
+        this.IsStarted = false;
+        throw new InvalidOperationException($"Failed to add the input lane '{lane.Name}'.");
+      }
     }
+
+    if (this.MTracing is { } tracing)
+    {
+      SidecarNative.SidecarSetTracing(this.MSidecar, tracing.SampleEvery > 0 ? 1 : 0, tracing.MaxSpans);
+      this.MTraceEvery = tracing.SampleEvery;
+      this.MTraceCount = 0;
+      this.MTracing = null;
+    }
+
+    if (this.MJournal is { } journal)
+    {
+      this.MJournal = null;
+      if (SidecarNative.SidecarSetJournal(this.MSidecar, journal.Path, journal.SegmentBytes) == 0)
+      {
+        this.IsStarted = false;
+        throw new InvalidOperationException($"Failed to create the command journal '{journal.Path}'.");
+      }
+    }
+
+    if (this.MArena is { } arena && !this.MArenaApplied)
+    {
+      if (SidecarNative.SidecarSetArena(this.MSidecar, arena.Name) == 0)
+      {
+        this.IsStarted = false;
+        throw new InvalidOperationException($"Failed to attach the arena '{arena.Name}'.");
+      }
+      this.MArenaApplied = true;
+    }
+
+    SidecarNative.SidecarStartEx(this.MSidecar);
   }
 
   /// <summary>
@@ -98,23 +217,668 @@ internal sealed unsafe class SidecarHost : IDisposable
   /// </summary>
   /// <remarks>
   /// This method signals the worker loop to exit and waits for the native
-  /// thread to shut down.  
+  /// thread to shut down. A worker process (<see cref="StartProcess"/>) gets its
+  /// standard input closed and is killed if it has not exited within 2 s.  
   /// Safe to call multiple times.
   /// </remarks>
   public void Stop()
   {
     if (!this.IsStarted) return;
-    SidecarNative.SidecarStop();
+    if (this.MProcess != IntPtr.Zero)
+    {
+      SidecarNative.SidecarProcessStop(this.MProcess, ProcessStopTimeoutMs);
+      this.MProcess = IntPtr.Zero;
+    }
+    else
+      SidecarNative.SidecarStopEx(this.MSidecar);
     this.IsStarted = false;
   }
 
+  /// <summary>
+  /// Runs the Sidecar in a SidecarWorker process of its own instead of a thread
+  /// of this process, and restarts it if it dies.
+  /// </summary>
+  /// <param name="executable">The path of the SidecarWorker executable.</param>
+  /// <param name="plugin">
+  /// A plugin library that processes the commands (native <c>sidecar_plugin_vtable</c>),
+  /// or <c>null</c> for the built-in handler, which answers every RPC request with its payload.
+  /// </param>
+  /// <param name="maxRestarts">Restarts after unexpected exits before giving up.</param>
+  /// <param name="restartDelayMs">Delay before the first restart; 0 for 100 ms. Doubles up to 5 s.</param>
+  /// <remarks>
+  /// Callbacks cannot cross the process boundary, so the host needs an event ring
+  /// (<c>eventCapacity</c> &gt; 0) for acks and responses. The worker takes over the
+  /// lanes, lane policy, batch limits, zero-copy delivery, the arena and CPU affinity; tracing
+  /// and the journal stay in-process features. Commands are written and events drained
+  /// exactly as with <see cref="Start"/>; a restarted worker continues where the dead
+  /// one stopped reading. <see cref="Stop"/> ends the worker and its supervision.
+  /// </remarks>
+  public void StartProcess(string executable, string? plugin = null, uint maxRestarts = 3, uint restartDelayMs = 0)
+  {
+    if (this.IsStarted) return;
+    if (this.MEvents is null)
+      throw new InvalidOperationException("A worker process needs an event ring (eventCapacity > 0).");
+
+    var args = new List<string>();
+    foreach (var lane in this.MLanes)
+      args.AddRange(["--lane", $"{lane.Name}:{lane.Priority}:{lane.Weight}"]);
+    if (this.MLanePolicy == SidecarLanePolicy.Weighted)
+      args.AddRange(["--lane-policy", "weighted"]);
+    if (this.MBatchLimits is { } batch)
+      args.AddRange(["--batch", $"{batch.Count}:{batch.Bytes}"]);
+    if (this.MZeroCopy)
+      args.Add("--zero-copy");
+    if (this.MThreadOptions is { AffinityMask: not 0 } thread)
+      args.AddRange(["--affinity", $"0x{thread.AffinityMask:X}"]);
+    if (this.MArena is { } arena)
+      args.AddRange(["--arena", arena.Name]);
+
+    var executable_ptr = Marshal.StringToCoTaskMemUTF8(executable);
+    var plugin_ptr = plugin is null ? IntPtr.Zero : Marshal.StringToCoTaskMemUTF8(plugin);
+    var argv = args.Select(Marshal.StringToCoTaskMemUTF8).ToArray();
+    try
+    {
+      fixed (nint* p = argv)
+      {
+        var desc = new SidecarProcessDesc
+        {
+          Executable = executable_ptr,
+          Channel = this.ChannelDesc(),
+          Plugin = plugin_ptr,
+          Args = (nint)p,
+          ArgCount = (uint)argv.Length,
+          MaxRestarts = maxRestarts,
+          RestartDelayMs = restartDelayMs
+        };
+        this.MProcess = SidecarNative.SidecarProcessSpawn(&desc);
+      }
+    }
+    finally
+    {
+      Marshal.FreeCoTaskMem(executable_ptr);
+      Marshal.FreeCoTaskMem(plugin_ptr);
+      foreach (var arg in argv)
+        Marshal.FreeCoTaskMem(arg);
+    }
+
+    if (this.MProcess == IntPtr.Zero)
+      throw new InvalidOperationException($"Failed to start the worker process '{executable}'.");
+    this.IsStarted = true;
+  }
+
+  /// <summary>
+  /// Gets the state of the worker process started with <see cref="StartProcess"/>.
+  /// </summary>
+  public SidecarProcessState ProcessState => this.MProcess == IntPtr.Zero
+    ? SidecarProcessState.Stopped : SidecarNative.SidecarProcessGetState(this.MProcess);
+
+  /// <summary>
+  /// Gets the pid of the current worker process, or 0 while none runs.
+  /// </summary>
+  public long ProcessId => this.MProcess == IntPtr.Zero ? 0 : SidecarNative.SidecarProcessPid(this.MProcess);
+
+  /// <summary>
+  /// Gets how often the worker process was restarted.
+  /// </summary>
+  public uint ProcessRestarts => this.MProcess == IntPtr.Zero ? 0 : SidecarNative.SidecarProcessRestarts(this.MProcess);
+
+  private SidecarChannelDesc ChannelDesc() => new()
+  {
+    Commands = new SidecarRingBufferDesc
+    {
+      Name = this.MNameHandle.AddrOfPinnedObject(),
+      Capacity = this.MRb.Capacity
+    },
+    Events = this.MEvents is null ? default : new SidecarRingBufferDesc
+    {
+      Name = this.MEventsNameHandle.AddrOfPinnedObject(),
+      Capacity = this.MEvents.Capacity
+    }
+  };
+
+  /// <summary>
+  /// Configures how the Sidecar worker waits while no command is pending.
+  /// </summary>
+  /// <param name="spins">Busy-spin iterations before yielding.</param>
+  /// <param name="yields">Time-slice yields before parking.</param>
+  /// <remarks>
+  /// After both phases the worker parks until the next <see cref="SendCommand"/>,
+  /// which wakes it within microseconds. (0, 0) keeps idle CPU at zero; larger
+  /// values trade CPU for latency. Can be called before or after <see cref="Start"/>.
+  /// </remarks>
+  public void SetWaitStrategy(uint spins, uint yields)
+  {
+    this.MWaitStrategy = (spins, yields);
+    if (this.MSidecar != IntPtr.Zero)
+      SidecarNative.SidecarSetWaitStrategy(this.MSidecar, spins, yields);
+  }
+
+  /// <summary>
+  /// Limits how many messages and bytes the Sidecar worker drains per batch.
+  /// </summary>
+  /// <param name="maxCount">Maximum number of messages per batch.</param>
+  /// <param name="maxBytes">Maximum number of payload bytes per batch.</param>
+  /// <remarks>
+  /// Applies from the next <see cref="Start"/>; a running worker keeps its limits.
+  /// </remarks>
+  public void SetBatchLimits(uint maxCount, uint maxBytes)
+  {
+    this.MBatchLimits = (maxCount, maxBytes);
+    if (this.MSidecar != IntPtr.Zero)
+      SidecarNative.SidecarSetBatchLimits(this.MSidecar, maxCount, maxBytes);
+  }
+
+  /// <summary>
+  /// Delivers commands to the callbacks in place, straight from shared memory.
+  /// </summary>
+  /// <param name="enabled"><c>true</c> for in-place delivery, <c>false</c> to copy.</param>
+  /// <remarks>
+  /// Removes the per-message copy and the 1 KB message cap. The callback's
+  /// pointer is only valid during the call. With <see cref="SharedRbFlags.Mirrored"/>
+  /// a wrapped command still arrives as one contiguous message.
+  /// Applies from the next <see cref="Start"/>.
+  /// </remarks>
+  public void SetZeroCopy(bool enabled)
+  {
+    this.MZeroCopy = enabled;
+    if (this.MSidecar != IntPtr.Zero)
+      SidecarNative.SidecarSetZeroCopy(this.MSidecar, enabled ? 1 : 0);
+  }
+
+  /// <summary>
+  /// Pins the Sidecar worker to CPUs and selects its scheduling policy and name.
+  /// </summary>
+  /// <param name="affinityMask">Bit n allows logical CPU n; 0 keeps every CPU.</param>
+  /// <param name="policy">The scheduling policy.</param>
+  /// <param name="priority">Nice value (<see cref="SidecarSchedPolicy.Other"/>) or
+  /// real-time priority (<see cref="SidecarSchedPolicy.Fifo"/>).</param>
+  /// <param name="name">The thread name, or <c>null</c> for "sidecar".</param>
+  /// <remarks>
+  /// Pin the worker away from the host's threads for stable tail latency.
+  /// Applies from the next <see cref="Start"/>; <see cref="ThreadGranted"/>
+  /// then reports what took effect.
+  /// </remarks>
+  public void SetThreadOptions(ulong affinityMask, SidecarSchedPolicy policy = SidecarSchedPolicy.Default,
+    int priority = 0, string? name = null)
+  {
+    this.MThreadOptions = (affinityMask, policy, priority, name);
+    if (this.MSidecar != IntPtr.Zero)
+      this.ApplyThreadOptions(affinityMask, policy, priority, name);
+  }
+
+  /// <summary>
+  /// Gets the thread options the worker applied on the last <see cref="Start"/>.
+  /// </summary>
+  public SidecarThreadGranted ThreadGranted => this.MSidecar == IntPtr.Zero
+    ? SidecarThreadGranted.None : SidecarNative.SidecarThreadGranted(this.MSidecar);
+
+  private void ApplyThreadOptions(ulong affinityMask, SidecarSchedPolicy policy, int priority, string? name)
+  {
+    var namePtr = name is null ? IntPtr.Zero : Marshal.StringToCoTaskMemUTF8(name);
+    try
+    {
+      var options = new SidecarThreadOptions
+      {
+        AffinityMask = affinityMask,
+        Policy = policy,
+        Priority = priority,
+        Name = namePtr
+      };
+      SidecarNative.SidecarSetThreadOptions(this.MSidecar, &options);
+    }
+    finally
+    {
+      Marshal.FreeCoTaskMem(namePtr);
+    }
+  }
+
   /// <summary>
   /// Sends a command to the Sidecar worker via the shared ring buffer.
   /// </summary>
   /// <param name="command">The command payload to write.</param>
-  public void SendCommand(ReadOnlySpan<byte> command)
+  /// <returns><c>false</c> if the ring is too full to take the whole command (see <see cref="SetBackpressure"/>).</returns>
+  public bool SendCommand(ReadOnlySpan<byte> command) => this.SendCommand(0, command);
+
+  /// <summary>
+  /// Sends a typed command to the Sidecar worker as one framed record.
+  /// </summary>
+  /// <param name="type">Application-defined command type (<see cref="SidecarMessage.Type"/>).</param>
+  /// <param name="command">The command payload to write.</param>
+  /// <returns><c>false</c> if the ring is too full to take the whole command (see <see cref="SetBackpressure"/>).</returns>
+  public bool SendCommand(ushort type, ReadOnlySpan<byte> command)
+  {
+    return this.WriteCommand(type, command, SidecarMessageFlags.None);
+  }
+
+  /// <summary>
+  /// Samples every n-th command for latency tracing.
+  /// </summary>
+  /// <param name="sampleEvery">Trace every n-th command or request; 0 disables tracing.</param>
+  /// <param name="maxSpans">Number of traced commands kept for <see cref="DumpTrace"/>.</param>
+  /// <remarks>
+  /// A sampled command carries a <see cref="SidecarTraceHeader"/> stamped right before
+  /// the write; the Sidecar stamps read, callback start and end, and the ack or
+  /// response, and aggregates the stages into histograms on its own thread
+  /// (<see cref="TracePercentile"/>). Unsampled commands cost one counter test.
+  /// Applies from the next <see cref="Start"/>, which resets the histograms.
+  /// </remarks>
+  public void SetTracing(uint sampleEvery, uint maxSpans = 10_000)
+  {
+    this.MTracing = (sampleEvery, maxSpans);
+  }
+
+  /// <summary>
+  /// Gets a latency percentile of a trace stage, e.g. <c>TracePercentile(SidecarTraceStage.Total, 99)</c>.
+  /// </summary>
+  /// <param name="stage">The latency stage.</param>
+  /// <param name="percentile">0..100.</param>
+  /// <returns>The latency, or <see cref="TimeSpan.Zero"/> without samples.</returns>
+  public TimeSpan TracePercentile(SidecarTraceStage stage, double percentile) =>
+    this.MSidecar == IntPtr.Zero ? TimeSpan.Zero
+      : TimeSpan.FromTicks((long)(SidecarNative.SidecarTracePercentile(this.MSidecar, stage, percentile) / 100));
+
+  /// <summary>
+  /// Writes the traced commands as Chrome trace JSON, for chrome://tracing or ui.perfetto.dev.
+  /// </summary>
+  /// <param name="path">The output file.</param>
+  /// <returns>The number of commands written, or -1 if tracing is off or the file cannot be written.</returns>
+  public int DumpTrace(string path) =>
+    this.MSidecar == IntPtr.Zero ? -1 : SidecarNative.SidecarTraceDump(this.MSidecar, path);
+
+  /// <summary>
+  /// Records every command the Sidecar drains into a command journal, for
+  /// <see cref="Replay"/>; <c>null</c> stops journaling.
+  /// </summary>
+  /// <param name="path">The file prefix; segments are <c>path.000000</c>, <c>path.000001</c>, ...</param>
+  /// <param name="segmentBytes">The size of one segment file; 0 for the default (64 MB).</param>
+  /// <remarks>
+  /// The Sidecar thread appends each command with its timestamp, type, flags and
+  /// payload to a memory-mapped file and rotates to the next file when it is full,
+  /// so journaling costs a copy per command and no syscall. Earlier segments at the
+  /// same path are replaced. Applies from the next <see cref="Start"/>.
+  /// </remarks>
+  public void SetJournal(string? path, ulong segmentBytes = 0)
+  {
+    this.MJournal = (path, segmentBytes);
+  }
+
+  /// <summary>
+  /// Gets the number of commands journaled since <see cref="SetJournal"/> took effect.
+  /// </summary>
+  public ulong JournalCount =>
+    this.MSidecar == IntPtr.Zero ? 0 : SidecarNative.SidecarJournalCount(this.MSidecar);
+
+  /// <summary>
+  /// Feeds a recorded command journal to this Sidecar, e.g. as a repeatable benchmark input.
+  /// </summary>
+  /// <param name="path">The file prefix given to <see cref="SetJournal"/>.</param>
+  /// <param name="speed">1.0 keeps the recorded timing, 2.0 plays twice as fast; 0 writes flat out.</param>
+  /// <param name="timeoutMs">The longest wait for ring space per command; negative waits forever.</param>
+  /// <returns>The number of commands written, or -1 if the journal cannot be opened.</returns>
+  /// <remarks>
+  /// Runs on the calling thread and blocks on ring space, so no command is lost.
+  /// Do not send commands meanwhile; drain events on another thread if the event ring
+  /// could fill up. Replayed RPC requests carry their recorded correlation ids.
+  /// </remarks>
+  public long Replay(string path, double speed = 1.0, int timeoutMs = -1) =>
+    SidecarNative.SidecarJournalReplay(path, this.MRb.Handle, speed, timeoutMs);
+
+  /// <summary>
+  /// Creates a shared payload arena for commands too large for the command ring
+  /// (<see cref="AllocArena"/>, <see cref="SendArena"/>).
+  /// </summary>
+  /// <param name="name">The shared memory name of the arena.</param>
+  /// <param name="blockSize">Bytes per block; a payload spans as many adjacent blocks as it needs.</param>
+  /// <param name="blockCount">The number of blocks.</param>
+  /// <remarks>
+  /// Only the 16-byte descriptor of a payload passes through the command ring, so a
+  /// large payload is written once, read in place by the Sidecar and never blocks the
+  /// small commands behind it. The journal records descriptors, not the payloads.
+  /// Only while the Sidecar is stopped; replaces an earlier arena and applies from
+  /// the next <see cref="Start"/>.
+  /// </remarks>
+  public void SetArena(string name, uint blockSize, uint blockCount)
+  {
+    if (this.IsStarted)
+      throw new InvalidOperationException("The arena can only be set while the Sidecar is stopped.");
+
+    if (this.MArenaApplied)
+      SidecarNative.SidecarSetArena(this.MSidecar, null);
+    this.MArena?.Dispose();
+    this.MArena = new SharedArena(name, blockSize, blockCount);
+    this.MArenaApplied = false;
+  }
+
+  /// <summary>
+  /// Allocates room for a large payload in the arena, to fill in place and pass to
+  /// <see cref="SendArena"/>.
+  /// </summary>
+  /// <param name="length">The number of payload bytes.</param>
+  /// <param name="desc">Receives the descriptor of the payload.</param>
+  /// <returns>
+  /// The writable payload, or an empty span while the arena has no free run that
+  /// large; the Sidecar frees a payload after its batch, so retry after draining acks.
+  /// </returns>
+  /// <remarks>
+  /// Never blocks. Several threads may allocate at once.
+  /// </remarks>
+  public Span<byte> AllocArena(uint length, out SharedArenaDesc desc)
+  {
+    if (this.MArena is null)
+      throw new InvalidOperationException("No arena; call SetArena first.");
+    return this.MArena.Alloc(length, out desc);
+  }
+
+  /// <summary>
+  /// Sends a payload allocated with <see cref="AllocArena"/> as a typed command.
+  /// </summary>
+  /// <param name="type">Application-defined command type (<see cref="SidecarMessage.Type"/>).</param>
+  /// <param name="desc">The descriptor from <see cref="AllocArena"/>.</param>
+  /// <returns>
+  /// <c>false</c> if the ring is too full (see <see cref="SetBackpressure"/>); the payload
+  /// then still belongs to the caller, to send again or to <see cref="ReleaseArena"/>.
+  /// </returns>
+  /// <remarks>
+  /// On success the Sidecar owns the payload: it reaches <c>Process</c> / <c>ProcessBatch</c>
+  /// in place, and is released before its ack is written.
+  /// </remarks>
+  public bool SendArena(ushort type, in SharedArenaDesc desc)
+  {
+    return this.WriteCommand(type, MemoryMarshal.AsBytes(new ReadOnlySpan<SharedArenaDesc>(in desc)),
+      SidecarMessageFlags.Arena);
+  }
+
+  /// <summary>
+  /// Releases a payload that was allocated but not sent.
+  /// </summary>
+  /// <param name="desc">The descriptor from <see cref="AllocArena"/>.</param>
+  /// <returns><c>false</c> if the payload was already released.</returns>
+  public bool ReleaseArena(in SharedArenaDesc desc) =>
+    this.MArena?.Release(in desc) ?? false;
+
+  /// <summary>
+  /// Gets the number of free arena blocks (0 without an arena).
+  /// </summary>
+  public uint ArenaFreeBlocks => this.MArena?.FreeBlocks ?? 0;
+
+  /// <summary>
+  /// Gets the counters of the arena, or <c>null</c> without one.
+  /// </summary>
+  public SharedArenaStats? ArenaStats => this.MArena?.Stats;
+
+  /// <summary>
+  /// Chooses what <see cref="SendCommand(ushort, ReadOnlySpan{byte})"/> and
+  /// <see cref="TrySendRequest"/> do when the command ring is too full.
+  /// </summary>
+  /// <param name="policy">
+  /// <see cref="SharedRbWritePolicy.AllOrNothing"/> (the default) fails at once,
+  /// <see cref="SharedRbWritePolicy.Block"/> waits for the Sidecar to drain,
+  /// <see cref="SharedRbWritePolicy.Drop"/> fails and counts the command in
+  /// <see cref="SharedRbStats.Dropped"/>.
+  /// </param>
+  /// <param name="timeoutMs">The longest wait for <see cref="SharedRbWritePolicy.Block"/>; negative waits forever.</param>
+  /// <remarks>
+  /// A blocked sender parks in the kernel and is woken by the Sidecar's read,
+  /// so backpressure costs no CPU. Commands are never split, whatever the policy.
+  /// Applies to the next command.
+  /// </remarks>
+  public void SetBackpressure(SharedRbWritePolicy policy, int timeoutMs = -1)
+  {
+    this.MWritePolicy = policy == SharedRbWritePolicy.Partial ? SharedRbWritePolicy.AllOrNothing : policy;
+    this.MWriteTimeoutMs = timeoutMs;
+  }
+
+  /// <summary>
+  /// Adds an input lane: a second command ring that the Sidecar serves by
+  /// priority or weight, so urgent commands do not queue behind bulk work.
+  /// </summary>
+  /// <param name="name">The shared memory name of the lane's ring.</param>
+  /// <param name="capacity">The size of the lane's ring in bytes.</param>
+  /// <param name="priority">Higher is served first (<see cref="SidecarLanePolicy.Strict"/>); the command ring has 0.</param>
+  /// <param name="weight">Batches per round (<see cref="SidecarLanePolicy.Weighted"/>); the command ring has 1.</param>
+  /// <returns>The lane index for <see cref="SendToLane"/> and <see cref="LaneStats"/>; lane 0 is the command ring.</returns>
+  /// <remarks>
+  /// The lane's ring is framed and uses the backpressure policy of the command ring.
+  /// A batch never mixes lanes, and the Sidecar parks on all lanes at once while
+  /// they are empty. Only while the Sidecar is stopped; applies from the next <see cref="Start"/>.
+  /// </remarks>
+  public int AddLane(string name, uint capacity, int priority, uint weight = 1)
+  {
+    if (this.IsStarted)
+      throw new InvalidOperationException("Lanes can only be added while the Sidecar is stopped.");
+
+    var ring = new RingBuffer(capacity, name, SharedRbFlags.Framed);
+    this.MLanes.Add((ring, name, priority, weight));
+    return this.MLanes.Count;
+  }
+
+  /// <summary>
+  /// Changes the priority and weight of a lane; 0 is the command ring.
+  /// </summary>
+  /// <param name="lane">The lane index.</param>
+  /// <param name="priority">Higher is served first (<see cref="SidecarLanePolicy.Strict"/>).</param>
+  /// <param name="weight">Batches per round (<see cref="SidecarLanePolicy.Weighted"/>).</param>
+  /// <remarks>
+  /// Only while the Sidecar is stopped; applies from the next <see cref="Start"/>.
+  /// </remarks>
+  public void SetLane(int lane, int priority, uint weight = 1)
+  {
+    if (this.IsStarted)
+      throw new InvalidOperationException("Lanes can only be changed while the Sidecar is stopped.");
+    ArgumentOutOfRangeException.ThrowIfNegative(lane);
+    ArgumentOutOfRangeException.ThrowIfGreaterThan(lane, this.MLanes.Count);
+
+    if (lane == 0)
+      this.MCommandLane = (priority, weight);
+    else
+      this.MLanes[lane - 1] = this.MLanes[lane - 1] with { Priority = priority, Weight = weight };
+
+    if (this.MSidecar != IntPtr.Zero && lane <= this.MLanesApplied)
+      SidecarNative.SidecarSetLane(this.MSidecar, (uint)lane, priority, weight);
+  }
+
+  /// <summary>
+  /// Chooses how the Sidecar picks the lane of the next batch: strict priority
+  /// (the default) or weighted round-robin.
+  /// </summary>
+  /// <param name="policy">The lane policy.</param>
+  /// <remarks>
+  /// Applies from the next <see cref="Start"/>.
+  /// </remarks>
+  public void SetLanePolicy(SidecarLanePolicy policy)
+  {
+    this.MLanePolicy = policy;
+  }
+
+  /// <summary>
+  /// Gets the number of lanes, the command ring included.
+  /// </summary>
+  public int LaneCount => 1 + this.MLanes.Count;
+
+  /// <summary>
+  /// Sends a typed command to the Sidecar through an input lane.
+  /// </summary>
+  /// <param name="lane">The lane index from <see cref="AddLane"/>; 0 is the command ring.</param>
+  /// <param name="type">Application-defined command type (<see cref="SidecarMessage.Type"/>).</param>
+  /// <param name="command">The command payload to write.</param>
+  /// <returns><c>false</c> if the lane is too full to take the whole command (see <see cref="SetBackpressure"/>).</returns>
+  /// <remarks>
+  /// Every lane is its own ring with a single producer, so each lane can be
+  /// fed by its own thread.
+  /// </remarks>
+  public bool SendToLane(int lane, ushort type, ReadOnlySpan<byte> command)
+  {
+    return this.WriteCommand(this.LaneRing(lane), type, command, SidecarMessageFlags.None);
+  }
+
+  /// <summary>
+  /// Gets the counters of a lane's ring (see <see cref="Stats"/>, which is lane 0):
+  /// commands read, idle polls and the number and duration of <c>Process</c> calls per lane.
+  /// </summary>
+  /// <param name="lane">The lane index; 0 is the command ring.</param>
+  public SharedRbStats LaneStats(int lane) => this.LaneRing(lane).Stats;
+
+  private RingBuffer LaneRing(int lane)
+  {
+    ArgumentOutOfRangeException.ThrowIfNegative(lane);
+    ArgumentOutOfRangeException.ThrowIfGreaterThan(lane, this.MLanes.Count);
+    return lane == 0 ? this.MRb : this.MLanes[lane - 1].Ring;
+  }
+
+  private int AddNativeLane(RingBuffer ring, string name, int priority, uint weight)
+  {
+    var name_bytes = System.Text.Encoding.ASCII.GetBytes(name + "\0");
+    fixed (byte* p = name_bytes)
+    {
+      var desc = new SidecarRingBufferDesc { Name = (nint)p, Capacity = ring.Capacity };
+      return SidecarNative.SidecarAddLane(this.MSidecar, &desc, priority, weight);
+    }
+  }
+
+  /// <summary>
+  /// Writes one command record under the backpressure policy; every n-th one
+  /// gets a <see cref="SidecarTraceHeader"/> while tracing is enabled.
+  /// </summary>
+  private bool WriteCommand(ushort type, ReadOnlySpan<byte> payload, SidecarMessageFlags flags) =>
+    this.WriteCommand(this.MRb, type, payload, flags);
+
+  private bool WriteCommand(RingBuffer ring, ushort type, ReadOnlySpan<byte> payload, SidecarMessageFlags flags)
+  {
+    // Lanes may be fed from several threads, so the sample counter is shared atomically
+    var every = this.MTraceEvery;
+    if (every == 0 || Interlocked.Increment(ref this.MTraceCount) % every != 0)
+      return ring.WriteRecord(type, payload, (ushort)flags, this.MWritePolicy, this.MWriteTimeoutMs);
+
+    // Pooled, not a shared field: lanes may be fed from several threads
+    var length = sizeof(SidecarTraceHeader) + payload.Length;
+    var buffer = System.Buffers.ArrayPool<byte>.Shared.Rent(length);
+    try
+    {
+      payload.CopyTo(buffer.AsSpan(sizeof(SidecarTraceHeader)));
+
+      // Stamp last, right before the write
+      var header = new SidecarTraceHeader { WriteNs = SidecarNative.SidecarTraceNow() };
+      MemoryMarshal.Write(buffer, in header);
+
+      return ring.WriteRecord(type, buffer.AsSpan(0, length),
+        (ushort)(flags | SidecarMessageFlags.Traced), this.MWritePolicy, this.MWriteTimeoutMs);
+    }
+    finally
+    {
+      System.Buffers.ArrayPool<byte>.Shared.Return(buffer);
+    }
+  }
+
+  /// <summary>
+  /// Sends an RPC request without waiting for its response.
+  /// </summary>
+  /// <param name="method">Application-defined method id (<see cref="SidecarMessage.Type"/>).</param>
+  /// <param name="request">The request payload.</param>
+  /// <param name="response">
+  /// Completes when <see cref="DrainEvents"/> sees the matching response; poll
+  /// <see cref="Task.IsCompleted"/> or await it while another thread drains.
+  /// </param>
+  /// <returns><c>false</c> if the command ring is too full (nothing was sent, see <see cref="SetBackpressure"/>).</returns>
+  /// <remarks>
+  /// Any number of requests can be in flight; each gets a fresh correlation id and
+  /// exactly one response. Call from one thread at a time (single producer).
+  /// Requires an event ring (<c>eventCapacity</c> &gt; 0).
+  /// </remarks>
+  public bool TrySendRequest(ushort method, ReadOnlySpan<byte> request, out Task<SidecarResponse> response)
+  {
+    if (this.MEvents is null)
+      throw new InvalidOperationException("RPC requires an event ring (eventCapacity > 0).");
+
+    var header = new SidecarRpcHeader
+    {
+      CorrelationId = (ulong)Interlocked.Increment(ref this.MNextCorrelationId)
+    };
+
+    var length = sizeof(SidecarRpcHeader) + request.Length;
+    if (this.MRequestBuffer.Length < length)
+      this.MRequestBuffer = new byte[length];
+
+    MemoryMarshal.Write(this.MRequestBuffer, in header);
+    request.CopyTo(this.MRequestBuffer.AsSpan(sizeof(SidecarRpcHeader)));
+
+    // Register before writing: the response may arrive before WriteRecord returns
+    var completion = new TaskCompletionSource<SidecarResponse>(TaskCreationOptions.RunContinuationsAsynchronously);
+    this.MPending[header.CorrelationId] = completion;
+
+    if (!this.WriteCommand(method, this.MRequestBuffer.AsSpan(0, length), SidecarMessageFlags.Rpc))
+    {
+      this.MPending.TryRemove(header.CorrelationId, out _);
+      response = Task.FromException<SidecarResponse>(new InvalidOperationException("Command ring is full."));
+      return false;
+    }
+
+    response = completion.Task;
+    return true;
+  }
+
+  /// <summary>
+  /// Gets the counters of the command ring: host writes, Sidecar reads, idle
+  /// polls and parks, and the number and duration of <c>Process</c> calls.
+  /// </summary>
+  /// <remarks>
+  /// Read from shared memory, without a call into the Sidecar.
+  /// </remarks>
+  public SharedRbStats Stats => this.MRb.Stats;
+
+  /// <summary>
+  /// Gets the counters of the event ring, or <c>null</c> without one.
+  /// The Sidecar waits for room instead of dropping events, so write sleeps
+  /// there count how often it stalled on an undrained event ring.
+  /// </summary>
+  public SharedRbStats? EventStats => this.MEvents?.Stats;
+
+  /// <summary>
+  /// Gets the number of RPC requests sent whose response has not been drained yet.
+  /// </summary>
+  public int PendingRequests => this.MPending.Count;
+
+  /// <summary>
+  /// Drains all events currently in the event ring on the calling thread.
+  /// </summary>
+  /// <param name="handler">Called once per event, in order; may be null.</param>
+  /// <returns>The number of events drained (0 without an event ring).</returns>
+  /// <remarks>
+  /// The sidecar publishes header and payload of a record together, so once a
+  /// header is readable, the whole payload is readable as well.
+  /// RPC responses complete their request's task instead of reaching the handler.
+  /// </remarks>
+  public int DrainEvents(EventHandler? handler = null)
   {
-    this.MRb.Write(command);
+    if (this.MEvents is null) return 0;
+
+    Span<byte> header = stackalloc byte[8];
+    var count = 0;
+
+    while (this.MEvents.AvailableToRead >= (uint)header.Length)
+    {
+      this.MEvents.Read(header);
+      var event_id = System.Buffers.Binary.BinaryPrimitives.ReadInt32LittleEndian(header);
+      var length = (int)System.Buffers.Binary.BinaryPrimitives.ReadUInt32LittleEndian(header[4..]);
+
+      if (this.MEventBuffer.Length < length)
+        this.MEventBuffer = new byte[length];
+
+      var payload = this.MEventBuffer.AsSpan(0, length);
+      this.MEvents.Read(payload);
+      count++;
+
+      if (event_id == (int)SidecarEventId.RpcResponse && length >= sizeof(SidecarRpcHeader))
+      {
+        var rpc = MemoryMarshal.Read<SidecarRpcHeader>(payload);
+        if (this.MPending.TryRemove(rpc.CorrelationId, out var completion))
+          completion.TrySetResult(new SidecarResponse(rpc.Status, payload[sizeof(SidecarRpcHeader)..].ToArray()));
+        continue;
+      }
+
+      handler?.Invoke(event_id, payload);
+    }
+
+    return count;
   }
 
   /// <summary>
@@ -123,17 +887,30 @@ internal sealed unsafe class SidecarHost : IDisposable
   /// <remarks>
   /// This method:
   /// <list type="bullet">
-  /// <item>Stops the Sidecar worker if it is running</item>
+  /// <item>Stops the Sidecar worker if it is running and destroys the native instance</item>
+  /// <item>Cancels the tasks of RPC requests still waiting for a response</item>
   /// <item>Frees the pinned shared memory name</item>
-  /// <item>Disposes the underlying ring buffer</item>
+  /// <item>Disposes the underlying ring buffers, lanes included, and the arena</item>
   /// </list>
   /// </remarks>
   public void Dispose()
   {
     this.Stop();
+    foreach (var id in this.MPending.Keys)
+      if (this.MPending.TryRemove(id, out var completion))
+        completion.TrySetCanceled();
+    var sidecar = Interlocked.Exchange(ref this.MSidecar, IntPtr.Zero);
+    if (sidecar != IntPtr.Zero)
+      SidecarNative.SidecarDestroy(sidecar);
     if (this.MNameHandle.IsAllocated)
       this.MNameHandle.Free();
+    if (this.MEventsNameHandle.IsAllocated)
+      this.MEventsNameHandle.Free();
     this.MRb.Dispose();
+    this.MEvents?.Dispose();
+    foreach (var lane in this.MLanes)
+      lane.Ring.Dispose();
+    this.MArena?.Dispose();
   }
 
   // ---------------------------------------------------------------------
@@ -170,6 +947,26 @@ internal sealed unsafe class SidecarHost : IDisposable
     Console.WriteLine("[Host] Process: " + BitConverter.ToString(span.ToArray()));
   }
 
+  /// <summary>
+  /// Called by the native Sidecar with all messages drained in one loop iteration.
+  /// </summary>
+  /// <param name="messages">Pointer to the first message.</param>
+  /// <param name="count">Number of messages.</param>
+  [UnmanagedCallersOnly]
+  private static void ProcessBatchImpl(SidecarMessage* messages, int count)
+  {
+    var bytes = 0;
+    for (var i = 0; i < count; i++)
+    {
+      bytes += messages[i].Length;
+
+      // Demo handler: echo every RPC request back as its response
+      if (messages[i].Flags.HasFlag(SidecarMessageFlags.Rpc))
+        SidecarNative.SidecarRespond(messages[i].CorrelationId, 0, messages[i].Data, (uint)messages[i].Length);
+    }
+    Console.WriteLine($"[Host] ProcessBatch: {count} message(s), {bytes} byte(s)");
+  }
+
   /// <summary>
   /// Called by the native Sidecar when an event is emitted.
   /// </summary>
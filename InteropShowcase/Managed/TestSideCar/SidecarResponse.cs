@@ -0,0 +1,9 @@
+﻿
+namespace michele.natale;
+
+/// <summary>
+/// The response to one RPC request sent with <see cref="SidecarHost.TrySendRequest"/>.
+/// </summary>
+/// <param name="Status">Application status set by the Sidecar (0 = success).</param>
+/// <param name="Data">The response payload (a copy owned by the caller).</param>
+internal readonly record struct SidecarResponse(int Status, byte[] Data);
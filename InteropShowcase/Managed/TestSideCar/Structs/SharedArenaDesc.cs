@@ -0,0 +1,32 @@
+﻿
+using System.Runtime.InteropServices;
+
+namespace michele.natale;
+
+/// <summary>
+/// Location of one payload in a shared arena (native <c>shared_arena_desc_t</c>).
+/// </summary>
+/// <remarks>
+/// Only this descriptor travels through the command ring, as the payload of an
+/// <see cref="SidecarMessageFlags.Arena"/> record; the payload itself stays in
+/// the arena. A released descriptor no longer resolves: every release advances
+/// the generation of its blocks.
+/// </remarks>
+[StructLayout(LayoutKind.Sequential)]
+public struct SharedArenaDesc
+{
+  /// <summary>
+  /// Byte offset of the first block from the start of the block area.
+  /// </summary>
+  public ulong Offset;
+
+  /// <summary>
+  /// The number of payload bytes.
+  /// </summary>
+  public uint Length;
+
+  /// <summary>
+  /// Generation of the first block at allocation time.
+  /// </summary>
+  public uint Generation;
+}
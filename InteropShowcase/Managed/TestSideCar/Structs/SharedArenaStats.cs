@@ -0,0 +1,29 @@
+﻿
+using System.Runtime.InteropServices;
+
+namespace michele.natale;
+
+/// <summary>
+/// Counters of one shared arena (native <c>shared_arena_stats_t</c>).
+/// </summary>
+/// <remarks>
+/// The native block lives in the shared memory region; see <see cref="SharedArena.Stats"/>.
+/// </remarks>
+[StructLayout(LayoutKind.Sequential)]
+public struct SharedArenaStats
+{
+  /// <summary>Successful allocations.</summary>
+  public ulong Allocs;
+
+  /// <summary>Allocations that found no free run of blocks.</summary>
+  public ulong AllocFailures;
+
+  /// <summary>Successful releases.</summary>
+  public ulong Releases;
+
+  /// <summary>Descriptors that did not resolve (stale, released twice or out of range).</summary>
+  public ulong Rejected;
+
+  public override readonly string ToString() =>
+    $"allocs {this.Allocs} (failed {this.AllocFailures}), releases {this.Releases}, rejected {this.Rejected}";
+}
@@ -0,0 +1,63 @@
+﻿
+using System.Runtime.InteropServices;
+
+namespace michele.natale;
+
+/// <summary>
+/// Counters of one shared ring (native <c>shared_rb_stats_t</c>).
+/// </summary>
+/// <remarks>
+/// The native block lives in the shared memory region, so a snapshot costs
+/// no call into the Sidecar; see <see cref="RingBuffer.Stats"/>. All counters
+/// only grow: take two snapshots and diff them for rates. The producer and
+/// consumer counters sit on separate cache lines with a single writer each.
+/// </remarks>
+[StructLayout(LayoutKind.Explicit, Size = 128)]
+public struct SharedRbStats
+{
+  /// <summary>Write calls / records that published data.</summary>
+  [FieldOffset(0)] public ulong MessagesWritten;
+
+  /// <summary>Bytes published, record headers included.</summary>
+  [FieldOffset(8)] public ulong BytesWritten;
+
+  /// <summary>Writes truncated because the ring was too full.</summary>
+  [FieldOffset(16)] public ulong PartialWrites;
+
+  /// <summary>Writes that published nothing because the ring was full.</summary>
+  [FieldOffset(24)] public ulong FullRejections;
+
+  /// <summary>Highest occupancy in bytes seen after a write.</summary>
+  [FieldOffset(32)] public ulong HighWater;
+
+  /// <summary>Messages discarded by <see cref="Native.SharedRbWritePolicy.Drop"/>.</summary>
+  [FieldOffset(40)] public ulong Dropped;
+
+  /// <summary>Parks of the producer until the consumer freed space.</summary>
+  [FieldOffset(48)] public ulong WriteSleeps;
+
+  /// <summary>Read, record and consume calls that took data.</summary>
+  [FieldOffset(64)] public ulong MessagesRead;
+
+  /// <summary>Bytes taken, record headers included.</summary>
+  [FieldOffset(72)] public ulong BytesRead;
+
+  /// <summary>Waits that found the ring empty and had to spin, yield or park.</summary>
+  [FieldOffset(80)] public ulong EmptyPolls;
+
+  /// <summary>Parks of the consumer until the producer published.</summary>
+  [FieldOffset(88)] public ulong Sleeps;
+
+  /// <summary><c>Process</c> / <c>ProcessBatch</c> calls of the Sidecar loop.</summary>
+  [FieldOffset(96)] public ulong ProcessCalls;
+
+  /// <summary>Cumulative time spent in those callbacks, in nanoseconds.</summary>
+  [FieldOffset(104)] public ulong ProcessNs;
+
+  public override readonly string ToString() =>
+    $"written {this.MessagesWritten} msg / {this.BytesWritten} B (partial {this.PartialWrites}, " +
+    $"rejected {this.FullRejections}, dropped {this.Dropped}, high water {this.HighWater} B, " +
+    $"write sleeps {this.WriteSleeps}), read {this.MessagesRead} msg / " +
+    $"{this.BytesRead} B, empty polls {this.EmptyPolls}, sleeps {this.Sleeps}, " +
+    $"process {this.ProcessCalls} calls / {this.ProcessNs / 1000} µs";
+}
@@ -0,0 +1,30 @@
+﻿
+using System.Runtime.InteropServices;
+
+namespace michele.natale;
+
+/// <summary>
+/// Describes both shared rings of a duplex channel between the host and the
+/// native Sidecar worker (native <c>sidecar_channel_desc_t</c>).
+/// </summary>
+/// <remarks>
+/// This structure is passed to the native <c>sidecar_start_duplex</c> function.
+/// Both names must remain valid for the entire lifetime of the Sidecar.
+/// </remarks>
+[StructLayout(LayoutKind.Sequential)]
+public struct SidecarChannelDesc
+{
+  /// <summary>
+  /// The command ring: written by the host, read by the Sidecar.
+  /// </summary>
+  public SidecarRingBufferDesc Commands;
+
+  /// <summary>
+  /// The event ring: written by the Sidecar, drained by the host.
+  /// </summary>
+  /// <remarks>
+  /// Each record is an 8-byte header (<c>int eventId</c>, <c>uint length</c>)
+  /// followed by <c>length</c> payload bytes.
+  /// </remarks>
+  public SidecarRingBufferDesc Events;
+}
@@ -46,4 +46,16 @@ public unsafe struct SidecarHostVTable
   /// <param name="data">Pointer to the event payload.</param>
   /// <param name="length">Number of bytes in the payload.</param>
   public delegate* unmanaged<int, byte*, int, void> OnEvent;
+
+  /// <summary>
+  /// Optional pointer to the callback invoked with every message the Sidecar
+  /// drained in one loop iteration.
+  /// </summary>
+  /// <remarks>
+  /// One native→managed transition per batch instead of one per message.
+  /// If null, the Sidecar calls <see cref="Process"/> once per message.
+  /// </remarks>
+  /// <param name="messages">Pointer to the first <see cref="SidecarMessage"/>.</param>
+  /// <param name="count">Number of messages.</param>
+  public delegate* unmanaged<SidecarMessage*, int, void> ProcessBatch;
 }
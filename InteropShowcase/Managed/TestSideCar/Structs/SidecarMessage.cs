@@ -0,0 +1,57 @@
+﻿
+using System.Runtime.InteropServices;
+
+namespace michele.natale;
+
+/// <summary>
+/// Record flags of a command on a framed ring (native <c>sidecar_msg_flags_t</c>).
+/// </summary>
+[Flags]
+public enum SidecarMessageFlags : ushort
+{
+  /// <summary>A plain command; the Sidecar acknowledges it with an "OK" event.</summary>
+  None = 0,
+  /// <summary>An RPC request; the payload starts with a <see cref="SidecarRpcHeader"/>.</summary>
+  Rpc = 1 << 0,
+  /// <summary>A sampled command; the payload starts with a <see cref="SidecarTraceHeader"/>.</summary>
+  Traced = 1 << 1,
+  /// <summary>A large payload; after the prefixes, the payload is a <see cref="SharedArenaDesc"/>.</summary>
+  Arena = 1 << 2,
+}
+
+/// <summary>
+/// One message of a batch handed to <see cref="SidecarHostVTable.ProcessBatch"/>.
+/// </summary>
+/// <remarks>
+/// Mirrors the native <c>sidecar_msg_t</c>. <see cref="Data"/> points into a
+/// native buffer and is only valid during the callback.
+/// </remarks>
+[StructLayout(LayoutKind.Sequential)]
+public unsafe struct SidecarMessage
+{
+  /// <summary>
+  /// Pointer to the message payload.
+  /// </summary>
+  public byte* Data;
+
+  /// <summary>
+  /// Number of bytes in the payload.
+  /// </summary>
+  public int Length;
+
+  /// <summary>
+  /// Record type on a framed command ring, otherwise 0.
+  /// </summary>
+  public ushort Type;
+
+  /// <summary>
+  /// Record flags on a framed command ring, otherwise 0.
+  /// </summary>
+  public SidecarMessageFlags Flags;
+
+  /// <summary>
+  /// Request id if <see cref="Flags"/> has <see cref="SidecarMessageFlags.Rpc"/>, otherwise 0.
+  /// The <see cref="SidecarRpcHeader"/> is already stripped from <see cref="Data"/>.
+  /// </summary>
+  public ulong CorrelationId;
+}
@@ -0,0 +1,54 @@
+﻿
+using System.Runtime.InteropServices;
+
+namespace michele.natale;
+
+/// <summary>
+/// Describes a SidecarWorker process for the native <c>sidecar_process_spawn</c>
+/// (native <c>sidecar_process_desc_t</c>).
+/// </summary>
+/// <remarks>
+/// The native side copies every string, so the pointers only need to stay
+/// valid for the duration of the call.
+/// </remarks>
+[StructLayout(LayoutKind.Sequential)]
+public struct SidecarProcessDesc
+{
+  /// <summary>
+  /// Pointer to the null-terminated UTF-8 path of the SidecarWorker executable.
+  /// </summary>
+  public nint Executable;
+
+  /// <summary>
+  /// The rings created by the host; the worker opens them by name.
+  /// </summary>
+  public SidecarChannelDesc Channel;
+
+  /// <summary>
+  /// Pointer to the null-terminated UTF-8 path of a plugin library, or 0 for
+  /// the built-in echo handler.
+  /// </summary>
+  public nint Plugin;
+
+  /// <summary>
+  /// Pointer to an array of <see cref="ArgCount"/> UTF-8 string pointers with
+  /// further worker arguments (lanes, batch limits, affinity), or 0.
+  /// </summary>
+  public nint Args;
+
+  /// <summary>
+  /// Number of entries in <see cref="Args"/>.
+  /// </summary>
+  public uint ArgCount;
+
+  /// <summary>
+  /// Restarts after unexpected exits before giving up; <see cref="uint.MaxValue"/> restarts forever.
+  /// </summary>
+  public uint MaxRestarts;
+
+  /// <summary>
+  /// Delay before the first restart in milliseconds (0: 100 ms); doubles up to 5 s
+  /// while the worker keeps dying early.
+  /// </summary>
+  public uint RestartDelayMs;
+}
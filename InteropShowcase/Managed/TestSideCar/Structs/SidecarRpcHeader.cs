@@ -0,0 +1,32 @@
+﻿
+using System.Runtime.InteropServices;
+
+namespace michele.natale;
+
+/// <summary>
+/// Prefix of an RPC request payload on the command ring and of an RPC response
+/// payload on the event ring (native <c>sidecar_rpc_hdr_t</c>).
+/// </summary>
+/// <remarks>
+/// The host picks a unique <see cref="CorrelationId"/> per request; the Sidecar
+/// echoes it in the response, so responses can be matched while many requests
+/// are in flight.
+/// </remarks>
+[StructLayout(LayoutKind.Sequential)]
+public struct SidecarRpcHeader
+{
+  /// <summary>
+  /// Request id chosen by the host, echoed in the response.
+  /// </summary>
+  public ulong CorrelationId;
+
+  /// <summary>
+  /// Response status (0 = success); 0 in requests.
+  /// </summary>
+  public int Status;
+
+  /// <summary>
+  /// Reserved, zero.
+  /// </summary>
+  public uint Reserved;
+}
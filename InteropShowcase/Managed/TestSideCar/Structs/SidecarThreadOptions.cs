@@ -0,0 +1,66 @@
+﻿
+using System.Runtime.InteropServices;
+
+namespace michele.natale;
+
+/// <summary>
+/// Scheduling policy of the Sidecar worker thread (native <c>sidecar_sched_policy_t</c>).
+/// </summary>
+public enum SidecarSchedPolicy
+{
+  /// <summary>Platform default: highest thread priority on Windows, inherited on Linux.</summary>
+  Default = 0,
+  /// <summary>Time-sharing; the priority is a nice value (-20..19).</summary>
+  Other = 1,
+  /// <summary>Real-time FIFO; the priority is 1..99 (time-critical on Windows).</summary>
+  Fifo = 2,
+}
+
+/// <summary>
+/// Thread options the worker applied (native <c>sidecar_thread_granted_t</c>).
+/// </summary>
+[Flags]
+public enum SidecarThreadGranted : uint
+{
+  /// <summary>Nothing was applied.</summary>
+  None = 0,
+  /// <summary>The worker is pinned to the affinity mask.</summary>
+  Affinity = 1u << 0,
+  /// <summary>The scheduling policy and priority took effect.</summary>
+  Sched = 1u << 1,
+  /// <summary>The thread carries its name.</summary>
+  Name = 1u << 2,
+}
+
+/// <summary>
+/// Placement and scheduling of the native Sidecar worker thread.
+/// </summary>
+/// <remarks>
+/// Mirrors the native <c>sidecar_thread_options_t</c>. The options are best
+/// effort; <see cref="SidecarThreadGranted"/> reports what took effect.
+/// </remarks>
+[StructLayout(LayoutKind.Sequential)]
+public struct SidecarThreadOptions
+{
+  /// <summary>
+  /// Bit n allows logical CPU n; 0 keeps every CPU.
+  /// </summary>
+  public ulong AffinityMask;
+
+  /// <summary>
+  /// The scheduling policy.
+  /// </summary>
+  public SidecarSchedPolicy Policy;
+
+  /// <summary>
+  /// Nice value (<see cref="SidecarSchedPolicy.Other"/>) or real-time priority
+  /// (<see cref="SidecarSchedPolicy.Fifo"/>).
+  /// </summary>
+  public int Priority;
+
+  /// <summary>
+  /// Pointer to a null-terminated UTF-8 thread name, or 0 for "sidecar".
+  /// The native side copies it.
+  /// </summary>
+  public nint Name;
+}
@@ -0,0 +1,21 @@
+﻿
+using System.Runtime.InteropServices;
+
+namespace michele.natale;
+
+/// <summary>
+/// Prefix of a sampled command on the command ring (native <c>sidecar_trace_hdr_t</c>).
+/// </summary>
+/// <remarks>
+/// Present if the record has <see cref="SidecarMessageFlags.Traced"/>; it comes
+/// before any <see cref="SidecarRpcHeader"/>. The Sidecar strips it before the
+/// callbacks see the message.
+/// </remarks>
+[StructLayout(LayoutKind.Sequential)]
+public struct SidecarTraceHeader
+{
+  /// <summary>
+  /// Trace clock at write, in nanoseconds (native <c>sidecar_trace_now</c>).
+  /// </summary>
+  public ulong WriteNs;
+}
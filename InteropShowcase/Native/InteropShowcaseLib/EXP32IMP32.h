@@ -2,5 +2,9 @@
 
 
 
+#if defined(_WIN32)
 #define EXP32 extern "C" __declspec(dllexport)
-//#define IMP32 extern "C" __declspec(dllimport)
\ No newline at end of file
+//#define IMP32 extern "C" __declspec(dllimport)
+#else
+#define EXP32 extern "C" __attribute__((visibility("default")))
+#endif
\ No newline at end of file
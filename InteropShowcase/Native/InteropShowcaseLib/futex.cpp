@@ -0,0 +1,58 @@
+#include "pch.h"
+#include "futex.h"
+
+#if defined(_WIN32)
+// WaitOnAddress / WakeByAddressAll
+#pragma comment(lib, "Synchronization.lib")
+#else
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//
+// This source file implements the wait/wake primitives on top of the
+// operating system's address‑based wait. The kernel compares the word
+// with the expected value atomically before parking, so a change that
+// happens between the caller's check and the call is never missed.
+//
+
+#if defined(_WIN32)
+
+void futex_wait(std::atomic<uint32_t>* word, uint32_t expected,
+  std::chrono::nanoseconds timeout)
+{
+  // WaitOnAddress has millisecond granularity → round up
+  auto ms = std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+  DWORD wait = (ms >= INFINITE) ? INFINITE - 1 : static_cast<DWORD>(ms);
+
+  WaitOnAddress(word, &expected, sizeof(expected), wait);
+}
+
+void futex_wake_all(std::atomic<uint32_t>* word)
+{
+  WakeByAddressAll(word);
+}
+
+#else
+
+void futex_wait(std::atomic<uint32_t>* word, uint32_t expected,
+  std::chrono::nanoseconds timeout)
+{
+  timespec ts{};
+  ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+  ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT_PRIVATE,
+    expected, &ts, nullptr, 0);
+}
+
+void futex_wake_all(std::atomic<uint32_t>* word)
+{
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE_PRIVATE,
+    INT_MAX, nullptr, nullptr, 0);
+}
+
+#endif
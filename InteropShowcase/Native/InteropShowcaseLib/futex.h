@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(_M_ARM64)
+#include <intrin.h>
+#endif
+
+
+// This header declares the internal wait/wake primitives used by the
+// blocking ring buffer calls. A thread parks on a 32‑bit atomic word until
+// another thread changes it and wakes the word's waiters.
+//   Windows: WaitOnAddress / WakeByAddressAll
+//   Linux:   futex(FUTEX_WAIT_PRIVATE / FUTEX_WAKE_PRIVATE)
+// The helpers are not exported.
+
+
+/// <summary>
+/// Hints the CPU that the caller is spinning (pause / yield instruction).
+/// </summary>
+inline void cpu_relax()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(_M_ARM64)
+  __yield();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+/// <summary>
+/// Parks the calling thread while <c>*word == expected</c>, for at most
+/// <c>timeout</c>. Returns immediately if the word already differs.
+/// Spurious wakeups are possible; callers re‑check their condition.
+/// </summary>
+/// <param name="word">The word to wait on.</param>
+/// <param name="expected">The value observed before parking.</param>
+/// <param name="timeout">Maximum time to park.</param>
+void futex_wait(std::atomic<uint32_t>* word, uint32_t expected,
+  std::chrono::nanoseconds timeout);
+
+/// <summary>
+/// Wakes all threads parked on <c>word</c>.
+/// </summary>
+/// <param name="word">The word to wake.</param>
+void futex_wake_all(std::atomic<uint32_t>* word);
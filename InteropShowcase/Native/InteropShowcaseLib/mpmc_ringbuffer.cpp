@@ -0,0 +1,187 @@
+#include "pch.h"
+#include <new>
+#include <string.h>
+#include "mpmc_ringbuffer.h"
+
+//
+// This source file implements the bounded MPMC ring buffer.
+// Producers and consumers claim positions with a CAS on head/tail; the
+// per‑slot sequence number tells them whether the slot at that position
+// is ready for them, so no side ever blocks on a lock.
+//
+
+/// <summary>
+/// Returns the slot for the given logical position.
+/// </summary>
+static mpmc_slot_t* mpmc_slot_at(mpmc_rb_t* rb, uint64_t pos)
+{
+  return reinterpret_cast<mpmc_slot_t*>(
+    rb->slots + static_cast<size_t>(pos & rb->mask) * rb->stride);
+}
+
+/// <summary>
+/// Allocates and initializes a new MPMC ring buffer.
+/// Every slot starts with sequence == index, i.e. free for the first lap.
+/// </summary>
+/// <param name="slot_count">Minimum number of slots.</param>
+/// <param name="slot_size">Maximum payload size per slot.</param>
+/// <returns>A pointer to the newly created ring buffer, or nullptr.</returns>
+EXP32 mpmc_rb_t* mpmc_rb_create(uint32_t slot_count, uint32_t slot_size)
+{
+  if (slot_count == 0 || slot_count > 0x80000000u || slot_size == 0)
+    return nullptr;
+
+  uint32_t count = 1;
+  while (count < slot_count)
+    count <<= 1;
+
+  // Round each slot up to whole cache lines, so neighbouring slots
+  // written by different producers never share a line.
+  const size_t stride = (sizeof(mpmc_slot_t) + slot_size + RB_CACHE_LINE - 1)
+    & ~(RB_CACHE_LINE - 1);
+  if (stride > UINT32_MAX) return nullptr;
+
+  auto* rb = new mpmc_rb_t;
+
+  rb->slot_count = count;
+  rb->mask = count - 1;
+  rb->slot_size = slot_size;
+  rb->stride = static_cast<uint32_t>(stride);
+  rb->slots = static_cast<uint8_t*>(
+    ::operator new[](stride * count, std::align_val_t{ RB_CACHE_LINE }));
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    auto* slot = new (rb->slots + static_cast<size_t>(i) * stride) mpmc_slot_t;
+    slot->sequence.store(i, std::memory_order_relaxed);
+    slot->length.store(0, std::memory_order_relaxed);
+    slot->reserved = 0;
+  }
+
+  rb->head.store(0, std::memory_order_relaxed);
+  rb->tail.store(0, std::memory_order_relaxed);
+
+  return rb;
+}
+
+/// <summary>
+/// Frees a previously created MPMC ring buffer and its slot storage.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer to destroy.</param>
+EXP32 void mpmc_rb_free(mpmc_rb_t* rb)
+{
+  if (!rb) return;
+  ::operator delete[](rb->slots, std::align_val_t{ RB_CACHE_LINE });
+  delete rb;
+}
+
+/// <summary>
+/// Returns the maximum payload size of a single message.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <returns>Slot payload size in bytes.</returns>
+EXP32 uint32_t mpmc_rb_slot_size(mpmc_rb_t* rb)
+{
+  return rb->slot_size;
+}
+
+/// <summary>
+/// Claims the next free slot with a CAS on head, copies the payload and
+/// publishes the slot by advancing its sequence with a release store.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="data">Message payload.</param>
+/// <param name="length">Payload length in bytes.</param>
+/// <returns>The number of bytes written, or 0 if full, too large or empty.</returns>
+EXP32 uint32_t mpmc_rb_write(mpmc_rb_t* rb, const uint8_t* data, uint32_t length)
+{
+  // Zero-length messages would be indistinguishable from "empty" on read
+  if (length == 0 || length > rb->slot_size) return 0;
+
+  uint64_t pos = rb->head.load(std::memory_order_relaxed);
+  mpmc_slot_t* slot;
+
+  for (;;)
+  {
+    slot = mpmc_slot_at(rb, pos);
+    const uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+    const int64_t diff = static_cast<int64_t>(seq - pos);
+
+    if (diff == 0)
+    {
+      // Slot is free for this lap → try to claim the position
+      if (rb->head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+    {
+      // Slot still holds last lap's message → ring is full
+      return 0;
+    }
+    else
+    {
+      // Another producer claimed this position → retry with the current head
+      pos = rb->head.load(std::memory_order_relaxed);
+    }
+  }
+
+  memcpy(reinterpret_cast<uint8_t*>(slot + 1), data, length);
+  slot->length.store(length, std::memory_order_relaxed);
+  slot->sequence.store(pos + 1, std::memory_order_release);
+  return length;
+}
+
+/// <summary>
+/// Claims the next filled slot with a CAS on tail, copies the payload out
+/// and hands the slot to the producers of the next lap. A message larger
+/// than dest is not claimed, so it is never truncated or lost.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="dest">Destination buffer.</param>
+/// <param name="length">Size of the destination buffer.</param>
+/// <returns>The number of bytes copied, 0 if empty, or the message size if it exceeds length.</returns>
+EXP32 uint32_t mpmc_rb_read(mpmc_rb_t* rb, uint8_t* dest, uint32_t length)
+{
+  uint64_t pos = rb->tail.load(std::memory_order_relaxed);
+  mpmc_slot_t* slot;
+
+  for (;;)
+  {
+    slot = mpmc_slot_at(rb, pos);
+    const uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+    const int64_t diff = static_cast<int64_t>(seq - (pos + 1));
+
+    if (diff == 0)
+    {
+      // Slot is filled for this lap → refuse a message that does not fit.
+      // The length is only valid while the slot still holds this lap's message.
+      const uint32_t needed = slot->length.load(std::memory_order_relaxed);
+      if (needed > length)
+      {
+        if (slot->sequence.load(std::memory_order_acquire) == pos + 1)
+          return needed;
+        pos = rb->tail.load(std::memory_order_relaxed);
+        continue;
+      }
+
+      // Try to claim the position
+      if (rb->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+    {
+      // Producer has not published this position yet → ring is empty
+      return 0;
+    }
+    else
+    {
+      // Another consumer claimed this position → retry with the current tail
+      pos = rb->tail.load(std::memory_order_relaxed);
+    }
+  }
+
+  length = slot->length.load(std::memory_order_relaxed);
+  memcpy(dest, reinterpret_cast<const uint8_t*>(slot + 1), length);
+  slot->sequence.store(pos + rb->slot_count, std::memory_order_release);
+  return length;
+}
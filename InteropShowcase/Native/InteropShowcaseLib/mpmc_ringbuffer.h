@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "EXP32IMP32.h"
+#include "spsc_ringbuffer.h"   // RB_CACHE_LINE
+
+
+// This header defines a bounded multi‑producer/multi‑consumer ring buffer.
+// Unlike ringbuffer_t it is message based: every write occupies one slot of
+// fixed maximum size. Each slot carries its own sequence number, so producers
+// and consumers claim slots with a single CAS on head/tail and never wait for
+// each other unless the ring is actually full or empty.
+
+
+/// <summary>
+/// Header of a single slot. The payload follows directly after the header.
+/// </summary>
+/// <remarks>
+/// The sequence encodes the slot state for the current lap:
+/// sequence == pos       → free, producer for position pos may claim it
+/// sequence == pos + 1   → filled, consumer for position pos may claim it
+/// </remarks>
+struct mpmc_slot_t
+{
+  std::atomic<uint64_t> sequence;  // Slot state (see remarks)
+  std::atomic<uint32_t> length;    // Payload length in bytes (read before a claim)
+  uint32_t reserved;               // Padding, keeps the payload 16‑byte aligned
+};
+
+/// <summary>
+/// Represents a bounded MPMC ring buffer with per‑slot sequence numbers.
+/// </summary>
+struct alignas(RB_CACHE_LINE) mpmc_rb_t
+{
+  alignas(RB_CACHE_LINE) std::atomic<uint64_t> head;  // Next position to claim (producers)
+  alignas(RB_CACHE_LINE) std::atomic<uint64_t> tail;  // Next position to claim (consumers)
+
+  // Read‑only line: never written after creation
+  alignas(RB_CACHE_LINE) uint8_t* slots;              // Slot storage (slot_count * stride)
+  uint32_t slot_count;                                 // Power‑of‑two number of slots
+  uint32_t mask;                                       // slot_count - 1
+  uint32_t slot_size;                                  // Maximum payload bytes per slot
+  uint32_t stride;                                     // Bytes per slot incl. header, cache‑line multiple
+};
+
+/// <summary>
+/// Creates a new MPMC ring buffer.
+/// The slot count is rounded up to the next power of two.
+/// </summary>
+/// <param name="slot_count">Minimum number of messages the buffer can hold.</param>
+/// <param name="slot_size">Maximum payload size of a single message in bytes.</param>
+/// <returns>A pointer to the new ring buffer, or nullptr on invalid arguments.</returns>
+EXP32 mpmc_rb_t* mpmc_rb_create(uint32_t slot_count, uint32_t slot_size);
+
+/// <summary>
+/// Frees a previously created MPMC ring buffer.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer to destroy.</param>
+EXP32 void mpmc_rb_free(mpmc_rb_t* rb);
+
+/// <summary>
+/// Writes one message into the ring buffer. Safe for any number of producers.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="data">Pointer to the message payload.</param>
+/// <param name="length">Payload length in bytes (1 up to slot_size).</param>
+/// <returns>
+/// The number of bytes written, or 0 if the ring is full, the message too large or empty.
+/// Empty messages are rejected, so a read result of 0 always means "ring empty".
+/// </returns>
+EXP32 uint32_t mpmc_rb_write(mpmc_rb_t* rb, const uint8_t* data, uint32_t length);
+
+/// <summary>
+/// Reads one message from the ring buffer. Safe for any number of consumers.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="dest">Destination buffer, should hold at least slot_size bytes.</param>
+/// <param name="length">Size of the destination buffer.</param>
+/// <returns>
+/// The number of bytes copied, or 0 if the ring is empty. A result greater than
+/// length is the size of the next message, which did not fit: nothing was copied
+/// and the message stays in the ring (retry with a larger buffer).
+/// </returns>
+EXP32 uint32_t mpmc_rb_read(mpmc_rb_t* rb, uint8_t* dest, uint32_t length);
+
+/// <summary>
+/// Returns the maximum payload size of a single message.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <returns>Slot payload size in bytes.</returns>
+EXP32 uint32_t mpmc_rb_slot_size(mpmc_rb_t* rb);
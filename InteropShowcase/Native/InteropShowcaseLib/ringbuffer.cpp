@@ -1,7 +1,11 @@
 #include "pch.h"
 #include <stdlib.h>
 #include <string.h>
+#include <chrono>
 #include "ringbuffer.h"
+#include "vmem_mirror.h"
+#include "vmem_alloc.h"
+#include "futex.h"
 
 //
 // This source file implements a lock‑free ring buffer using C11 atomics.
@@ -23,10 +27,110 @@ EXP32 ringbuffer_t* rb_create(uint32_t capacity)
   rb->buffer = new uint8_t[capacity];
   rb->head.store(0, std::memory_order_relaxed);
   rb->tail.store(0, std::memory_order_relaxed);
+  rb->read_waiters.store(0, std::memory_order_relaxed);
+  rb->write_waiters.store(0, std::memory_order_relaxed);
+  rb->wait_spins = 0;
+  rb->dropped.store(0, std::memory_order_relaxed);
+  rb->mirror = nullptr;
+  rb->storage = nullptr;
+  rb->alloc_granted = RB_ALLOC_DEFAULT;
 
   return rb;
 }
 
+/// <summary>
+/// Allocates a ring buffer backed by a mirrored mapping.
+/// The capacity is rounded up to a power of two of at least the mapping
+/// granularity, which also keeps (index % capacity) exact across the
+/// 2^32 wrap of the indices.
+/// </summary>
+/// <param name="capacity">Minimum number of bytes the buffer can hold.</param>
+/// <returns>A pointer to the newly created ring buffer, or nullptr.</returns>
+EXP32 ringbuffer_t* rb_create_mirrored(uint32_t capacity)
+{
+  if (capacity == 0 || capacity > 0x80000000u) return nullptr;
+
+  size_t size = vmem_mirror_granularity();
+  while (size < capacity)
+    size <<= 1;
+
+  auto* mirror = new vmem_mirror_t{};
+  if (!vmem_mirror_alloc(size, mirror))
+  {
+    delete mirror;
+    return nullptr;
+  }
+
+  auto* rb = new ringbuffer_t;
+
+  rb->capacity = static_cast<uint32_t>(size);
+  rb->buffer = mirror->base;
+  rb->head.store(0, std::memory_order_relaxed);
+  rb->tail.store(0, std::memory_order_relaxed);
+  rb->read_waiters.store(0, std::memory_order_relaxed);
+  rb->write_waiters.store(0, std::memory_order_relaxed);
+  rb->wait_spins = 0;
+  rb->dropped.store(0, std::memory_order_relaxed);
+  rb->mirror = mirror;
+  rb->storage = nullptr;
+  rb->alloc_granted = RB_ALLOC_DEFAULT;
+
+  return rb;
+}
+
+// rb_alloc_flags_t is passed to vmem_alloc unchanged
+static_assert(uint32_t{ RB_ALLOC_HUGE_2M } == uint32_t{ VMEM_HUGE_2M }
+  && uint32_t{ RB_ALLOC_HUGE_1G } == uint32_t{ VMEM_HUGE_1G }
+  && uint32_t{ RB_ALLOC_PREFAULT } == uint32_t{ VMEM_PREFAULT }
+  && uint32_t{ RB_ALLOC_NUMA_BIND } == uint32_t{ VMEM_NUMA_BIND },
+  "rb_alloc_flags_t must match vmem_flags_t");
+
+/// <summary>
+/// Allocates a ring buffer whose storage comes from <c>vmem_alloc</c>.
+/// The mapping may be larger than the capacity (rounded to the page size
+/// used); only <c>capacity</c> bytes are used, so the index arithmetic is
+/// the same as for heap storage.
+/// </summary>
+/// <param name="options">Capacity and requested rb_alloc_flags_t.</param>
+/// <returns>A pointer to the newly created ring buffer, or nullptr.</returns>
+EXP32 ringbuffer_t* rb_create_ex(const rb_create_options_t* options)
+{
+  if (!options || options->capacity == 0) return nullptr;
+
+  auto* block = new vmem_block_t{};
+  if (!vmem_alloc(options->capacity, options->flags, options->numa_node, block))
+  {
+    delete block;
+    return nullptr;
+  }
+
+  auto* rb = new ringbuffer_t;
+
+  rb->capacity = options->capacity;
+  rb->buffer = block->base;
+  rb->head.store(0, std::memory_order_relaxed);
+  rb->tail.store(0, std::memory_order_relaxed);
+  rb->read_waiters.store(0, std::memory_order_relaxed);
+  rb->write_waiters.store(0, std::memory_order_relaxed);
+  rb->wait_spins = 0;
+  rb->dropped.store(0, std::memory_order_relaxed);
+  rb->mirror = nullptr;
+  rb->storage = block;
+  rb->alloc_granted = block->granted;
+
+  return rb;
+}
+
+/// <summary>
+/// Returns the storage options actually granted at creation.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <returns>The granted rb_alloc_flags_t.</returns>
+EXP32 uint32_t rb_alloc_granted(ringbuffer_t* rb)
+{
+  return rb->alloc_granted;
+}
+
 /// <summary>
 /// Frees a previously created ring buffer and its internal storage.
 /// </summary>
@@ -34,7 +138,22 @@ EXP32 ringbuffer_t* rb_create(uint32_t capacity)
 EXP32 void rb_free(ringbuffer_t* rb)
 {
   if (!rb) return;
-  delete[] rb->buffer;
+
+  if (rb->mirror)
+  {
+    auto* mirror = static_cast<vmem_mirror_t*>(rb->mirror);
+    vmem_mirror_free(mirror);
+    delete mirror;
+  }
+  else if (rb->storage)
+  {
+    auto* block = static_cast<vmem_block_t*>(rb->storage);
+    vmem_free(block);
+    delete block;
+  }
+  else
+    delete[] rb->buffer;
+
   delete rb;
 }
 
@@ -62,6 +181,81 @@ EXP32 uint32_t rb_available_to_write(ringbuffer_t* rb)
   return rb->capacity - rb_available_to_read(rb);
 }
 
+/// <summary>
+/// Copies <c>length</c> bytes into the buffer starting at the logical index
+/// <c>index</c>. The copy wraps around the end of the buffer in two blocks.
+/// Does not touch head or tail.
+/// </summary>
+static void rb_copy_in(ringbuffer_t* rb, uint32_t index, const uint8_t* data, uint32_t length)
+{
+  uint32_t pos = index % rb->capacity;
+
+  // Mirrored storage → the region is always contiguous
+  if (rb->mirror)
+  {
+    memcpy(rb->buffer + pos, data, length);
+    return;
+  }
+
+  // First contiguous block
+  uint32_t first = rb->capacity - pos;
+  if (first > length) first = length;
+
+  memcpy(rb->buffer + pos, data, first);
+  memcpy(rb->buffer, data + first, length - first);
+}
+
+/// <summary>
+/// Copies <c>length</c> bytes out of the buffer starting at the logical index
+/// <c>index</c>. The copy wraps around the end of the buffer in two blocks.
+/// Does not touch head or tail.
+/// </summary>
+static void rb_copy_out(ringbuffer_t* rb, uint32_t index, uint8_t* dest, uint32_t length)
+{
+  uint32_t pos = index % rb->capacity;
+
+  // Mirrored storage → the region is always contiguous
+  if (rb->mirror)
+  {
+    memcpy(dest, rb->buffer + pos, length);
+    return;
+  }
+
+  // First contiguous block
+  uint32_t first = rb->capacity - pos;
+  if (first > length) first = length;
+
+  memcpy(dest, rb->buffer + pos, first);
+  memcpy(dest + first, rb->buffer, length - first);
+}
+
+/// <summary>
+/// Publishes a new head with a release store and wakes parked readers.
+/// The fence orders the store before the waiter check; it pairs with the
+/// fence in rb_wait_readable, so a reader that is about to park either
+/// sees the new head or is seen by this check.
+/// </summary>
+static void rb_publish_head(ringbuffer_t* rb, uint32_t head)
+{
+  rb->head.store(head, std::memory_order_release);
+
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (rb->read_waiters.load(std::memory_order_relaxed))
+    futex_wake_all(&rb->head);
+}
+
+/// <summary>
+/// Publishes a new tail with a release store and wakes parked writers.
+/// </summary>
+static void rb_publish_tail(ringbuffer_t* rb, uint32_t tail)
+{
+  rb->tail.store(tail, std::memory_order_release);
+
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (rb->write_waiters.load(std::memory_order_relaxed))
+    futex_wake_all(&rb->tail);
+}
+
 /// <summary>
 /// Writes up to <c>length</c> bytes into the ring buffer.
 /// The write may wrap around the end of the buffer.
@@ -77,16 +271,9 @@ EXP32 uint32_t rb_write(ringbuffer_t* rb, const uint8_t* data, uint32_t length)
     length = writable;
 
   uint32_t head = rb->head.load(std::memory_order_relaxed);
-  uint32_t pos = head % rb->capacity;
-
-  // First contiguous block
-  uint32_t first = rb->capacity - pos;
-  if (first > length) first = length;
+  rb_copy_in(rb, head, data, length);
 
-  memcpy(rb->buffer + pos, data, first);
-  memcpy(rb->buffer, data + first, length - first);
-
-  rb->head.store(head + length, std::memory_order_release);
+  rb_publish_head(rb, head + length);
   return length;
 }
 
@@ -105,15 +292,274 @@ EXP32 uint32_t rb_read(ringbuffer_t* rb, uint8_t* dest, uint32_t length)
     length = readable;
 
   uint32_t tail = rb->tail.load(std::memory_order_relaxed);
-  uint32_t pos = tail % rb->capacity;
+  rb_copy_out(rb, tail, dest, length);
 
-  // First contiguous block
-  uint32_t first = rb->capacity - pos;
+  rb_publish_tail(rb, tail + length);
+  return length;
+}
+
+/// <summary>
+/// Fills <c>span</c> with the region of <c>length</c> bytes starting at the
+/// logical index <c>index</c>, split at the end of the buffer if necessary.
+/// </summary>
+static void rb_make_span(ringbuffer_t* rb, uint32_t index, uint32_t length, rb_span_t* span)
+{
+  uint32_t pos = index % rb->capacity;
+
+  // First contiguous block (the whole region for mirrored storage)
+  uint32_t first = rb->mirror ? length : rb->capacity - pos;
   if (first > length) first = length;
 
-  memcpy(dest, rb->buffer + pos, first);
-  memcpy(dest + first, rb->buffer, length - first);
+  span->first = rb->buffer + pos;
+  span->first_length = first;
+  span->second = (length > first) ? rb->buffer : nullptr;
+  span->second_length = length - first;
+}
 
-  rb->tail.store(tail + length, std::memory_order_release);
+/// <summary>
+/// Reserves up to <c>length</c> bytes of free space for in‑place writing.
+/// The head index is left untouched until <c>rb_commit</c>.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="length">Requested number of bytes.</param>
+/// <param name="span">Receives the reserved region.</param>
+/// <returns>The number of bytes actually reserved.</returns>
+EXP32 uint32_t rb_reserve(ringbuffer_t* rb, uint32_t length, rb_span_t* span)
+{
+  uint32_t writable = rb_available_to_write(rb);
+  if (length > writable)
+    length = writable;
+
+  uint32_t head = rb->head.load(std::memory_order_relaxed);
+  rb_make_span(rb, head, length, span);
   return length;
 }
+
+/// <summary>
+/// Publishes bytes written into a reserved span by advancing the head
+/// with a release store, so the consumer sees the completed data.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="length">Number of bytes to publish.</param>
+EXP32 void rb_commit(ringbuffer_t* rb, uint32_t length)
+{
+  uint32_t head = rb->head.load(std::memory_order_relaxed);
+  rb_publish_head(rb, head + length);
+}
+
+/// <summary>
+/// Exposes up to <c>length</c> readable bytes in place.
+/// The tail index is left untouched until <c>rb_consume</c>.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="length">Maximum number of bytes to expose.</param>
+/// <param name="span">Receives the readable region.</param>
+/// <returns>The number of bytes exposed.</returns>
+EXP32 uint32_t rb_peek(ringbuffer_t* rb, uint32_t length, rb_span_t* span)
+{
+  uint32_t readable = rb_available_to_read(rb);
+  if (length > readable)
+    length = readable;
+
+  uint32_t tail = rb->tail.load(std::memory_order_relaxed);
+  rb_make_span(rb, tail, length, span);
+  return length;
+}
+
+/// <summary>
+/// Releases peeked bytes by advancing the tail with a release store,
+/// handing the space back to the producer.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="length">Number of bytes to release.</param>
+EXP32 void rb_consume(ringbuffer_t* rb, uint32_t length)
+{
+  uint32_t tail = rb->tail.load(std::memory_order_relaxed);
+  rb_publish_tail(rb, tail + length);
+}
+
+/// <summary>
+/// Writes several source segments into the ring buffer in order.
+/// Each segment is copied with the usual two‑block wrap logic, but the
+/// head is published only once, after the last segment.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="segments">Array of source segments.</param>
+/// <param name="count">Number of segments in the array.</param>
+/// <returns>The total number of bytes actually written.</returns>
+EXP32 uint32_t rb_writev(ringbuffer_t* rb, const rb_segment_t* segments, uint32_t count)
+{
+  uint32_t writable = rb_available_to_write(rb);
+  uint32_t head = rb->head.load(std::memory_order_relaxed);
+  uint32_t written = 0;
+
+  for (uint32_t i = 0; i < count && written < writable; i++)
+  {
+    uint32_t length = segments[i].length;
+    if (length > writable - written)
+      length = writable - written;
+
+    rb_copy_in(rb, head + written, segments[i].data, length);
+    written += length;
+  }
+
+  rb_publish_head(rb, head + written);
+  return written;
+}
+
+/// <summary>
+/// Reads from the ring buffer into several destination segments in order.
+/// The tail is published only once, after the last segment.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="segments">Array of destination segments.</param>
+/// <param name="count">Number of segments in the array.</param>
+/// <returns>The total number of bytes actually read.</returns>
+EXP32 uint32_t rb_readv(ringbuffer_t* rb, const rb_segment_t* segments, uint32_t count)
+{
+  uint32_t readable = rb_available_to_read(rb);
+  uint32_t tail = rb->tail.load(std::memory_order_relaxed);
+  uint32_t read = 0;
+
+  for (uint32_t i = 0; i < count && read < readable; i++)
+  {
+    uint32_t length = segments[i].length;
+    if (length > readable - read)
+      length = readable - read;
+
+    rb_copy_out(rb, tail + read, segments[i].data, length);
+    read += length;
+  }
+
+  rb_publish_tail(rb, tail + read);
+  return read;
+}
+
+/// <summary>
+/// Sets the number of spin iterations the wait calls perform before parking.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="spins">Spin iterations (0 = park immediately).</param>
+EXP32 void rb_set_wait_spins(ringbuffer_t* rb, uint32_t spins)
+{
+  rb->wait_spins = spins;
+}
+
+/// <summary>
+/// Waits until <c>available()</c> reaches <c>min_bytes</c>.
+/// Phase 1 spins up to wait_spins iterations with a pause instruction.
+/// Phase 2 registers as a waiter and parks on <c>word</c> until the
+/// opposite side publishes a new index or the timeout expires.
+/// </summary>
+template <typename TAvailable>
+static uint32_t rb_wait(ringbuffer_t* rb, std::atomic<uint32_t>* word,
+  std::atomic<uint32_t>* waiters, TAvailable available,
+  uint32_t min_bytes, int32_t timeout_ms)
+{
+  if (min_bytes == 0) min_bytes = 1;
+  if (min_bytes > rb->capacity) return 0;
+
+  // Phase 1: bounded spin
+  uint32_t avail = available();
+  for (uint32_t i = 0; i < rb->wait_spins && avail < min_bytes; i++)
+  {
+    cpu_relax();
+    avail = available();
+  }
+  if (avail >= min_bytes) return avail;
+  if (timeout_ms == 0) return 0;
+
+  // Phase 2: park
+  const auto deadline = std::chrono::steady_clock::now() +
+    std::chrono::milliseconds(timeout_ms < 0 ? INT32_MAX : timeout_ms);
+
+  waiters->fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  for (;;)
+  {
+    const uint32_t observed = word->load(std::memory_order_acquire);
+
+    avail = available();
+    if (avail >= min_bytes) break;
+
+    const auto remaining = deadline - std::chrono::steady_clock::now();
+    if (remaining <= std::chrono::nanoseconds::zero())
+    {
+      avail = 0;
+      break;
+    }
+
+    futex_wait(word, observed, remaining);
+  }
+
+  waiters->fetch_sub(1, std::memory_order_relaxed);
+  return avail;
+}
+
+/// <summary>
+/// Blocks the consumer until at least <c>min_bytes</c> are readable.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="min_bytes">Number of bytes to wait for.</param>
+/// <param name="timeout_ms">Timeout in milliseconds; negative waits forever.</param>
+/// <returns>The readable byte count, or 0 on timeout.</returns>
+EXP32 uint32_t rb_wait_readable(ringbuffer_t* rb, uint32_t min_bytes, int32_t timeout_ms)
+{
+  return rb_wait(rb, &rb->head, &rb->read_waiters,
+    [rb] { return rb_available_to_read(rb); }, min_bytes, timeout_ms);
+}
+
+/// <summary>
+/// Blocks the producer until at least <c>min_bytes</c> are writable.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="min_bytes">Number of bytes to wait for.</param>
+/// <param name="timeout_ms">Timeout in milliseconds; negative waits forever.</param>
+/// <returns>The writable byte count, or 0 on timeout.</returns>
+EXP32 uint32_t rb_wait_writable(ringbuffer_t* rb, uint32_t min_bytes, int32_t timeout_ms)
+{
+  return rb_wait(rb, &rb->tail, &rb->write_waiters,
+    [rb] { return rb_available_to_write(rb); }, min_bytes, timeout_ms);
+}
+
+/// <summary>
+/// Writes a message according to the given rb_write_policy_t.
+/// Only the producer calls this, so free space can only grow between the
+/// check and rb_write: once the message fits it is written in full.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="data">Source data to write.</param>
+/// <param name="length">Number of bytes to write.</param>
+/// <param name="policy">rb_write_policy_t.</param>
+/// <param name="timeout_ms">Timeout for RB_WRITE_BLOCK; negative waits forever.</param>
+/// <returns>The number of bytes written.</returns>
+EXP32 uint32_t rb_write_ex(ringbuffer_t* rb, const uint8_t* data, uint32_t length,
+  uint32_t policy, int32_t timeout_ms)
+{
+  if (policy == RB_WRITE_PARTIAL)
+    return rb_write(rb, data, length);
+
+  uint32_t writable = rb_available_to_write(rb);
+  if (length > writable && policy == RB_WRITE_BLOCK && length <= rb->capacity)
+    writable = rb_wait_writable(rb, length, timeout_ms);
+
+  if (length > writable)
+  {
+    if (policy == RB_WRITE_DROP)
+      rb->dropped.fetch_add(1, std::memory_order_relaxed);
+    return 0;
+  }
+
+  return rb_write(rb, data, length);
+}
+
+/// <summary>
+/// Returns the number of messages discarded by RB_WRITE_DROP.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <returns>The dropped message count.</returns>
+EXP32 uint64_t rb_dropped(ringbuffer_t* rb)
+{
+  return rb->dropped.load(std::memory_order_relaxed);
+}
@@ -15,13 +15,84 @@
 /// Represents a lock‑free ring buffer.
 /// The buffer uses atomic head/tail indices to allow concurrent
 /// producer and consumer operations without locks.
+/// For sustained high‑throughput SPSC traffic prefer spsc_rb_t
+/// (spsc_ringbuffer.h): head and tail share one cache line here, and
+/// (head % capacity) is only exact across the 2^32 wrap for
+/// power‑of‑two capacities.
 /// </summary>
 struct ringbuffer_t
 {
   uint8_t* buffer;                 // Raw byte storage
   uint32_t capacity;               // Total size of the buffer
-  std::atomic<uint32_t> head;      // Read position (consumer)
-  std::atomic<uint32_t> tail;      // Write position (producer)
+  std::atomic<uint32_t> head;      // Write position (producer)
+  std::atomic<uint32_t> tail;      // Read position (consumer)
+  std::atomic<uint32_t> read_waiters;  // Consumers parked in rb_wait_readable
+  std::atomic<uint32_t> write_waiters; // Producers parked in rb_wait_writable
+  uint32_t wait_spins;             // Spin iterations before parking (rb_set_wait_spins)
+  std::atomic<uint64_t> dropped;   // Messages discarded by RB_WRITE_DROP (rb_dropped)
+  void* mirror;                    // Mirrored mapping (see rb_create_mirrored), nullptr for heap storage
+  void* storage;                   // Page allocation (see rb_create_ex), nullptr for heap storage
+  uint32_t alloc_granted;          // rb_alloc_flags_t actually granted by rb_create_ex
+};
+
+/// <summary>
+/// Storage options for <c>rb_create_ex</c>. Every option is a request:
+/// if the OS refuses it the allocation falls back (1 GB → 2 MB → regular
+/// pages) and <c>rb_alloc_granted</c> reports what was actually applied.
+/// </summary>
+enum rb_alloc_flags_t : uint32_t
+{
+  RB_ALLOC_DEFAULT = 0,
+  RB_ALLOC_HUGE_2M = 1u << 0,      // Back the storage with 2 MB pages
+  RB_ALLOC_HUGE_1G = 1u << 1,      // Back the storage with 1 GB pages (Linux only)
+  RB_ALLOC_PREFAULT = 1u << 2,     // Commit and touch every page at creation
+  RB_ALLOC_NUMA_BIND = 1u << 3,    // Bind the pages to rb_create_options_t::numa_node (Linux only; Windows just prefers the node)
+};
+
+/// <summary>
+/// What <c>rb_write_ex</c> does when a message does not fit into the free
+/// space. Apart from RB_WRITE_PARTIAL every policy writes either the whole
+/// message or nothing, so a reader never sees a truncated message.
+/// </summary>
+enum rb_write_policy_t : uint32_t
+{
+  RB_WRITE_PARTIAL = 0,            // Write as much as fits (same as rb_write)
+  RB_WRITE_ALL_OR_NOTHING = 1,     // Write the whole message or nothing, never wait
+  RB_WRITE_BLOCK = 2,              // Park until the consumer frees enough space or the timeout expires
+  RB_WRITE_DROP = 3,               // Discard the message and count it (rb_dropped)
+};
+
+/// <summary>
+/// Creation parameters for <c>rb_create_ex</c>.
+/// </summary>
+struct rb_create_options_t
+{
+  uint32_t capacity;               // Number of bytes the buffer can hold
+  uint32_t flags;                  // Requested rb_alloc_flags_t
+  int32_t numa_node;               // Target node for RB_ALLOC_NUMA_BIND (e.g. the consumer thread's node)
+};
+
+/// <summary>
+/// Describes a region inside <c>ringbuffer_t::buffer</c> handed out by
+/// <c>rb_reserve</c> or <c>rb_peek</c>. Because the region may wrap around
+/// the end of the buffer, it consists of up to two contiguous parts.
+/// </summary>
+struct rb_span_t
+{
+  uint8_t* first;                  // First contiguous part (starts at the current index)
+  uint32_t first_length;           // Number of bytes in the first part
+  uint8_t* second;                 // Wrapped part at the buffer start, or nullptr
+  uint32_t second_length;          // Number of bytes in the second part
+};
+
+/// <summary>
+/// Describes one (pointer, length) segment for the vectored calls
+/// <c>rb_writev</c> (source) and <c>rb_readv</c> (destination).
+/// </summary>
+struct rb_segment_t
+{
+  uint8_t* data;                   // Segment start
+  uint32_t length;                 // Number of bytes in the segment
 };
 
 /// <summary>
@@ -31,6 +102,36 @@ struct ringbuffer_t
 /// <returns>A pointer to the newly allocated ring buffer.</returns>
 EXP32 ringbuffer_t* rb_create(uint32_t capacity);
 
+/// <summary>
+/// Creates a new ring buffer whose storage is mapped twice, back to back,
+/// in virtual memory. Any region of up to <c>capacity</c> bytes is then
+/// contiguous, so writes and reads never split at the wrap point and
+/// <c>rb_peek</c>/<c>rb_reserve</c> always return a single part.
+/// </summary>
+/// <param name="capacity">Minimum number of bytes; rounded up to a power of two
+/// of at least the page (Linux) or allocation (Windows) granularity.</param>
+/// <returns>A pointer to the new ring buffer, or nullptr if the mapping failed.</returns>
+EXP32 ringbuffer_t* rb_create_mirrored(uint32_t capacity);
+
+/// <summary>
+/// Creates a new ring buffer whose storage is mapped directly from the OS
+/// with the requested page size, pre‑faulting and NUMA placement. Huge
+/// pages cut TLB misses on large rings; pre‑faulting moves the page faults
+/// out of the first writes; NUMA binding keeps the storage local to the
+/// node that touches it most.
+/// </summary>
+/// <param name="options">Capacity and requested rb_alloc_flags_t.</param>
+/// <returns>A pointer to the new ring buffer, or nullptr if no memory could be mapped.</returns>
+EXP32 ringbuffer_t* rb_create_ex(const rb_create_options_t* options);
+
+/// <summary>
+/// Returns the rb_alloc_flags_t actually granted for the ring buffer's
+/// storage. Always RB_ALLOC_DEFAULT for rings not created by <c>rb_create_ex</c>.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <returns>The granted flags.</returns>
+EXP32 uint32_t rb_alloc_granted(ringbuffer_t* rb);
+
 /// <summary>
 /// Frees a previously created ring buffer.
 /// </summary>
@@ -68,3 +169,113 @@ EXP32 uint32_t rb_available_to_read(ringbuffer_t* rb);
 /// <param name="rb">Pointer to the ring buffer.</param>
 /// <returns>Writable byte count.</returns>
 EXP32 uint32_t rb_available_to_write(ringbuffer_t* rb);
+
+/// <summary>
+/// Reserves up to <c>length</c> bytes of free space for in‑place writing.
+/// The producer fills the returned span directly and publishes it with
+/// <c>rb_commit</c>. Nothing becomes visible to the consumer before that.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="length">Requested number of bytes.</param>
+/// <param name="span">Receives the reserved region (one or two parts).</param>
+/// <returns>The number of bytes actually reserved.</returns>
+EXP32 uint32_t rb_reserve(ringbuffer_t* rb, uint32_t length, rb_span_t* span);
+
+/// <summary>
+/// Publishes <c>length</c> bytes previously obtained with <c>rb_reserve</c>.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="length">Number of bytes to publish (at most the reserved count).</param>
+EXP32 void rb_commit(ringbuffer_t* rb, uint32_t length);
+
+/// <summary>
+/// Exposes up to <c>length</c> readable bytes for in‑place parsing without
+/// consuming them. The data stays valid until <c>rb_consume</c> is called.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="length">Maximum number of bytes to expose.</param>
+/// <param name="span">Receives the readable region (one or two parts).</param>
+/// <returns>The number of bytes exposed.</returns>
+EXP32 uint32_t rb_peek(ringbuffer_t* rb, uint32_t length, rb_span_t* span);
+
+/// <summary>
+/// Releases <c>length</c> bytes previously obtained with <c>rb_peek</c>,
+/// making the space available to the producer again.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="length">Number of bytes to release (at most the peeked count).</param>
+EXP32 void rb_consume(ringbuffer_t* rb, uint32_t length);
+
+/// <summary>
+/// Writes a batch of segments into the ring buffer with a single publish.
+/// Segments are copied in order until the buffer is full, so one call
+/// (and one managed→native transition) can move many small messages.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="segments">Array of source segments.</param>
+/// <param name="count">Number of segments in the array.</param>
+/// <returns>The total number of bytes actually written.</returns>
+EXP32 uint32_t rb_writev(ringbuffer_t* rb, const rb_segment_t* segments, uint32_t count);
+
+/// <summary>
+/// Reads from the ring buffer into a batch of destination segments with a
+/// single publish. Segments are filled in order until no data is left.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="segments">Array of destination segments.</param>
+/// <param name="count">Number of segments in the array.</param>
+/// <returns>The total number of bytes actually read.</returns>
+EXP32 uint32_t rb_readv(ringbuffer_t* rb, const rb_segment_t* segments, uint32_t count);
+
+/// <summary>
+/// Blocks until at least <c>min_bytes</c> can be read.
+/// The caller first spins (see <c>rb_set_wait_spins</c>), then parks on the
+/// head index. Producers only issue a wake‑up when a reader is parked.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="min_bytes">Number of bytes to wait for (at most the capacity).</param>
+/// <param name="timeout_ms">Timeout in milliseconds; 0 polls, negative waits forever.</param>
+/// <returns>The readable byte count, or 0 on timeout.</returns>
+EXP32 uint32_t rb_wait_readable(ringbuffer_t* rb, uint32_t min_bytes, int32_t timeout_ms);
+
+/// <summary>
+/// Blocks until at least <c>min_bytes</c> can be written.
+/// The caller first spins (see <c>rb_set_wait_spins</c>), then parks on the
+/// tail index. Consumers only issue a wake‑up when a writer is parked.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="min_bytes">Number of bytes to wait for (at most the capacity).</param>
+/// <param name="timeout_ms">Timeout in milliseconds; 0 polls, negative waits forever.</param>
+/// <returns>The writable byte count, or 0 on timeout.</returns>
+EXP32 uint32_t rb_wait_writable(ringbuffer_t* rb, uint32_t min_bytes, int32_t timeout_ms);
+
+/// <summary>
+/// Sets the number of busy‑spin iterations (with a pause instruction) the
+/// wait calls perform before parking. The default is 0.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="spins">Spin iterations.</param>
+EXP32 void rb_set_wait_spins(ringbuffer_t* rb, uint32_t spins);
+
+/// <summary>
+/// Writes <c>length</c> bytes according to a rb_write_policy_t.
+/// RB_WRITE_BLOCK parks on the tail index like <c>rb_wait_writable</c>,
+/// so the producer sleeps until the consumer's read wakes it instead of
+/// polling. A message larger than the capacity can never fit and fails
+/// at once under every policy except RB_WRITE_PARTIAL.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="data">Source data to write.</param>
+/// <param name="length">Number of bytes to write.</param>
+/// <param name="policy">rb_write_policy_t applied when the message does not fit.</param>
+/// <param name="timeout_ms">Timeout for RB_WRITE_BLOCK in milliseconds; negative waits forever.</param>
+/// <returns>The number of bytes written: <c>length</c> or 0 (any count for RB_WRITE_PARTIAL).</returns>
+EXP32 uint32_t rb_write_ex(ringbuffer_t* rb, const uint8_t* data, uint32_t length,
+  uint32_t policy, int32_t timeout_ms);
+
+/// <summary>
+/// Returns the number of messages discarded by RB_WRITE_DROP.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <returns>The dropped message count.</returns>
+EXP32 uint64_t rb_dropped(ringbuffer_t* rb);
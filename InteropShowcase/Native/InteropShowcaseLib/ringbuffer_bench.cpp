@@ -0,0 +1,158 @@
+#include "pch.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "ringbuffer.h"
+#include "spsc_ringbuffer.h"
+#include "mpmc_ringbuffer.h"
+#include "ringbuffer_bench.h"
+
+//
+// This source file implements the ring buffer throughput benchmarks.
+// Each run moves the same byte stream through the selected implementation,
+// retrying partial writes/reads exactly like a real producer/consumer would.
+//
+
+/// <summary>
+/// Runs one producer and one consumer thread against the given ring buffer
+/// operations and returns the throughput in MB/s.
+/// </summary>
+template <typename TRing, typename TWrite, typename TRead>
+static double run_spsc(TRing* rb, TWrite write, TRead read,
+  uint32_t message_size, uint64_t total_bytes)
+{
+  std::vector<uint8_t> src(message_size, 0xA5);
+  std::vector<uint8_t> dst(message_size);
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::thread producer([&]
+    {
+      for (uint64_t sent = 0; sent < total_bytes; sent += message_size)
+      {
+        uint32_t done = 0;
+        while (done < message_size)
+        {
+          uint32_t n = write(rb, src.data() + done, message_size - done);
+          if (n == 0) std::this_thread::yield(); // Full → let the consumer run
+          done += n;
+        }
+      }
+    });
+
+  uint64_t received = 0;
+  while (received < total_bytes)
+  {
+    uint32_t n = read(rb, dst.data(), message_size);
+    if (n == 0) std::this_thread::yield(); // Empty → let the producer run
+    received += n;
+  }
+
+  producer.join();
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(total_bytes) / elapsed.count() / 1e6;
+}
+
+/// <summary>
+/// Measures producer → consumer throughput for the selected ring buffer.
+/// </summary>
+/// <param name="kind">Ring buffer implementation (see rb_bench_kind_t).</param>
+/// <param name="capacity">Ring buffer capacity in bytes.</param>
+/// <param name="message_size">Bytes per write/read call.</param>
+/// <param name="total_bytes">Total number of bytes to transfer.</param>
+/// <returns>Throughput in MB/s, or -1 on invalid arguments.</returns>
+EXP32 double rb_bench_throughput(int32_t kind, uint32_t capacity,
+  uint32_t message_size, uint64_t total_bytes)
+{
+  if (capacity == 0 || message_size == 0 || message_size > capacity)
+    return -1.0;
+
+  // Whole messages only, so both sides agree on the end of the stream
+  total_bytes -= total_bytes % message_size;
+
+  switch (kind)
+  {
+  case RB_BENCH_CLASSIC:
+  {
+    ringbuffer_t* rb = rb_create(capacity);
+    double mbps = run_spsc(rb, rb_write, rb_read, message_size, total_bytes);
+    rb_free(rb);
+    return mbps;
+  }
+  case RB_BENCH_SPSC:
+  {
+    spsc_rb_t* rb = spsc_rb_create(capacity);
+    if (!rb) return -1.0;
+    double mbps = run_spsc(rb, spsc_rb_write, spsc_rb_read, message_size, total_bytes);
+    spsc_rb_free(rb);
+    return mbps;
+  }
+  default:
+    return -1.0;
+  }
+}
+
+/// <summary>
+/// Measures MPMC throughput with the given number of producer and
+/// consumer threads. Consumers stop once every message has been read.
+/// </summary>
+/// <param name="producers">Number of producer threads.</param>
+/// <param name="consumers">Number of consumer threads.</param>
+/// <param name="message_size">Payload bytes per message.</param>
+/// <param name="messages_per_producer">Messages written by each producer.</param>
+/// <returns>Throughput in million messages per second, or -1 on invalid arguments.</returns>
+EXP32 double rb_bench_mpmc(uint32_t producers, uint32_t consumers,
+  uint32_t message_size, uint64_t messages_per_producer)
+{
+  if (producers == 0 || consumers == 0 || message_size == 0)
+    return -1.0;
+
+  mpmc_rb_t* rb = mpmc_rb_create(1024, message_size);
+  if (!rb) return -1.0;
+
+  const uint64_t total = messages_per_producer * producers;
+  std::atomic<uint64_t> received{ 0 };
+
+  std::vector<std::thread> threads;
+  threads.reserve(producers + consumers);
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (uint32_t p = 0; p < producers; p++)
+  {
+    threads.emplace_back([&]
+      {
+        std::vector<uint8_t> src(message_size, 0xA5);
+        for (uint64_t i = 0; i < messages_per_producer; i++)
+        {
+          while (mpmc_rb_write(rb, src.data(), message_size) == 0)
+            std::this_thread::yield(); // Full → let the consumers run
+        }
+      });
+  }
+
+  for (uint32_t c = 0; c < consumers; c++)
+  {
+    threads.emplace_back([&]
+      {
+        std::vector<uint8_t> dst(message_size);
+        while (received.load(std::memory_order_relaxed) < total)
+        {
+          if (mpmc_rb_read(rb, dst.data(), message_size) > 0)
+            received.fetch_add(1, std::memory_order_relaxed);
+          else
+            std::this_thread::yield(); // Empty → let the producers run
+        }
+      });
+  }
+
+  for (auto& t : threads)
+    t.join();
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  mpmc_rb_free(rb);
+
+  return static_cast<double>(total) / elapsed.count() / 1e6;
+}
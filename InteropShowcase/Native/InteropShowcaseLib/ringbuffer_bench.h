@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+#include "EXP32IMP32.h"
+
+
+// This header exposes native throughput benchmarks for the ring buffer
+// variants. The producer and consumer run on two native threads, so the
+// numbers reflect the ring buffer itself and not the P/Invoke transition.
+
+
+/// <summary>
+/// Selects the ring buffer implementation measured by <c>rb_bench_throughput</c>.
+/// </summary>
+enum rb_bench_kind_t : int32_t
+{
+  RB_BENCH_CLASSIC = 0,   // ringbuffer_t (rb_write / rb_read)
+  RB_BENCH_SPSC = 1,      // spsc_rb_t (spsc_rb_write / spsc_rb_read)
+};
+
+/// <summary>
+/// Streams <c>total_bytes</c> from a producer thread to a consumer thread
+/// in messages of <c>message_size</c> bytes and measures the throughput.
+/// </summary>
+/// <param name="kind">Ring buffer implementation (see rb_bench_kind_t).</param>
+/// <param name="capacity">Ring buffer capacity in bytes.</param>
+/// <param name="message_size">Bytes per write/read call.</param>
+/// <param name="total_bytes">Total number of bytes to transfer.</param>
+/// <returns>Throughput in MB/s, or a negative value on invalid arguments.</returns>
+EXP32 double rb_bench_throughput(int32_t kind, uint32_t capacity,
+  uint32_t message_size, uint64_t total_bytes);
+
+/// <summary>
+/// Runs <c>producers</c> producer threads and <c>consumers</c> consumer
+/// threads against one MPMC ring buffer. Every producer writes
+/// <c>messages_per_producer</c> messages of <c>message_size</c> bytes.
+/// Calling it with 1..N producers shows how the ring scales.
+/// </summary>
+/// <param name="producers">Number of producer threads (at least 1).</param>
+/// <param name="consumers">Number of consumer threads (at least 1).</param>
+/// <param name="message_size">Payload bytes per message.</param>
+/// <param name="messages_per_producer">Messages written by each producer.</param>
+/// <returns>Throughput in million messages per second, or a negative value on invalid arguments.</returns>
+EXP32 double rb_bench_mpmc(uint32_t producers, uint32_t consumers,
+  uint32_t message_size, uint64_t messages_per_producer);
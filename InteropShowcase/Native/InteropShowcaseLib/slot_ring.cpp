@@ -0,0 +1,50 @@
+#include "pch.h"
+#include <new>
+#include "slot_ring.h"
+
+//
+// This source file instantiates slot_ring_t for the exported element
+// sizes. The rings are over‑aligned (cache line), so they are created
+// with the aligned form of operator new.
+//
+
+/// <summary>
+/// Defines the exports declared by SLOT_RING_DECLARE_EXPORTS for one size.
+/// </summary>
+#define SLOT_RING_DEFINE_EXPORTS(SIZE)                                                         \
+  EXP32 slot_ring##SIZE##_t* slot_ring##SIZE##_create()                                        \
+  {                                                                                            \
+    return new slot_ring##SIZE##_t;                                                            \
+  }                                                                                            \
+                                                                                               \
+  EXP32 void slot_ring##SIZE##_free(slot_ring##SIZE##_t* ring)                                 \
+  {                                                                                            \
+    delete ring;                                                                               \
+  }                                                                                            \
+                                                                                               \
+  EXP32 uint32_t slot_ring##SIZE##_push_n(slot_ring##SIZE##_t* ring, const void* items, uint32_t count) \
+  {                                                                                            \
+    return static_cast<uint32_t>(ring->push_n(                                                 \
+      static_cast<const slot_blob_t<SIZE>*>(items), count));                                   \
+  }                                                                                            \
+                                                                                               \
+  EXP32 uint32_t slot_ring##SIZE##_pop_n(slot_ring##SIZE##_t* ring, void* items, uint32_t count) \
+  {                                                                                            \
+    return static_cast<uint32_t>(ring->pop_n(                                                  \
+      static_cast<slot_blob_t<SIZE>*>(items), count));                                         \
+  }                                                                                            \
+                                                                                               \
+  EXP32 uint32_t slot_ring##SIZE##_size(slot_ring##SIZE##_t* ring)                             \
+  {                                                                                            \
+    return static_cast<uint32_t>(ring->size());                                                \
+  }                                                                                            \
+                                                                                               \
+  EXP32 uint32_t slot_ring##SIZE##_capacity(slot_ring##SIZE##_t*)                              \
+  {                                                                                            \
+    return static_cast<uint32_t>(slot_ring##SIZE##_t::capacity);                               \
+  }
+
+SLOT_RING_DEFINE_EXPORTS(8)
+SLOT_RING_DEFINE_EXPORTS(16)
+SLOT_RING_DEFINE_EXPORTS(32)
+SLOT_RING_DEFINE_EXPORTS(64)
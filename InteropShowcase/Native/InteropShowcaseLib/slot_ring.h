@@ -0,0 +1,172 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "EXP32IMP32.h"
+#include "spsc_ringbuffer.h"
+
+
+// This header defines a typed single‑producer/single‑consumer ring of
+// fixed‑size slots. Capacity and element type are compile‑time
+// parameters, so the hot loop moves whole elements: there are no partial
+// messages, no byte counters and no modulo by a runtime capacity. The
+// index layout follows spsc_rb_t (cache‑line‑isolated, cached copies).
+
+
+/// <summary>
+/// Represents a typed SPSC ring of <c>N</c> slots of <c>T</c>.
+/// <c>T</c> must be trivially copyable (blittable), <c>N</c> a power of two.
+/// Header‑only; instantiate it directly from C++ code.
+/// </summary>
+template<typename T, size_t N>
+struct alignas(RB_CACHE_LINE) slot_ring_t
+{
+  static_assert(std::is_trivially_copyable_v<T>, "slot_ring_t requires a trivially copyable T");
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "slot_ring_t requires a power-of-two N");
+
+  static constexpr size_t capacity = N;
+  static constexpr size_t mask = N - 1;
+
+  // Producer line
+  alignas(RB_CACHE_LINE) std::atomic<uint64_t> head{ 0 };  // Write sequence (producer)
+  uint64_t cached_tail = 0;                                 // Producer's copy of tail
+
+  // Consumer line
+  alignas(RB_CACHE_LINE) std::atomic<uint64_t> tail{ 0 };  // Read sequence (consumer)
+  uint64_t cached_head = 0;                                 // Consumer's copy of head
+
+  // Slot storage, starting on its own line
+  alignas(RB_CACHE_LINE > alignof(T) ? RB_CACHE_LINE : alignof(T)) T slots[N];
+
+  /// <summary>
+  /// Number of elements currently stored.
+  /// </summary>
+  size_t size() const
+  {
+    return static_cast<size_t>(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+  }
+
+  /// <summary>
+  /// Pushes one element. Producer only.
+  /// </summary>
+  /// <returns>false if the ring is full.</returns>
+  bool push(const T& item)
+  {
+    return push_n(&item, 1) == 1;
+  }
+
+  /// <summary>
+  /// Pops one element. Consumer only.
+  /// </summary>
+  /// <returns>false if the ring is empty.</returns>
+  bool pop(T& item)
+  {
+    return pop_n(&item, 1) == 1;
+  }
+
+  /// <summary>
+  /// Pushes up to <c>count</c> elements with one publish. Producer only.
+  /// </summary>
+  /// <returns>The number of elements pushed.</returns>
+  size_t push_n(const T* items, size_t count)
+  {
+    uint64_t h = head.load(std::memory_order_relaxed);
+
+    size_t free = N - static_cast<size_t>(h - cached_tail);
+    if (count > free)
+    {
+      // Looks full → refresh the cached consumer index
+      cached_tail = tail.load(std::memory_order_acquire);
+      free = N - static_cast<size_t>(h - cached_tail);
+      if (count > free)
+        count = free;
+    }
+
+    size_t pos = static_cast<size_t>(h) & mask;
+    size_t first = N - pos;
+    if (first > count) first = count;
+
+    memcpy(slots + pos, items, first * sizeof(T));
+    memcpy(slots, items + first, (count - first) * sizeof(T));
+
+    head.store(h + count, std::memory_order_release);
+    return count;
+  }
+
+  /// <summary>
+  /// Pops up to <c>count</c> elements with one publish. Consumer only.
+  /// </summary>
+  /// <returns>The number of elements popped.</returns>
+  size_t pop_n(T* items, size_t count)
+  {
+    uint64_t t = tail.load(std::memory_order_relaxed);
+
+    size_t used = static_cast<size_t>(cached_head - t);
+    if (count > used)
+    {
+      // Looks empty → refresh the cached producer index
+      cached_head = head.load(std::memory_order_acquire);
+      used = static_cast<size_t>(cached_head - t);
+      if (count > used)
+        count = used;
+    }
+
+    size_t pos = static_cast<size_t>(t) & mask;
+    size_t first = N - pos;
+    if (first > count) first = count;
+
+    memcpy(items, slots + pos, first * sizeof(T));
+    memcpy(items + first, slots, (count - first) * sizeof(T));
+
+    tail.store(t + count, std::memory_order_release);
+    return count;
+  }
+};
+
+
+//
+// C exports for .NET. The element is an opaque blob of 8, 16, 32 or 64
+// bytes, so any blittable struct of that size can be pushed and popped
+// as a Span<T>. Every exported ring has SLOT_RING_EXPORT_SLOTS slots.
+//
+
+/// <summary>
+/// Slot count of the exported slot rings.
+/// </summary>
+constexpr size_t SLOT_RING_EXPORT_SLOTS = 4096;
+
+/// <summary>
+/// Opaque element of <c>Size</c> bytes used by the exported instantiations.
+/// </summary>
+template<size_t Size>
+struct slot_blob_t
+{
+  alignas(Size < 16 ? Size : 16) uint8_t bytes[Size];
+};
+
+typedef slot_ring_t<slot_blob_t<8>, SLOT_RING_EXPORT_SLOTS> slot_ring8_t;
+typedef slot_ring_t<slot_blob_t<16>, SLOT_RING_EXPORT_SLOTS> slot_ring16_t;
+typedef slot_ring_t<slot_blob_t<32>, SLOT_RING_EXPORT_SLOTS> slot_ring32_t;
+typedef slot_ring_t<slot_blob_t<64>, SLOT_RING_EXPORT_SLOTS> slot_ring64_t;
+
+/// <summary>
+/// Declares the exports for one element size:
+/// <c>slot_ringNN_create</c>, <c>_free</c>, <c>_push_n</c>, <c>_pop_n</c>, <c>_size</c>
+/// and <c>_capacity</c>. Counts are in elements, not bytes.
+/// </summary>
+#define SLOT_RING_DECLARE_EXPORTS(SIZE)                                                        \
+  EXP32 slot_ring##SIZE##_t* slot_ring##SIZE##_create();                                       \
+  EXP32 void slot_ring##SIZE##_free(slot_ring##SIZE##_t* ring);                                \
+  EXP32 uint32_t slot_ring##SIZE##_push_n(slot_ring##SIZE##_t* ring, const void* items, uint32_t count); \
+  EXP32 uint32_t slot_ring##SIZE##_pop_n(slot_ring##SIZE##_t* ring, void* items, uint32_t count);        \
+  EXP32 uint32_t slot_ring##SIZE##_size(slot_ring##SIZE##_t* ring);                            \
+  EXP32 uint32_t slot_ring##SIZE##_capacity(slot_ring##SIZE##_t* ring);
+
+SLOT_RING_DECLARE_EXPORTS(8)
+SLOT_RING_DECLARE_EXPORTS(16)
+SLOT_RING_DECLARE_EXPORTS(32)
+SLOT_RING_DECLARE_EXPORTS(64)
@@ -0,0 +1,164 @@
+#include "pch.h"
+#include <string.h>
+#include "spsc_ringbuffer.h"
+
+//
+// This source file implements the cache‑line‑isolated SPSC ring buffer.
+// Each side works against its cached copy of the opposite index and only
+// performs an acquire load on the shared line when the cached value says
+// the buffer is full (producer) or empty (consumer).
+//
+
+/// <summary>
+/// Rounds a capacity up to the next power of two.
+/// Returns 0 if the result does not fit into 32 bits.
+/// </summary>
+static uint32_t round_up_pow2(uint32_t value)
+{
+  if (value == 0 || value > 0x80000000u) return 0;
+
+  uint32_t result = 1;
+  while (result < value)
+    result <<= 1;
+  return result;
+}
+
+/// <summary>
+/// Allocates and initializes a new SPSC ring buffer.
+/// All sequence counters and cached copies start at zero.
+/// </summary>
+/// <param name="capacity">Minimum number of bytes the buffer can hold.</param>
+/// <returns>A pointer to the newly created ring buffer, or nullptr.</returns>
+EXP32 spsc_rb_t* spsc_rb_create(uint32_t capacity)
+{
+  capacity = round_up_pow2(capacity);
+  if (!capacity) return nullptr;
+
+  auto* rb = new spsc_rb_t;
+
+  rb->capacity = capacity;
+  rb->mask = capacity - 1;
+  rb->buffer = new uint8_t[capacity];
+  rb->head.store(0, std::memory_order_relaxed);
+  rb->tail.store(0, std::memory_order_relaxed);
+  rb->cached_head = 0;
+  rb->cached_tail = 0;
+
+  return rb;
+}
+
+/// <summary>
+/// Frees a previously created SPSC ring buffer and its internal storage.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer to destroy.</param>
+EXP32 void spsc_rb_free(spsc_rb_t* rb)
+{
+  if (!rb) return;
+  delete[] rb->buffer;
+  delete rb;
+}
+
+/// <summary>
+/// Returns the number of bytes currently available to read.
+/// Uses fresh acquire loads of both indices.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <returns>Readable byte count.</returns>
+EXP32 uint32_t spsc_rb_available_to_read(spsc_rb_t* rb)
+{
+  uint64_t head = rb->head.load(std::memory_order_acquire);
+  uint64_t tail = rb->tail.load(std::memory_order_acquire);
+  return static_cast<uint32_t>(head - tail);
+}
+
+/// <summary>
+/// Returns the number of bytes currently available to write.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <returns>Writable byte count.</returns>
+EXP32 uint32_t spsc_rb_available_to_write(spsc_rb_t* rb)
+{
+  return rb->capacity - spsc_rb_available_to_read(rb);
+}
+
+/// <summary>
+/// Returns the effective capacity of the ring buffer.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <returns>Capacity in bytes.</returns>
+EXP32 uint32_t spsc_rb_capacity(spsc_rb_t* rb)
+{
+  return rb->capacity;
+}
+
+/// <summary>
+/// Writes up to <c>length</c> bytes into the ring buffer.
+/// The consumer's tail is only re‑loaded when the cached copy
+/// does not leave enough room for the whole request.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="data">Source data to write.</param>
+/// <param name="length">Requested number of bytes to write.</param>
+/// <returns>The number of bytes actually written.</returns>
+EXP32 uint32_t spsc_rb_write(spsc_rb_t* rb, const uint8_t* data, uint32_t length)
+{
+  uint64_t head = rb->head.load(std::memory_order_relaxed);
+
+  uint32_t writable = rb->capacity - static_cast<uint32_t>(head - rb->cached_tail);
+  if (length > writable)
+  {
+    // Looks full → refresh the cached consumer index
+    rb->cached_tail = rb->tail.load(std::memory_order_acquire);
+    writable = rb->capacity - static_cast<uint32_t>(head - rb->cached_tail);
+    if (length > writable)
+      length = writable;
+  }
+
+  uint32_t pos = static_cast<uint32_t>(head) & rb->mask;
+
+  // First contiguous block
+  uint32_t first = rb->capacity - pos;
+  if (first > length) first = length;
+
+  memcpy(rb->buffer + pos, data, first);
+  memcpy(rb->buffer, data + first, length - first);
+
+  rb->head.store(head + length, std::memory_order_release);
+  return length;
+}
+
+/// <summary>
+/// Reads up to <c>length</c> bytes from the ring buffer.
+/// The producer's head is only re‑loaded when the cached copy
+/// does not cover the whole request.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="dest">Destination buffer to fill.</param>
+/// <param name="length">Requested number of bytes to read.</param>
+/// <returns>The number of bytes actually read.</returns>
+EXP32 uint32_t spsc_rb_read(spsc_rb_t* rb, uint8_t* dest, uint32_t length)
+{
+  uint64_t tail = rb->tail.load(std::memory_order_relaxed);
+
+  uint32_t readable = static_cast<uint32_t>(rb->cached_head - tail);
+  if (length > readable)
+  {
+    // Looks empty → refresh the cached producer index
+    rb->cached_head = rb->head.load(std::memory_order_acquire);
+    readable = static_cast<uint32_t>(rb->cached_head - tail);
+    if (length > readable)
+      length = readable;
+  }
+
+  uint32_t pos = static_cast<uint32_t>(tail) & rb->mask;
+
+  // First contiguous block
+  uint32_t first = rb->capacity - pos;
+  if (first > length) first = length;
+
+  memcpy(dest, rb->buffer + pos, first);
+  memcpy(dest + first, rb->buffer, length - first);
+
+  rb->tail.store(tail + length, std::memory_order_release);
+  return length;
+}
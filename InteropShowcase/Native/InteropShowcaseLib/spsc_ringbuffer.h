@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "EXP32IMP32.h"
+
+
+// This header defines a high‑throughput single‑producer/single‑consumer
+// ring buffer. Compared to ringbuffer_t, the producer and consumer indices
+// live on separate cache lines and each side keeps a private copy of the
+// other side's index, so the shared lines are only touched when the buffer
+// looks full (producer) or empty (consumer).
+
+
+/// <summary>
+/// Size of a cache line on all supported targets (x64, ARM64).
+/// </summary>
+constexpr size_t RB_CACHE_LINE = 64;
+
+/// <summary>
+/// Represents a cache‑line‑isolated SPSC ring buffer.
+/// The capacity is always a power of two, so positions are computed with
+/// a mask instead of a modulo. The 64‑bit sequence counters never wrap in
+/// practice, which keeps (head - tail) exact for every capacity.
+/// </summary>
+struct alignas(RB_CACHE_LINE) spsc_rb_t
+{
+  // Producer line: written by the producer, read by the consumer on refresh
+  alignas(RB_CACHE_LINE) std::atomic<uint64_t> head;  // Write sequence (producer)
+  uint64_t cached_tail;                                // Producer's copy of tail
+
+  // Consumer line: written by the consumer, read by the producer on refresh
+  alignas(RB_CACHE_LINE) std::atomic<uint64_t> tail;  // Read sequence (consumer)
+  uint64_t cached_head;                                // Consumer's copy of head
+
+  // Read‑only line: never written after creation
+  alignas(RB_CACHE_LINE) uint8_t* buffer;             // Raw byte storage
+  uint32_t capacity;                                   // Power‑of‑two size of the buffer
+  uint32_t mask;                                       // capacity - 1
+};
+
+/// <summary>
+/// Creates a new SPSC ring buffer.
+/// The requested capacity is rounded up to the next power of two.
+/// </summary>
+/// <param name="capacity">Minimum number of bytes the buffer can hold.</param>
+/// <returns>A pointer to the new ring buffer, or nullptr if the capacity is invalid.</returns>
+EXP32 spsc_rb_t* spsc_rb_create(uint32_t capacity);
+
+/// <summary>
+/// Frees a previously created SPSC ring buffer.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer to destroy.</param>
+EXP32 void spsc_rb_free(spsc_rb_t* rb);
+
+/// <summary>
+/// Writes data into the ring buffer. Must only be called by the producer.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="data">Pointer to the source data.</param>
+/// <param name="length">Number of bytes to write.</param>
+/// <returns>The number of bytes actually written.</returns>
+EXP32 uint32_t spsc_rb_write(spsc_rb_t* rb, const uint8_t* data, uint32_t length);
+
+/// <summary>
+/// Reads data from the ring buffer. Must only be called by the consumer.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <param name="dest">Destination buffer to fill.</param>
+/// <param name="length">Maximum number of bytes to read.</param>
+/// <returns>The number of bytes actually read.</returns>
+EXP32 uint32_t spsc_rb_read(spsc_rb_t* rb, uint8_t* dest, uint32_t length);
+
+/// <summary>
+/// Returns the number of bytes currently available to read.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <returns>Readable byte count.</returns>
+EXP32 uint32_t spsc_rb_available_to_read(spsc_rb_t* rb);
+
+/// <summary>
+/// Returns the number of bytes currently available to write.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <returns>Writable byte count.</returns>
+EXP32 uint32_t spsc_rb_available_to_write(spsc_rb_t* rb);
+
+/// <summary>
+/// Returns the effective (power‑of‑two) capacity of the ring buffer.
+/// </summary>
+/// <param name="rb">Pointer to the ring buffer.</param>
+/// <returns>Capacity in bytes.</returns>
+EXP32 uint32_t spsc_rb_capacity(spsc_rb_t* rb);
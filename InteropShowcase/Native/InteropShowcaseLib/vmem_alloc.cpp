@@ -0,0 +1,216 @@
+#include "pch.h"
+#include "vmem_alloc.h"
+
+#if !defined(_WIN32)
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//
+// This source file implements the page allocator behind rb_create_ex.
+// Huge pages are tried from largest to smallest; whatever is mapped is
+// then optionally bound to a NUMA node and pre‑faulted by touching every
+// page, so the first producer write does not take a page fault.
+//
+
+/// <summary>
+/// Rounds a size up to a multiple of the given page size.
+/// </summary>
+static size_t round_up(size_t size, size_t page)
+{
+  return (size + page - 1) / page * page;
+}
+
+/// <summary>
+/// Writes one byte per page so the OS commits (and places) every page now.
+/// </summary>
+static void prefault(uint8_t* base, size_t size, size_t page)
+{
+  for (size_t offset = 0; offset < size; offset += page)
+    reinterpret_cast<volatile uint8_t*>(base)[offset] = 0;
+}
+
+#if defined(_WIN32)
+
+/// <summary>
+/// Large pages require SeLockMemoryPrivilege to be enabled in the token.
+/// </summary>
+static bool enable_lock_memory_privilege()
+{
+  HANDLE token = nullptr;
+  if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+    return false;
+
+  TOKEN_PRIVILEGES tp{};
+  tp.PrivilegeCount = 1;
+  tp.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+  bool ok = LookupPrivilegeValueA(nullptr, "SeLockMemoryPrivilege", &tp.Privileges[0].Luid)
+    && AdjustTokenPrivileges(token, FALSE, &tp, 0, nullptr, nullptr)
+    && GetLastError() == ERROR_SUCCESS;
+
+  CloseHandle(token);
+  return ok;
+}
+
+/// <summary>
+/// Windows implementation: VirtualAllocExNuma with MEM_LARGE_PAGES.
+/// Windows only offers one large page size (GetLargePageMinimum, 2 MB
+/// on x64) through this call, so VMEM_HUGE_1G is served as 2 MB pages.
+/// The NUMA node is only a preference here (pages come from another node
+/// when it runs short), so VMEM_NUMA_BIND is never reported as granted.
+/// </summary>
+bool vmem_alloc(size_t size, uint32_t flags, int32_t numa_node, vmem_block_t* block)
+{
+  SYSTEM_INFO info{};
+  GetSystemInfo(&info);
+
+  const bool numa = (flags & VMEM_NUMA_BIND) && numa_node >= 0;
+  const DWORD node = numa ? static_cast<DWORD>(numa_node) : NUMA_NO_PREFERRED_NODE;
+
+  uint8_t* base = nullptr;
+  size_t mapped = 0;
+  size_t page = info.dwPageSize;
+  uint32_t granted = VMEM_DEFAULT;
+
+  const size_t large = GetLargePageMinimum();
+  if ((flags & (VMEM_HUGE_2M | VMEM_HUGE_1G)) && large && enable_lock_memory_privilege())
+  {
+    mapped = round_up(size, large);
+    base = static_cast<uint8_t*>(VirtualAllocExNuma(GetCurrentProcess(), nullptr, mapped,
+      MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, node));
+    if (base)
+    {
+      page = large;
+      granted |= VMEM_HUGE_2M;
+    }
+  }
+
+  if (!base)
+  {
+    // Fallback: regular pages
+    mapped = round_up(size, info.dwPageSize);
+    base = static_cast<uint8_t*>(VirtualAllocExNuma(GetCurrentProcess(), nullptr, mapped,
+      MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node));
+    if (!base) return false;
+  }
+
+  // Large pages are always resident; regular pages are touched on request
+  if ((flags & VMEM_PREFAULT) || (granted & VMEM_HUGE_2M))
+  {
+    prefault(base, mapped, page);
+    granted |= VMEM_PREFAULT;
+  }
+
+  block->base = base;
+  block->size = mapped;
+  block->granted = granted;
+  return true;
+}
+
+void vmem_free(vmem_block_t* block)
+{
+  if (!block || !block->base) return;
+  VirtualFree(block->base, 0, MEM_RELEASE);
+  block->base = nullptr;
+}
+
+#else
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+/// <summary>
+/// Maps anonymous memory, optionally from the hugetlb pool.
+/// </summary>
+static uint8_t* map_pages(size_t size, int extra)
+{
+  void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS | extra, -1, 0);
+  return p == MAP_FAILED ? nullptr : static_cast<uint8_t*>(p);
+}
+
+/// <summary>
+/// Linux implementation: mmap with MAP_HUGETLB (1 GB → 2 MB → regular),
+/// mbind for the NUMA node, then touch every page.
+/// </summary>
+bool vmem_alloc(size_t size, uint32_t flags, int32_t numa_node, vmem_block_t* block)
+{
+  const size_t small = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+  uint8_t* base = nullptr;
+  size_t mapped = 0;
+  size_t page = small;
+  uint32_t granted = VMEM_DEFAULT;
+
+  if (flags & VMEM_HUGE_1G)
+  {
+    mapped = round_up(size, size_t{ 1 } << 30);
+    base = map_pages(mapped, MAP_HUGETLB | MAP_HUGE_1GB);
+    if (base)
+    {
+      page = size_t{ 1 } << 30;
+      granted |= VMEM_HUGE_1G;
+    }
+  }
+
+  if (!base && (flags & (VMEM_HUGE_2M | VMEM_HUGE_1G)))
+  {
+    mapped = round_up(size, size_t{ 2 } << 20);
+    base = map_pages(mapped, MAP_HUGETLB | MAP_HUGE_2MB);
+    if (base)
+    {
+      page = size_t{ 2 } << 20;
+      granted |= VMEM_HUGE_2M;
+    }
+  }
+
+  if (!base)
+  {
+    // Fallback: regular pages, with a transparent huge page hint if asked
+    mapped = round_up(size, small);
+    base = map_pages(mapped, 0);
+    if (!base) return false;
+
+    if (flags & (VMEM_HUGE_2M | VMEM_HUGE_1G))
+      madvise(base, mapped, MADV_HUGEPAGE);
+  }
+
+  // Bind before the first touch, so the pages are placed on the node
+  if ((flags & VMEM_NUMA_BIND) && numa_node >= 0 && numa_node < 64)
+  {
+    unsigned long mask = 1ul << numa_node;
+    // maxnode counts one past the last bit the kernel reads
+    if (syscall(SYS_mbind, base, mapped, MPOL_BIND, &mask, sizeof(mask) * 8 + 1, MPOL_MF_MOVE) == 0)
+      granted |= VMEM_NUMA_BIND;
+  }
+
+  if (flags & VMEM_PREFAULT)
+  {
+    prefault(base, mapped, page);
+    granted |= VMEM_PREFAULT;
+  }
+
+  block->base = base;
+  block->size = mapped;
+  block->granted = granted;
+  return true;
+}
+
+void vmem_free(vmem_block_t* block)
+{
+  if (!block || !block->base) return;
+  munmap(block->base, block->size);
+  block->base = nullptr;
+}
+
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+// This header declares the internal page allocator used by rb_create_ex.
+// It maps ring buffer storage directly from the operating system, so the
+// caller can ask for huge pages, pre‑faulted pages and a NUMA node.
+// Every option is a request: the allocator falls back step by step and
+// reports what it actually granted. The helper is not exported.
+
+
+/// <summary>
+/// Allocation options. Used both as request and as granted result.
+/// </summary>
+enum vmem_flags_t : uint32_t
+{
+  VMEM_DEFAULT = 0,
+  VMEM_HUGE_2M = 1u << 0,          // 2 MB pages
+  VMEM_HUGE_1G = 1u << 1,          // 1 GB pages (falls back to 2 MB, then regular)
+  VMEM_PREFAULT = 1u << 2,         // Touch every page up front
+  VMEM_NUMA_BIND = 1u << 3,        // Bind the pages to a NUMA node (Windows: preferred node only, never granted)
+};
+
+/// <summary>
+/// Describes a block returned by <c>vmem_alloc</c>.
+/// </summary>
+struct vmem_block_t
+{
+  uint8_t* base;                   // Start of the block
+  size_t size;                     // Mapped size (rounded up to the page size used)
+  uint32_t granted;                // vmem_flags_t actually granted
+};
+
+/// <summary>
+/// Allocates at least <c>size</c> zeroed bytes with the requested options.
+/// </summary>
+/// <param name="size">Minimum number of bytes.</param>
+/// <param name="flags">Requested vmem_flags_t.</param>
+/// <param name="numa_node">NUMA node for VMEM_NUMA_BIND.</param>
+/// <param name="block">Receives the block on success.</param>
+/// <returns>true on success (possibly with fewer options granted), false if no memory could be mapped.</returns>
+bool vmem_alloc(size_t size, uint32_t flags, int32_t numa_node, vmem_block_t* block);
+
+/// <summary>
+/// Releases a block created by <c>vmem_alloc</c>.
+/// </summary>
+/// <param name="block">The block to release.</param>
+void vmem_free(vmem_block_t* block);
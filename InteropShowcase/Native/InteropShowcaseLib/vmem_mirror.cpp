@@ -0,0 +1,158 @@
+#include "pch.h"
+#include "vmem_mirror.h"
+
+#if defined(_WIN32)
+// VirtualAlloc2 / MapViewOfFile3 (Windows 10 1803+)
+#pragma comment(lib, "onecore.lib")
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+//
+// This source file implements the double mapping used by mirrored ring
+// buffers.
+//   Windows: reserve one placeholder of 2 * size, split it in two and
+//            replace both halves with views of the same pagefile section.
+//   Linux:   reserve 2 * size of address space, then map the same memfd
+//            twice over it with MAP_FIXED.
+//
+
+/// <summary>
+/// Returns the size granularity required by the platform mapping calls.
+/// </summary>
+size_t vmem_mirror_granularity()
+{
+#if defined(_WIN32)
+  SYSTEM_INFO info{};
+  GetSystemInfo(&info);
+  return info.dwAllocationGranularity;
+#else
+  return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+#if defined(_WIN32)
+
+/// <summary>
+/// Windows implementation based on placeholders.
+/// </summary>
+bool vmem_mirror_alloc(size_t size, vmem_mirror_t* mirror)
+{
+  if (size == 0 || size % vmem_mirror_granularity() != 0) return false;
+
+  // Reserve the whole range as one placeholder and split it in two halves
+  auto* base = static_cast<uint8_t*>(VirtualAlloc2(
+    nullptr, nullptr, 2 * size, MEM_RESERVE | MEM_RESERVE_PLACEHOLDER,
+    PAGE_NOACCESS, nullptr, 0));
+  if (!base) return false;
+
+  if (!VirtualFree(base, size, MEM_RELEASE | MEM_PRESERVE_PLACEHOLDER))
+  {
+    VirtualFree(base, 0, MEM_RELEASE);
+    return false;
+  }
+
+  // Anonymous section backed by the system paging file
+  HANDLE section = CreateFileMappingA(
+    INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+    static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+    static_cast<DWORD>(size), nullptr);
+  if (!section)
+  {
+    VirtualFree(base, 0, MEM_RELEASE);
+    VirtualFree(base + size, 0, MEM_RELEASE);
+    return false;
+  }
+
+  void* first = MapViewOfFile3(section, nullptr, base, 0, size,
+    MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0);
+  void* second = MapViewOfFile3(section, nullptr, base + size, 0, size,
+    MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0);
+
+  // The views keep the section alive
+  CloseHandle(section);
+
+  if (!first || !second)
+  {
+    if (first) UnmapViewOfFile(first);
+    else VirtualFree(base, 0, MEM_RELEASE);
+    if (second) UnmapViewOfFile(second);
+    else VirtualFree(base + size, 0, MEM_RELEASE);
+    return false;
+  }
+
+  mirror->base = base;
+  mirror->size = size;
+  return true;
+}
+
+/// <summary>
+/// Unmaps both views; this also releases the address range.
+/// </summary>
+void vmem_mirror_free(vmem_mirror_t* mirror)
+{
+  if (!mirror || !mirror->base) return;
+  UnmapViewOfFile(mirror->base);
+  UnmapViewOfFile(mirror->base + mirror->size);
+  mirror->base = nullptr;
+}
+
+#else
+
+/// <summary>
+/// Linux implementation based on memfd_create and a double mmap.
+/// </summary>
+bool vmem_mirror_alloc(size_t size, vmem_mirror_t* mirror)
+{
+  if (size == 0 || size % vmem_mirror_granularity() != 0) return false;
+
+  int fd = memfd_create("ringbuffer", MFD_CLOEXEC);
+  if (fd < 0) return false;
+
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  // Reserve the whole range, then place both views over it
+  void* reserved = mmap(nullptr, 2 * size, PROT_NONE,
+    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (reserved == MAP_FAILED)
+  {
+    close(fd);
+    return false;
+  }
+
+  auto* base = static_cast<uint8_t*>(reserved);
+  void* first = mmap(base, size, PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_FIXED, fd, 0);
+  void* second = mmap(base + size, size, PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_FIXED, fd, 0);
+
+  // The mappings keep the memory object alive
+  close(fd);
+
+  if (first == MAP_FAILED || second == MAP_FAILED)
+  {
+    munmap(base, 2 * size);
+    return false;
+  }
+
+  mirror->base = base;
+  mirror->size = size;
+  return true;
+}
+
+/// <summary>
+/// Unmaps both views in one call.
+/// </summary>
+void vmem_mirror_free(vmem_mirror_t* mirror)
+{
+  if (!mirror || !mirror->base) return;
+  munmap(mirror->base, 2 * mirror->size);
+  mirror->base = nullptr;
+}
+
+#endif
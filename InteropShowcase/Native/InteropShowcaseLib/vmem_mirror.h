@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+// This header declares the internal helper that maps the same physical
+// pages twice, back to back, into the virtual address space. Any span of up
+// to <size> bytes starting inside the first half is then contiguous in
+// memory, which lets ring buffers copy and expose wrapped data in one piece.
+// The helper is not exported; it is used by the ring buffer implementations.
+
+
+/// <summary>
+/// Describes a mirrored mapping created by <c>vmem_mirror_alloc</c>.
+/// </summary>
+struct vmem_mirror_t
+{
+  uint8_t* base;                   // Start of the first view; base + size is the mirror
+  size_t size;                     // Size of one view in bytes
+};
+
+/// <summary>
+/// Returns the granularity that mirrored sizes must be a multiple of
+/// (page size on Linux, allocation granularity on Windows).
+/// </summary>
+size_t vmem_mirror_granularity();
+
+/// <summary>
+/// Maps <c>size</c> bytes of fresh, zeroed memory twice back to back.
+/// </summary>
+/// <param name="size">Size of one view; must be a multiple of the granularity.</param>
+/// <param name="mirror">Receives the mapping on success.</param>
+/// <returns>true on success, false if the platform refused the mapping.</returns>
+bool vmem_mirror_alloc(size_t size, vmem_mirror_t* mirror);
+
+/// <summary>
+/// Releases both views of a mapping created by <c>vmem_mirror_alloc</c>.
+/// </summary>
+/// <param name="mirror">The mapping to release.</param>
+void vmem_mirror_free(vmem_mirror_t* mirror);
@@ -2,5 +2,13 @@
 
 
 
+#if defined(_WIN32)
+#if defined(SIDECARMODELLLIB_EXPORTS)
 #define EXP32 extern "C" __declspec(dllexport)
-//#define IMP32 extern "C" __declspec(dllimport)
\ No newline at end of file
+#else
+// Consumers of the DLL (e.g. SidecarWorker) import the same declarations
+#define EXP32 extern "C" __declspec(dllimport)
+#endif
+#else
+#define EXP32 extern "C" __attribute__((visibility("default")))
+#endif
\ No newline at end of file
@@ -0,0 +1,502 @@
+#include "pch.h"
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include "shared_arena.h"
+#include "shared_ringbuffer.h"   // SHARED_RB_POSIX (same backends)
+
+#if SHARED_RB_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+
+/*
+ * Shared memory header, at offset 0 of every arena.
+ *
+ * Layout (one cache line each):
+ *   [descriptor: magic, version, block size, block count, block offset]
+ *   [cursor, free_blocks]  ← allocator state
+ *   [stats]                (shared_arena_stats_t)
+ *
+ * As with the rings, the creator writes the descriptor once and
+ * publishes it with the release store of magic. cursor is only a hint
+ * of the allocators; free_blocks is the one word both sides modify
+ * (allocations subtract, releases add).
+ */
+constexpr size_t SHARED_ARENA_CACHE_LINE = 64;
+constexpr uint32_t SHARED_ARENA_MAGIC = 0x31415253;   // "SRA1"
+constexpr uint32_t SHARED_ARENA_VERSION = 1;
+
+struct alignas(SHARED_ARENA_CACHE_LINE) shared_arena_header_t
+{
+  std::atomic<uint32_t> magic;   // SHARED_ARENA_MAGIC once the descriptor is valid
+  uint32_t version;              // SHARED_ARENA_VERSION
+  uint32_t block_size;           // Bytes per block
+  uint32_t block_count;          // Number of blocks
+  uint64_t blocks;               // Offset of the block area from the region start
+
+  alignas(SHARED_ARENA_CACHE_LINE) std::atomic<uint32_t> cursor;  // Next-fit start
+  std::atomic<uint32_t> free_blocks;                               // Blocks not busy
+
+  alignas(SHARED_ARENA_CACHE_LINE) shared_arena_stats_t stats;    // Counters (shared_arena_stats)
+};
+
+static_assert(sizeof(shared_arena_header_t) == 3 * SHARED_ARENA_CACHE_LINE,
+  "shared_arena_header_t layout is shared between processes");
+
+
+/*
+ * Internal representation of a mapped arena.
+ */
+struct shared_arena_t
+{
+#if SHARED_RB_POSIX
+  int fd = -1;                   // shm_open descriptor
+  std::string name;              // Normalized shm name ("/...")
+  bool owner = false;            // Created here → shm_unlink on close
+#else
+  HANDLE mapping = nullptr;      // Handle to the shared memory mapping
+#endif
+  uint8_t* base = nullptr;       // Start of the mapping
+  size_t mapped = 0;             // Size of the mapping
+
+  shared_arena_header_t* header = nullptr;
+  std::atomic<uint32_t>* state = nullptr;  // Per block: generation << 1 | busy
+  std::atomic<uint32_t>* runs = nullptr;   // Per block: run length if a run starts here, else 0
+  uint8_t* blocks = nullptr;               // Block area
+  uint32_t block_size = 0;
+  uint32_t block_count = 0;
+};
+
+
+/*
+ * Returns the offset of the block area: header, then one state word and
+ * one run word per block, rounded up to a cache line.
+ */
+static uint64_t blocks_offset(uint32_t block_count)
+{
+  const uint64_t end = sizeof(shared_arena_header_t) + uint64_t{ block_count } * 2 * sizeof(uint32_t);
+  return (end + SHARED_ARENA_CACHE_LINE - 1) & ~uint64_t{ SHARED_ARENA_CACHE_LINE - 1 };
+}
+
+
+static uint64_t region_size(uint32_t block_size, uint32_t block_count)
+{
+  return blocks_offset(block_count) + uint64_t{ block_size } * block_count;
+}
+
+
+/*
+ * Number of blocks a payload of length bytes spans.
+ */
+static uint64_t run_blocks(const shared_arena_t* arena, uint32_t length)
+{
+  return (uint64_t{ length } + arena->block_size - 1) / arena->block_size;
+}
+
+
+/*
+ * Points the handle at a mapped region whose descriptor is valid.
+ */
+static void bind_region(shared_arena_t* arena, uint8_t* base, size_t mapped)
+{
+  arena->base = base;
+  arena->mapped = mapped;
+  arena->header = reinterpret_cast<shared_arena_header_t*>(base);
+  arena->state = reinterpret_cast<std::atomic<uint32_t>*>(base + sizeof(shared_arena_header_t));
+  arena->runs = arena->state + arena->header->block_count;
+  arena->blocks = base + arena->header->blocks;
+  arena->block_size = arena->header->block_size;
+  arena->block_count = arena->header->block_count;
+}
+
+
+/*
+ * Initializes the header of a new, zero-filled region (all blocks free,
+ * generation 0). magic is stored last (release).
+ */
+static void init_header(uint8_t* base, uint32_t block_size, uint32_t block_count)
+{
+  auto* h = reinterpret_cast<shared_arena_header_t*>(base);
+  h->version = SHARED_ARENA_VERSION;
+  h->block_size = block_size;
+  h->block_count = block_count;
+  h->blocks = blocks_offset(block_count);
+  h->cursor.store(0, std::memory_order_relaxed);
+  h->free_blocks.store(block_count, std::memory_order_relaxed);
+  h->stats = shared_arena_stats_t{};
+  h->magic.store(SHARED_ARENA_MAGIC, std::memory_order_release);
+}
+
+
+/*
+ * Validates the header of an existing region. Returns the size of the
+ * whole region, or 0 if it is not a (complete) arena.
+ */
+static uint64_t read_header(const shared_arena_header_t* h)
+{
+  if (h->magic.load(std::memory_order_acquire) != SHARED_ARENA_MAGIC
+    || h->version != SHARED_ARENA_VERSION
+    || h->block_size == 0 || h->block_size % SHARED_ARENA_BLOCK_ALIGN != 0
+    || h->block_count == 0 || h->blocks != blocks_offset(h->block_count))
+    return 0;
+
+  return region_size(h->block_size, h->block_count);
+}
+
+
+/*
+ * Adds one to a statistics counter. Several host threads may allocate
+ * at once, so unlike the ring counters this is a locked increment.
+ */
+static inline void stat_inc(uint64_t& counter)
+{
+  std::atomic_ref<uint64_t>(counter).fetch_add(1, std::memory_order_relaxed);
+}
+
+
+#if !SHARED_RB_POSIX
+
+/*
+ * Creates a new arena (Windows backend): a named mapping backed by the
+ * paging file, zero-filled by the system. An existing mapping of that
+ * name is not reused (its blocks may be in use).
+ */
+EXP32 shared_arena_t* shared_arena_create(const char* name, uint32_t block_size, uint32_t block_count)
+{
+  if (!name || block_size == 0 || block_count == 0) return nullptr;
+  block_size = (block_size + SHARED_ARENA_BLOCK_ALIGN - 1) & ~(SHARED_ARENA_BLOCK_ALIGN - 1);
+  if (block_size == 0) return nullptr;
+
+  const uint64_t total = region_size(block_size, block_count);
+  if (total > SIZE_MAX) return nullptr;
+
+  auto* arena = new shared_arena_t();
+  arena->mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+    static_cast<DWORD>(total >> 32), static_cast<DWORD>(total), name);
+  if (arena->mapping && GetLastError() == ERROR_ALREADY_EXISTS)
+  {
+    shared_arena_close(arena);
+    return nullptr;
+  }
+
+  void* base = arena->mapping
+    ? MapViewOfFile(arena->mapping, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T>(total)) : nullptr;
+  if (!base)
+  {
+    shared_arena_close(arena);
+    return nullptr;
+  }
+
+  init_header(static_cast<uint8_t*>(base), block_size, block_count);
+  bind_region(arena, static_cast<uint8_t*>(base), static_cast<size_t>(total));
+  return arena;
+}
+
+
+/*
+ * Opens an existing arena (Windows backend): maps the header alone to
+ * learn the size, then the whole region.
+ */
+EXP32 shared_arena_t* shared_arena_open(const char* name)
+{
+  if (!name) return nullptr;
+
+  auto* arena = new shared_arena_t();
+  arena->mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+
+  uint64_t total = 0;
+  if (arena->mapping)
+  {
+    auto* h = static_cast<const shared_arena_header_t*>(
+      MapViewOfFile(arena->mapping, FILE_MAP_READ, 0, 0, sizeof(shared_arena_header_t)));
+    if (h)
+    {
+      total = read_header(h);
+      UnmapViewOfFile(h);
+    }
+  }
+
+  void* base = total && total <= SIZE_MAX
+    ? MapViewOfFile(arena->mapping, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T>(total)) : nullptr;
+  if (!base)
+  {
+    shared_arena_close(arena);
+    return nullptr;
+  }
+
+  bind_region(arena, static_cast<uint8_t*>(base), static_cast<size_t>(total));
+  return arena;
+}
+
+
+EXP32 void shared_arena_close(shared_arena_t* arena)
+{
+  if (!arena) return;
+
+  if (arena->base)
+    UnmapViewOfFile(arena->base);
+
+  if (arena->mapping)
+    CloseHandle(arena->mapping);
+
+  delete arena;
+}
+
+#else
+
+/*
+ * Creates a new arena (POSIX backend): shm_open + ftruncate, which
+ * zero-fills the region, then mmap. O_EXCL: an existing object of that
+ * name is not reused (its blocks may be in use).
+ */
+EXP32 shared_arena_t* shared_arena_create(const char* name, uint32_t block_size, uint32_t block_count)
+{
+  if (!name || block_size == 0 || block_count == 0) return nullptr;
+  block_size = (block_size + SHARED_ARENA_BLOCK_ALIGN - 1) & ~(SHARED_ARENA_BLOCK_ALIGN - 1);
+  if (block_size == 0) return nullptr;
+
+  const uint64_t total = region_size(block_size, block_count);
+
+  auto* arena = new shared_arena_t();
+  arena->name = name[0] == '/' ? std::string(name) : "/" + std::string(name);
+
+  arena->fd = shm_open(arena->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (arena->fd < 0)
+  {
+    delete arena;
+    return nullptr;
+  }
+  arena->owner = true;
+
+  void* base = ftruncate(arena->fd, static_cast<off_t>(total)) == 0
+    ? mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, arena->fd, 0) : MAP_FAILED;
+  if (base == MAP_FAILED)
+  {
+    shared_arena_close(arena);
+    return nullptr;
+  }
+
+  init_header(static_cast<uint8_t*>(base), block_size, block_count);
+  bind_region(arena, static_cast<uint8_t*>(base), total);
+  return arena;
+}
+
+
+/*
+ * Opens an existing arena (POSIX backend): maps the header alone to
+ * validate it, checks the object size, then maps the whole region.
+ */
+EXP32 shared_arena_t* shared_arena_open(const char* name)
+{
+  if (!name) return nullptr;
+
+  auto* arena = new shared_arena_t();
+  arena->name = name[0] == '/' ? std::string(name) : "/" + std::string(name);
+
+  arena->fd = shm_open(arena->name.c_str(), O_RDWR, 0);
+  struct stat st{};
+  uint64_t total = 0;
+  if (arena->fd >= 0 && fstat(arena->fd, &st) == 0
+    && static_cast<size_t>(st.st_size) >= sizeof(shared_arena_header_t))
+  {
+    void* h = mmap(nullptr, sizeof(shared_arena_header_t), PROT_READ, MAP_SHARED, arena->fd, 0);
+    if (h != MAP_FAILED)
+    {
+      total = read_header(static_cast<const shared_arena_header_t*>(h));
+      munmap(h, sizeof(shared_arena_header_t));
+    }
+  }
+
+  void* base = total && static_cast<uint64_t>(st.st_size) >= total
+    ? mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, arena->fd, 0) : MAP_FAILED;
+  if (base == MAP_FAILED)
+  {
+    shared_arena_close(arena);
+    return nullptr;
+  }
+
+  bind_region(arena, static_cast<uint8_t*>(base), total);
+  return arena;
+}
+
+
+EXP32 void shared_arena_close(shared_arena_t* arena)
+{
+  if (!arena) return;
+
+  if (arena->base)
+    munmap(arena->base, arena->mapped);
+
+  if (arena->fd >= 0)
+    close(arena->fd);
+
+  if (arena->owner)
+    shm_unlink(arena->name.c_str());
+
+  delete arena;
+}
+
+#endif
+
+
+/*
+ * Claims blocks first .. first + n - 1 by setting their busy bits.
+ * Stores the generation of the first block in *generation. Returns n on
+ * success; otherwise the index of the block that was busy, after
+ * freeing the ones claimed so far (no descriptor named them yet).
+ */
+static uint32_t claim_run(shared_arena_t* arena, uint32_t first, uint32_t n, uint32_t* generation)
+{
+  for (uint32_t i = 0; i < n; i++)
+  {
+    std::atomic<uint32_t>& state = arena->state[first + i];
+    uint32_t value = state.load(std::memory_order_relaxed);
+    if ((value & 1) || !state.compare_exchange_strong(value, value | 1, std::memory_order_acquire))
+    {
+      for (uint32_t j = 0; j < i; j++)
+        arena->state[first + j].fetch_and(~1u, std::memory_order_release);
+      return i;
+    }
+
+    if (i == 0) *generation = value >> 1;
+  }
+  return n;
+}
+
+
+/*
+ * Next-fit search for n adjacent free blocks, starting at the cursor.
+ * Runs never wrap around the end of the arena. A busy block rules out
+ * every run that contains it, so the scan continues behind it.
+ */
+EXP32 uint8_t* shared_arena_alloc(shared_arena_t* arena, uint32_t length, shared_arena_desc_t* desc)
+{
+  if (!arena || !desc || length == 0) return nullptr;
+
+  shared_arena_header_t* h = arena->header;
+  const uint32_t count = arena->block_count;
+  const uint64_t needed = run_blocks(arena, length);
+
+  if (needed <= h->free_blocks.load(std::memory_order_acquire))
+  {
+    const auto n = static_cast<uint32_t>(needed);
+    const uint32_t start = h->cursor.load(std::memory_order_relaxed) % count;
+
+    for (uint32_t scanned = 0; scanned < count;)
+    {
+      const uint32_t first = (start + scanned) % count;
+      if (n > count - first)
+      {
+        scanned += count - first;
+        continue;
+      }
+
+      uint32_t generation = 0;
+      const uint32_t claimed = claim_run(arena, first, n, &generation);
+      if (claimed < n)
+      {
+        scanned += claimed + 1;
+        continue;
+      }
+
+      arena->runs[first].store(n, std::memory_order_relaxed);
+      h->free_blocks.fetch_sub(n, std::memory_order_relaxed);
+      h->cursor.store((first + n) % count, std::memory_order_relaxed);
+      stat_inc(h->stats.allocs);
+
+      *desc = { uint64_t{ first } * arena->block_size, length, generation };
+      return arena->blocks + desc->offset;
+    }
+  }
+
+  stat_inc(h->stats.alloc_failures);
+  return nullptr;
+}
+
+
+/*
+ * Checks a descriptor against the arena: in range, its first block
+ * still busy with the descriptor's generation, and a run of exactly
+ * its length allocated there. So a descriptor can neither reach into a
+ * neighbouring run (a larger length) nor into the middle of one. Stores
+ * the first block and the run length.
+ */
+static bool check_desc(shared_arena_t* arena, const shared_arena_desc_t* desc, uint32_t* first, uint32_t* n)
+{
+  if (!arena || !desc || desc->length == 0 || desc->offset % arena->block_size != 0) return false;
+
+  const uint64_t index = desc->offset / arena->block_size;
+  const uint64_t blocks = run_blocks(arena, desc->length);
+  if (index >= arena->block_count || blocks > arena->block_count - index) return false;
+
+  *first = static_cast<uint32_t>(index);
+  *n = static_cast<uint32_t>(blocks);
+  return arena->state[index].load(std::memory_order_acquire) == ((desc->generation << 1) | 1)
+    && arena->runs[index].load(std::memory_order_relaxed) == blocks;
+}
+
+
+EXP32 uint8_t* shared_arena_resolve(shared_arena_t* arena, const shared_arena_desc_t* desc)
+{
+  uint32_t first = 0, n = 0;
+  if (check_desc(arena, desc, &first, &n)) return arena->blocks + desc->offset;
+
+  if (arena) stat_inc(arena->header->stats.rejected);
+  return nullptr;
+}
+
+
+/*
+ * Frees the run: clears the busy bits and advances the generations in
+ * one store per block (value + 2 carries into the generation bits).
+ */
+EXP32 int32_t shared_arena_release(shared_arena_t* arena, const shared_arena_desc_t* desc)
+{
+  uint32_t first = 0, n = 0;
+  if (!check_desc(arena, desc, &first, &n))
+  {
+    if (arena) stat_inc(arena->header->stats.rejected);
+    return 0;
+  }
+
+  arena->runs[first].store(0, std::memory_order_relaxed);
+  for (uint32_t i = first; i < first + n; i++)
+  {
+    const uint32_t value = arena->state[i].load(std::memory_order_relaxed);
+    arena->state[i].store((value + 2) & ~1u, std::memory_order_release);
+  }
+
+  arena->header->free_blocks.fetch_add(n, std::memory_order_release);
+  stat_inc(arena->header->stats.releases);
+  return 1;
+}
+
+
+EXP32 uint32_t shared_arena_block_size(shared_arena_t* arena)
+{
+  return arena ? arena->block_size : 0;
+}
+
+
+EXP32 uint32_t shared_arena_block_count(shared_arena_t* arena)
+{
+  return arena ? arena->block_count : 0;
+}
+
+
+EXP32 uint32_t shared_arena_free_blocks(shared_arena_t* arena)
+{
+  return arena ? arena->header->free_blocks.load(std::memory_order_relaxed) : 0;
+}
+
+
+EXP32 const shared_arena_stats_t* shared_arena_stats(shared_arena_t* arena)
+{
+  return arena ? &arena->header->stats : nullptr;
+}
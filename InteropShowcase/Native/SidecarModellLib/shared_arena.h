@@ -0,0 +1,187 @@
+#pragma once
+#include <stdint.h>
+#include "EXP32IMP32.h"   // Contains EXP32 macro (extern "C" + dllexport)
+
+
+/*
+ * Shared-memory payload arena: a named region of fixed-size blocks that
+ * lives next to a ring, for payloads too large to pass through it.
+ *
+ * The host allocates a run of blocks, fills it in place and writes only
+ * a shared_arena_desc_t through the ring (SIDECAR_MSG_ARENA). The
+ * sidecar resolves the descriptor to the block, hands it to its
+ * callbacks in place and releases it afterwards. A large payload is
+ * never copied, and the ring keeps moving small commands meanwhile.
+ *
+ * Layout:
+ *   [shared_arena_header_t]      descriptor, allocator line, stats lines
+ *   [uint32_t state[count]]      per block: generation << 1 | busy
+ *   [uint32_t runs[count]]       per block: run length if a run starts here
+ *   [blocks]                     count * block_size bytes, 64-byte aligned
+ *
+ * A block is busy from shared_arena_alloc until shared_arena_release.
+ * Every release advances the generation of its blocks, and the run
+ * length is kept at the first block, so a descriptor that was already
+ * released, or is forged (other offset or length), does not resolve.
+ */
+
+
+/*
+ * Smallest block size; block sizes are rounded up to a multiple of it.
+ */
+constexpr uint32_t SHARED_ARENA_BLOCK_ALIGN = 64;
+
+
+/*
+ * Location of one allocation. Small and trivially copyable, so it can
+ * travel through a ring as the payload of a record.
+ *
+ * Fields:
+ *   offset     - Byte offset of the first block from the start of the
+ *                block area (a multiple of the block size)
+ *   length     - Payload bytes; the run spans ceil(length / block size)
+ *                blocks
+ *   generation - Generation of the first block at allocation time
+ */
+struct shared_arena_desc_t
+{
+  uint64_t offset;
+  uint32_t length;
+  uint32_t generation;
+};
+
+static_assert(sizeof(shared_arena_desc_t) == 16, "shared_arena_desc_t crosses process boundaries");
+
+
+/*
+ * Counters of an arena, in shared memory (see shared_arena_stats).
+ *
+ *   allocs         - Successful shared_arena_alloc calls
+ *   alloc_failures - shared_arena_alloc calls that found no free run
+ *   releases       - Successful shared_arena_release calls
+ *   rejected       - Descriptors that did not resolve (stale, released
+ *                    twice or out of range)
+ */
+struct shared_arena_stats_t
+{
+  uint64_t allocs;
+  uint64_t alloc_failures;
+  uint64_t releases;
+  uint64_t rejected;
+};
+
+
+/*
+ * Opaque handle of a mapped arena.
+ */
+struct shared_arena_t;
+
+
+/*
+ * Creates a new arena.
+ *
+ * Parameters:
+ *   name        - Unique name of the shared memory object (e.g.,
+ *                 "SidecarRB_arena")
+ *   block_size  - Bytes per block (rounded up to SHARED_ARENA_BLOCK_ALIGN)
+ *   block_count - Number of blocks
+ *
+ * Returns:
+ *   Arena handle, or nullptr on failure (e.g. name in use, zero sizes)
+ *
+ * Notes:
+ *   - Same backends as shared_rb_create (named file mapping, or
+ *     shm_open + mmap on Linux, where the name gets a leading '/')
+ *   - A payload may span several adjacent blocks, so the block size
+ *     trades waste for small payloads against fragmentation
+ *   - Typically called by the host process, which owns the name
+ */
+EXP32 shared_arena_t* shared_arena_create(const char* name, uint32_t block_size, uint32_t block_count);
+
+
+/*
+ * Opens an existing arena; block size and count come from its header.
+ *
+ * Returns:
+ *   Arena handle, or nullptr if it does not exist or is not an arena
+ */
+EXP32 shared_arena_t* shared_arena_open(const char* name);
+
+
+/*
+ * Unmaps an arena and frees the handle. The creator also removes the
+ * name (Linux); blocks still busy are simply dropped.
+ */
+EXP32 void shared_arena_close(shared_arena_t* arena);
+
+
+/*
+ * Allocates a run of free blocks.
+ *
+ * Parameters:
+ *   arena  - Arena handle (host side)
+ *   length - Payload bytes (1 up to block_size * block_count)
+ *   desc   - Receives the descriptor of the run
+ *
+ * Returns:
+ *   Writable pointer to the run, or nullptr if no free run of that size
+ *   exists right now
+ *
+ * Notes:
+ *   - Never blocks: the sidecar frees blocks as it finishes messages,
+ *     so a caller that gets nullptr retries later or sends smaller
+ *   - Scans from where the last allocation ended (next fit), so blocks
+ *     are reused in roughly the order they were handed out
+ *   - Safe to call from several threads of one process at once; blocks
+ *     are claimed with compare-and-swap
+ */
+EXP32 uint8_t* shared_arena_alloc(shared_arena_t* arena, uint32_t length, shared_arena_desc_t* desc);
+
+
+/*
+ * Resolves a descriptor to its payload.
+ *
+ * Returns:
+ *   Pointer to the run, or nullptr if the descriptor is out of range or
+ *   its blocks were released since (generation mismatch)
+ */
+EXP32 uint8_t* shared_arena_resolve(shared_arena_t* arena, const shared_arena_desc_t* desc);
+
+
+/*
+ * Releases the run of a descriptor, making its blocks free again.
+ *
+ * Returns:
+ *   1 on success, 0 if the descriptor does not resolve (counted in
+ *   rejected)
+ *
+ * Notes:
+ *   - Called by whoever owns the run at that point: the sidecar after
+ *     processing it, or the host for a run it never sent
+ *   - Advances the generation of every block of the run
+ */
+EXP32 int32_t shared_arena_release(shared_arena_t* arena, const shared_arena_desc_t* desc);
+
+
+/*
+ * Returns the block size in bytes.
+ */
+EXP32 uint32_t shared_arena_block_size(shared_arena_t* arena);
+
+
+/*
+ * Returns the number of blocks.
+ */
+EXP32 uint32_t shared_arena_block_count(shared_arena_t* arena);
+
+
+/*
+ * Returns the number of free blocks right now.
+ */
+EXP32 uint32_t shared_arena_free_blocks(shared_arena_t* arena);
+
+
+/*
+ * Returns the arena's counters (in shared memory, updated live).
+ */
+EXP32 const shared_arena_stats_t* shared_arena_stats(shared_arena_t* arena);
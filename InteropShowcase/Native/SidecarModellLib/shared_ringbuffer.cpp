@@ -1,10 +1,83 @@
 #include "pch.h"
 
 #include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstddef>
 #include <cstring>
-#include <windows.h>
+#include <string>
+#include <thread>
 #include "shared_ringbuffer.h"
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(_M_ARM64)
+#include <intrin.h>
+#endif
+
+#if SHARED_RB_POSIX
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <windows.h>
+
+// VirtualAlloc2 / MapViewOfFile3 for the mirrored layout (Windows 10 1803+)
+#pragma comment(lib, "onecore.lib")
+#endif
+
+/*
+ * Shared memory header, at offset 0 of every ring buffer region.
+ *
+ * Layout (one cache line each):
+ *   [descriptor: magic, version, capacity, flags, payload offset]
+ *   [head, write_waiters]  ← written by the producer only
+ *   [tail, read_waiters]  ← written by the consumer only
+ *   [stats: producer line, consumer line]  (shared_rb_stats_t)
+ *
+ * The descriptor is written once by the creator and published by the
+ * release store of magic; openers validate it and map exactly the
+ * capacity that was created. head and tail live on separate lines, so
+ * the host and sidecar cores do not invalidate each other's line on
+ * every index update.
+ *
+ * read_waiters counts consumers parked in shared_rb_wait_readable; the
+ * producer reads it after publishing head and only issues a wakeup
+ * (futex / named event) when it is non-zero. write_waiters is the mirror
+ * image for producers parked in shared_rb_wait_writable: the consumer
+ * checks it after publishing tail.
+ *
+ * The statistics follow at SHARED_RB_STATS_OFFSET; like head and tail,
+ * each of their lines has a single writer.
+ */
+constexpr size_t SHARED_RB_CACHE_LINE = 64;
+constexpr uint32_t SHARED_RB_MAGIC = 0x31425253;   // "SRB1"
+constexpr uint32_t SHARED_RB_VERSION = 5;
+
+struct alignas(SHARED_RB_CACHE_LINE) shared_rb_header_t
+{
+  std::atomic<uint32_t> magic;   // SHARED_RB_MAGIC once the descriptor is valid
+  uint32_t version;              // SHARED_RB_VERSION
+  uint32_t capacity;             // Exact payload capacity in bytes
+  uint32_t flags;                // Layout flags (SHARED_RB_MIRRORED, SHARED_RB_FRAMED)
+  uint32_t offset;               // Payload offset from the region start
+
+  alignas(SHARED_RB_CACHE_LINE) std::atomic<uint32_t> head;  // Producer index
+  std::atomic<uint32_t> write_waiters;                        // Parked producers
+  alignas(SHARED_RB_CACHE_LINE) std::atomic<uint32_t> tail;  // Consumer index
+  std::atomic<uint32_t> read_waiters;                         // Parked consumers
+
+  shared_rb_stats_t stats;                                    // Counters (shared_rb_stats)
+};
+
+static_assert(offsetof(shared_rb_header_t, stats) == SHARED_RB_STATS_OFFSET &&
+  sizeof(shared_rb_header_t) == 5 * SHARED_RB_CACHE_LINE,
+  "shared_rb_header_t layout is shared between processes");
+
+
 /*
  * Internal representation of the shared ring buffer.
  *
@@ -13,49 +86,430 @@
  */
 struct shared_rb_t
 {
+#if SHARED_RB_POSIX
+  int fd = -1;                   // shm_open descriptor
+  std::string name;              // Normalized shm name ("/...")
+  bool owner = false;            // Created here → shm_unlink on close
+  uint8_t* base = nullptr;       // Start of the whole mapping
+  size_t mapped = 0;             // Size of the whole mapping (munmap)
+#else
   HANDLE mapping = nullptr;      // Handle to the shared memory mapping
+  HANDLE wake = nullptr;         // Named auto-reset event ("<name>_wake")
+  HANDLE space = nullptr;        // Named auto-reset event ("<name>_space")
+#endif
   uint32_t capacity = 0;         // Size of the ring buffer (payload area)
+  uint32_t granted = 0;          // shared_rb_flags_t actually applied
+  uint32_t wait_spins = 0;       // Phase 1 of the wait calls
+  uint32_t wait_yields = 0;      // Phase 2 of the wait calls
+
+  // shared_rb_notify on this handle: notified counts the calls (and is a
+  // futex word on Linux), notified_seen what the consumer has taken
+  std::atomic<uint32_t> notified{ 0 };
+  uint32_t notified_seen = 0;
 
   // Shared memory layout:
-  // [uint32_t head]
-  // [uint32_t tail]
-  // [uint8_t  buffer[capacity]]
-  std::atomic<uint32_t>* head = nullptr; // Producer index
-  std::atomic<uint32_t>* tail = nullptr; // Consumer index
+  // [shared_rb_header_t]
+  // [uint8_t buffer[capacity]]
+  shared_rb_header_t* header = nullptr;  // Start of the region
+  std::atomic<uint32_t>* head = nullptr; // Producer index (&header->head)
+  std::atomic<uint32_t>* tail = nullptr; // Consumer index (&header->tail)
   uint8_t* buffer = nullptr;             // Pointer to the byte payload region
+
+  // Mirrored layout (SHARED_RB_MIRRORED):
+  // [header view: shared_rb_header_t, padding up to the allocation granularity]
+  // [buffer view]
+  // [buffer view again]  ← same pages, so wrapped data is contiguous
+  bool mirrored = false;
+
+  // Framed payload (SHARED_RB_FRAMED):
+  // [shared_rb_record_hdr_t][payload] records back to back, no padding
+  bool framed = false;
 };
 
+
+/*
+ * Returns the mapping granularity of a mirrored ring buffer: the payload
+ * views must start on a multiple of it (defined per backend).
+ */
+static size_t mirror_granularity();
+
+
+/*
+ * Parks the consumer of one or more rings until a producer signals head
+ * or the ring is notified (shared_rb_notify), or until timeout_ms
+ * expires (defined per backend). Returns immediately if a head no longer
+ * equals its entry in observed. Spurious wakeups are possible; callers
+ * re-check their condition. Returns false if it only polled (a backend
+ * that cannot park on all rings), so an unchanged head means nothing.
+ */
+static bool park_any(shared_rb_t* const* rbs, const uint32_t* observed, uint32_t count, int32_t timeout_ms);
+
+
+/*
+ * Wakes the consumer parked in park_any (defined per backend).
+ */
+static void wake_head(shared_rb_t* rb);
+
+
+/*
+ * Wakes the consumer parked in park_any after notified was raised
+ * (defined per backend).
+ */
+static void wake_notify(shared_rb_t* rb);
+
+
+/*
+ * Parks the calling thread until the consumer signals tail, or until
+ * timeout_ms expires (defined per backend). Returns immediately if tail
+ * no longer equals observed; spurious wakeups are possible.
+ */
+static void park_tail(shared_rb_t* rb, uint32_t observed, int32_t timeout_ms);
+
+
+/*
+ * Wakes the producer parked in park_tail (defined per backend).
+ */
+static void wake_tail(shared_rb_t* rb);
+
+
+/*
+ * Returns the payload offset (= header area size) for a layout.
+ */
+static size_t payload_offset(bool mirrored)
+{
+  return mirrored ? mirror_granularity() : sizeof(shared_rb_header_t);
+}
+
+
+/*
+ * Points the wrapper at a freshly mapped region.
+ */
+static void bind_header(shared_rb_t* rb, uint8_t* base)
+{
+  rb->header = reinterpret_cast<shared_rb_header_t*>(base);
+  rb->head = &rb->header->head;
+  rb->tail = &rb->header->tail;
+}
+
+
+/*
+ * Initializes the header of a newly created region.
+ * magic is stored last (release), so an opener that sees it also sees
+ * the rest of the descriptor.
+ */
+static void init_header(shared_rb_t* rb)
+{
+  shared_rb_header_t* h = rb->header;
+  h->version = SHARED_RB_VERSION;
+  h->capacity = rb->capacity;
+  h->flags = shared_rb_granted(rb) & (SHARED_RB_MIRRORED | SHARED_RB_FRAMED);
+  h->offset = static_cast<uint32_t>(payload_offset(rb->mirrored));
+  h->head.store(0, std::memory_order_relaxed);
+  h->tail.store(0, std::memory_order_relaxed);
+  h->read_waiters.store(0, std::memory_order_relaxed);
+  h->write_waiters.store(0, std::memory_order_relaxed);
+  h->stats = shared_rb_stats_t{};
+  h->magic.store(SHARED_RB_MAGIC, std::memory_order_release);
+}
+
+
+/*
+ * Validates the header of an existing region and takes capacity and
+ * layout from it.
+ *
+ * Returns false if magic or version do not match, or if the descriptor
+ * is inconsistent (e.g. a mirrored capacity that is not a power of two,
+ * or a payload offset the local backend would not produce).
+ */
+static bool read_header(shared_rb_t* rb, const shared_rb_header_t* h)
+{
+  if (h->magic.load(std::memory_order_acquire) != SHARED_RB_MAGIC) return false;
+  if (h->version != SHARED_RB_VERSION) return false;
+
+  const bool mirrored = (h->flags & SHARED_RB_MIRRORED) != 0;
+  if (h->capacity == 0 || h->offset != payload_offset(mirrored)) return false;
+  if (mirrored && (h->capacity & (h->capacity - 1)) != 0) return false;
+
+  rb->capacity = h->capacity;
+  rb->mirrored = mirrored;
+  rb->framed = (h->flags & SHARED_RB_FRAMED) != 0;
+  return true;
+}
+
+
+/*
+ * Rounds a mirrored capacity up to a power of two of at least the
+ * allocation granularity. Only the creator rounds; openers take the
+ * result from the header.
+ */
+static uint32_t mirror_capacity(uint32_t capacity)
+{
+  if (capacity == 0 || capacity > 0x80000000u) return 0;
+
+  size_t size = mirror_granularity();
+  while (size < capacity)
+    size <<= 1;
+  return static_cast<uint32_t>(size);
+}
+
+
+#if !SHARED_RB_POSIX
+
+/*
+ * Returns the size of the header view of a mirrored ring buffer.
+ * MapViewOfFile3 offsets must be multiples of the allocation granularity,
+ * so the payload starts at the first granularity boundary.
+ */
+static size_t mirror_granularity()
+{
+  SYSTEM_INFO info{};
+  GetSystemInfo(&info);
+  return info.dwAllocationGranularity;
+}
+
+
+/*
+ * Opens (or creates) the named auto-reset events of a ring buffer.
+ * WaitOnAddress only works inside one process, so the cross-process
+ * wakeups go through kernel events named after the mapping: "_wake"
+ * for the consumer (data), "_space" for the producer (free space).
+ */
+static bool open_wake_event(shared_rb_t* rb, const char* name)
+{
+  const std::string event = std::string(name) + "_wake";
+  rb->wake = CreateEventA(nullptr, FALSE, FALSE, event.c_str());
+
+  const std::string space = std::string(name) + "_space";
+  rb->space = CreateEventA(nullptr, FALSE, FALSE, space.c_str());
+  return rb->wake != nullptr && rb->space != nullptr;
+}
+
+
+static void wake_head(shared_rb_t* rb)
+{
+  SetEvent(rb->wake);
+}
+
+
+static bool park_any(shared_rb_t* const* rbs, const uint32_t* observed, uint32_t count, int32_t timeout_ms)
+{
+  HANDLE events[SHARED_RB_WAIT_ANY_MAX];
+  for (uint32_t i = 0; i < count; i++)
+  {
+    if (rbs[i]->head->load(std::memory_order_acquire) != observed[i]) return true;
+    events[i] = rbs[i]->wake;
+  }
+
+  WaitForMultipleObjects(count, events, FALSE, timeout_ms < 0 ? INFINITE : static_cast<DWORD>(timeout_ms));
+  return true;
+}
+
+
+// The wake event is auto-reset, so a notify before the park is kept.
+static void wake_notify(shared_rb_t* rb)
+{
+  SetEvent(rb->wake);
+}
+
+
+static void park_tail(shared_rb_t* rb, uint32_t observed, int32_t timeout_ms)
+{
+  if (rb->tail->load(std::memory_order_acquire) != observed) return;
+  WaitForSingleObject(rb->space, timeout_ms < 0 ? INFINITE : static_cast<DWORD>(timeout_ms));
+}
+
+
+static void wake_tail(shared_rb_t* rb)
+{
+  SetEvent(rb->space);
+}
+
+
+/*
+ * Maps a mirrored view of the given file mapping.
+ *
+ * Steps:
+ *   - Reserve one placeholder for header + 2 * capacity
+ *   - Split it into [header][buffer][buffer]
+ *   - Replace the header placeholder with the header view (offset 0)
+ *   - Replace both buffer placeholders with views of the same payload
+ *     (offset = header size)
+ */
+static bool map_mirrored(shared_rb_t* rb, uint32_t capacity)
+{
+  const size_t header = mirror_granularity();
+  const size_t total = header + 2 * static_cast<size_t>(capacity);
+
+  auto* base = static_cast<uint8_t*>(VirtualAlloc2(
+    nullptr, nullptr, total, MEM_RESERVE | MEM_RESERVE_PLACEHOLDER,
+    PAGE_NOACCESS, nullptr, 0));
+  if (!base) return false;
+
+  uint8_t* first = base + header;
+  uint8_t* second = first + capacity;
+
+  // Split into three placeholders
+  if (!VirtualFree(base, header, MEM_RELEASE | MEM_PRESERVE_PLACEHOLDER))
+  {
+    VirtualFree(base, 0, MEM_RELEASE);
+    return false;
+  }
+  if (!VirtualFree(first, capacity, MEM_RELEASE | MEM_PRESERVE_PLACEHOLDER))
+  {
+    // Header and [buffer][buffer] are separate placeholders by now
+    VirtualFree(base, 0, MEM_RELEASE);
+    VirtualFree(first, 0, MEM_RELEASE);
+    return false;
+  }
+
+  void* views[3] =
+  {
+    MapViewOfFile3(rb->mapping, nullptr, base, 0, header,
+      MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0),
+    MapViewOfFile3(rb->mapping, nullptr, first, header, capacity,
+      MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0),
+    MapViewOfFile3(rb->mapping, nullptr, second, header, capacity,
+      MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0),
+  };
+  uint8_t* places[3] = { base, first, second };
+
+  if (!views[0] || !views[1] || !views[2])
+  {
+    // Unmap what was mapped, release the remaining placeholders
+    for (int i = 0; i < 3; i++)
+    {
+      if (views[i]) UnmapViewOfFile(views[i]);
+      else VirtualFree(places[i], 0, MEM_RELEASE);
+    }
+    return false;
+  }
+
+  bind_header(rb, base);
+  rb->buffer = first;
+  rb->capacity = capacity;
+  rb->mirrored = true;
+  return true;
+}
+
+
+/*
+ * Maps header + payload as one view.
+ */
+static bool map_plain(shared_rb_t* rb, uint32_t capacity)
+{
+  const size_t totalSize = sizeof(shared_rb_header_t) + static_cast<size_t>(capacity);
+
+  uint8_t* base = static_cast<uint8_t*>(
+    MapViewOfFile(rb->mapping, FILE_MAP_ALL_ACCESS, 0, 0, totalSize));
+  if (!base) return false;
+
+  // Assign pointers into the shared memory layout
+  bind_header(rb, base);
+  rb->buffer = base + sizeof(shared_rb_header_t);
+  rb->capacity = capacity;
+  return true;
+}
+
+
 /*
- * Computes the total size of the shared memory region.
- * Includes head + tail + payload buffer.
+ * Maps only the header of an existing region and validates it
+ * (see read_header). The region size reported by VirtualQuery is
+ * rounded up to whole pages, so the header is the only reliable
+ * source for the capacity.
+ */
+static bool probe_header(shared_rb_t* rb)
+{
+  auto* h = static_cast<const shared_rb_header_t*>(
+    MapViewOfFile(rb->mapping, FILE_MAP_READ, 0, 0, sizeof(shared_rb_header_t)));
+  if (!h) return false;
+
+  const bool ok = read_header(rb, h);
+  UnmapViewOfFile(h);
+  return ok;
+}
+
+
+/*
+ * Applies SHARED_RB_PREFAULT / SHARED_RB_LOCK to every view.
+ *
+ * Notes:
+ *   - Pre-faulting reads one byte per page, so data already in the ring
+ *     is left untouched
+ *   - VirtualLock is limited by the minimum working set, which is grown
+ *     by the locked size first; failure is not fatal (see granted)
  */
-static size_t calc_total_size(uint32_t capacity)
+static void apply_options(shared_rb_t* rb, uint32_t flags)
 {
-  return sizeof(uint32_t) * 2 + capacity;
+  SYSTEM_INFO info{};
+  GetSystemInfo(&info);
+
+  uint8_t* base = reinterpret_cast<uint8_t*>(rb->header);
+  const size_t header = payload_offset(rb->mirrored);
+
+  struct { uint8_t* at; size_t size; } views[3] =
+  {
+    { base, header + (rb->mirrored ? 0 : rb->capacity) },
+    { rb->mirrored ? rb->buffer : nullptr, rb->capacity },
+    { rb->mirrored ? rb->buffer + rb->capacity : nullptr, rb->capacity },
+  };
+
+  if (flags & SHARED_RB_LOCK)
+  {
+    SIZE_T minimum = 0, maximum = 0;
+    const size_t locked = views[0].size + (rb->mirrored ? 2 * static_cast<size_t>(rb->capacity) : 0);
+    if (GetProcessWorkingSetSize(GetCurrentProcess(), &minimum, &maximum))
+      SetProcessWorkingSetSize(GetCurrentProcess(), minimum + locked, maximum + locked);
+
+    bool ok = true;
+    for (auto& v : views)
+      if (v.at && !VirtualLock(v.at, v.size))
+        ok = false;
+    if (ok)
+      rb->granted |= SHARED_RB_LOCK;
+  }
+
+  if (flags & SHARED_RB_PREFAULT)
+  {
+    for (auto& v : views)
+      for (size_t offset = 0; v.at && offset < v.size; offset += info.dwPageSize)
+        (void)reinterpret_cast<volatile uint8_t*>(v.at)[offset];
+    rb->granted |= SHARED_RB_PREFAULT;
+  }
 }
 
 
 /*
- * Creates a new shared-memory ring buffer.
+ * Creates a new shared-memory ring buffer (Windows backend).
  *
  * Steps:
- *   - Allocate a file mapping (backed by system paging file)
- *   - Map the entire region into the process
+ *   - Allocate a file mapping (backed by system paging file); an
+ *     existing mapping of that name is never reused (a live peer owns it)
+ *   - Map it as one view, or with the payload twice back to back
+ *     (SHARED_RB_MIRRORED, see map_mirrored)
  *   - Initialize head and tail to zero
+ *   - Create the wake event
+ *   - Apply the prefault/lock options
  */
-EXP32 shared_rb_t* shared_rb_create(const char* name, uint32_t capacity)
+EXP32 shared_rb_t* shared_rb_create_ex(const char* name, uint32_t capacity, uint32_t flags)
 {
+  const bool mirrored = (flags & SHARED_RB_MIRRORED) != 0;
+  if (mirrored)
+  {
+    capacity = mirror_capacity(capacity);
+    if (!capacity) return nullptr;
+  }
+
   auto* rb = new shared_rb_t();
-  rb->capacity = capacity;
+  rb->framed = (flags & SHARED_RB_FRAMED) != 0;
 
-  const size_t totalSize = calc_total_size(capacity);
+  const uint64_t totalSize = payload_offset(mirrored) + static_cast<uint64_t>(capacity);
 
   // Create a new shared memory region
   rb->mapping = CreateFileMappingA(
     INVALID_HANDLE_VALUE,   // Use system paging file
     nullptr,
     PAGE_READWRITE,
-    0,
+    static_cast<DWORD>(totalSize >> 32),
     static_cast<DWORD>(totalSize),
     name);
 
@@ -64,41 +518,46 @@ EXP32 shared_rb_t* shared_rb_create(const char* name, uint32_t capacity)
     delete rb;
     return nullptr;
   }
+  if (GetLastError() == ERROR_ALREADY_EXISTS)
+  {
+    CloseHandle(rb->mapping);
+    delete rb;
+    return nullptr;
+  }
 
   // Map the region into this process
-  uint8_t* base = static_cast<uint8_t*>(
-    MapViewOfFile(rb->mapping, FILE_MAP_ALL_ACCESS, 0, 0, totalSize));
-
-  if (!base)
+  if (!(mirrored ? map_mirrored(rb, capacity) : map_plain(rb, capacity)))
   {
     CloseHandle(rb->mapping);
     delete rb;
     return nullptr;
   }
 
-  // Assign pointers into the shared memory layout
-  rb->head = reinterpret_cast<std::atomic<uint32_t>*>(base);
-  rb->tail = reinterpret_cast<std::atomic<uint32_t>*>(base + sizeof(uint32_t));
-  rb->buffer = base + sizeof(uint32_t) * 2;
+  if (!open_wake_event(rb, name))
+  {
+    shared_rb_close(rb);
+    return nullptr;
+  }
 
-  // Initialize indices
-  rb->head->store(0, std::memory_order_relaxed);
-  rb->tail->store(0, std::memory_order_relaxed);
+  // Publish the descriptor, initialize indices
+  init_header(rb);
 
+  apply_options(rb, flags);
   return rb;
 }
 
 
 /*
- * Opens an existing shared-memory ring buffer.
+ * Opens an existing shared-memory ring buffer (Windows backend).
  *
  * Steps:
  *   - Open the file mapping by name
- *   - Map the entire region (size unknown at compile time)
- *   - Query the region size using VirtualQuery
- *   - Derive capacity from total size
+ *   - Validate the header and take capacity and layout from it
+ *   - Map exactly what the creator mapped (plain or mirrored)
+ *   - Open the wake event
+ *   - Apply the prefault/lock options
  */
-EXP32 shared_rb_t* shared_rb_open(const char* name)
+EXP32 shared_rb_t* shared_rb_open_ex(const char* name, uint32_t, uint32_t flags)
 {
   auto* rb = new shared_rb_t();
 
@@ -109,28 +568,21 @@ EXP32 shared_rb_t* shared_rb_open(const char* name)
     return nullptr;
   }
 
-  // Map the entire region (size = 0 means "map all")
-  uint8_t* base = static_cast<uint8_t*>(
-    MapViewOfFile(rb->mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0));
-
-  if (!base)
+  if (!probe_header(rb)
+    || !(rb->mirrored ? map_mirrored(rb, rb->capacity) : map_plain(rb, rb->capacity)))
   {
     CloseHandle(rb->mapping);
     delete rb;
     return nullptr;
   }
 
-  rb->head = reinterpret_cast<std::atomic<uint32_t>*>(base);
-  rb->tail = reinterpret_cast<std::atomic<uint32_t>*>(base + sizeof(uint32_t));
-
-  // Query the mapped region to determine its total size
-  MEMORY_BASIC_INFORMATION mbi{};
-  VirtualQuery(base, &mbi, sizeof(mbi));
-
-  const size_t totalSize = mbi.RegionSize;
-  rb->capacity = static_cast<uint32_t>(totalSize - sizeof(uint32_t) * 2);
-  rb->buffer = base + sizeof(uint32_t) * 2;
+  if (!open_wake_event(rb, name))
+  {
+    shared_rb_close(rb);
+    return nullptr;
+  }
 
+  apply_options(rb, flags);
   return rb;
 }
 
@@ -139,92 +591,1143 @@ EXP32 shared_rb_t* shared_rb_open(const char* name)
  * Closes a shared ring buffer.
  *
  * Steps:
- *   - Unmap the shared memory view
- *   - Close the file mapping handle
+ *   - Unmap the shared memory view(s)
+ *   - Close the file mapping and event handles
  *   - Free the wrapper structure
  */
 EXP32 void shared_rb_close(shared_rb_t* rb)
 {
   if (!rb) return;
 
-  if (rb->head)
-    UnmapViewOfFile(rb->head);
+  if (rb->mirrored)
+  {
+    // Header view + both payload views
+    UnmapViewOfFile(rb->buffer);
+    UnmapViewOfFile(rb->buffer + rb->capacity);
+  }
+
+  if (rb->header)
+    UnmapViewOfFile(rb->header);
 
   if (rb->mapping)
     CloseHandle(rb->mapping);
 
+  if (rb->wake)
+    CloseHandle(rb->wake);
+
+  if (rb->space)
+    CloseHandle(rb->space);
+
   delete rb;
 }
 
+#endif
+
+
+#if SHARED_RB_POSIX
 
 /*
- * Writes data into the ring buffer.
- *
- * Behavior:
- *   - Lock-free single-producer logic
- *   - Computes available space
- *   - Writes as much as possible (may be less than requested)
- *   - Handles wrap-around in two memcpy operations
+ * Returns the size of the header area of a mirrored ring buffer.
+ * mmap offsets must be multiples of the page size.
  */
-EXP32 uint32_t shared_rb_write(shared_rb_t* rb, const uint8_t* data, uint32_t length)
+static size_t mirror_granularity()
 {
-  const uint32_t head = rb->head->load(std::memory_order_acquire);
-  const uint32_t tail = rb->tail->load(std::memory_order_acquire);
+  return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
 
-  const uint32_t used = head - tail;
-  const uint32_t free = rb->capacity - used;
 
-  // Clamp to available space
-  if (length > free)
-    length = free;
+/*
+ * POSIX shm names must start with a single '/'.
+ * Windows-style names ("SidecarRB") are accepted and prefixed.
+ */
+static std::string shm_name(const char* name)
+{
+  return name[0] == '/' ? std::string(name) : "/" + std::string(name);
+}
 
-  const uint32_t pos = head % rb->capacity;
-  uint32_t first = rb->capacity - pos;
-  if (first > length) first = length;
 
-  // Write first segment
-  std::memcpy(rb->buffer + pos, data, first);
+/*
+ * Parks on head with a shared (non-private) futex: the word lives in a
+ * MAP_SHARED mapping, so the kernel keys the wait on the physical page
+ * and a FUTEX_WAKE from the host process reaches the sidecar.
+ */
+static void futex_park(std::atomic<uint32_t>* word, uint32_t observed, int32_t timeout_ms)
+{
+  timespec ts{};
+  ts.tv_sec = timeout_ms / 1000;
+  ts.tv_nsec = static_cast<long>(timeout_ms % 1000) * 1000000L;
 
-  // Write second segment (wrap-around)
-  std::memcpy(rb->buffer, data + first, length - first);
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT,
+    observed, timeout_ms < 0 ? nullptr : &ts, nullptr, 0);
+}
 
-  // Publish new head index
-  rb->head->store(head + length, std::memory_order_release);
-  return length;
+
+static void futex_wake(std::atomic<uint32_t>* word)
+{
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE,
+    INT32_MAX, nullptr, nullptr, 0);
+}
+
+
+static void wake_head(shared_rb_t* rb)
+{
+  futex_wake(rb->head);
 }
 
 
+// Longest park on the first ring when the kernel lacks futex_waitv.
+constexpr int32_t WAIT_ANY_FALLBACK_MS = 1;
+
 /*
- * Reads data from the ring buffer.
- *
- * Behavior:
- *   - Lock-free single-consumer logic
- *   - Computes available data
- *   - Reads as much as possible (may be less than requested)
- *   - Handles wrap-around in two memcpy operations
+ * Parks on the head and notified words of all rings with one
+ * futex_waitv call (Linux 5.16+): a FUTEX_WAKE on any of them ends the
+ * wait, and a notify raised before the call makes it return at once.
+ * The timeout of futex_waitv is absolute. Without the syscall it parks
+ * on the first ring only, briefly, so the others are re-checked at that
+ * rate.
  */
-EXP32 uint32_t shared_rb_read(shared_rb_t* rb, uint8_t* dest, uint32_t length)
+static bool park_any(shared_rb_t* const* rbs, const uint32_t* observed, uint32_t count, int32_t timeout_ms)
 {
-  const uint32_t head = rb->head->load(std::memory_order_acquire);
-  const uint32_t tail = rb->tail->load(std::memory_order_acquire);
+#if defined(SYS_futex_waitv)
+  futex_waitv waiters[2 * SHARED_RB_WAIT_ANY_MAX]{};
+  for (uint32_t i = 0; i < count; i++)
+  {
+    waiters[i].val = observed[i];
+    waiters[i].uaddr = reinterpret_cast<uintptr_t>(rbs[i]->head);
+    waiters[i].flags = FUTEX_32;      // Shared: no FUTEX_PRIVATE_FLAG
 
-  const uint32_t used = head - tail;
+    // notified is process-local, but shared like futex_wake, so the keys match
+    waiters[count + i].val = rbs[i]->notified_seen;
+    waiters[count + i].uaddr = reinterpret_cast<uintptr_t>(&rbs[i]->notified);
+    waiters[count + i].flags = FUTEX_32;
+  }
 
-  // Clamp to available data
-  if (length > used)
-    length = used;
+  timespec deadline{};
+  if (timeout_ms >= 0)
+  {
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += static_cast<long>(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+  }
 
-  const uint32_t pos = tail % rb->capacity;
-  uint32_t first = rb->capacity - pos;
-  if (first > length) first = length;
+  if (syscall(SYS_futex_waitv, waiters, 2 * count, 0, timeout_ms < 0 ? nullptr : &deadline,
+    CLOCK_MONOTONIC) >= 0 || errno != ENOSYS)
+    return true;
+#endif
 
-  // Read first segment
-  std::memcpy(dest, rb->buffer + pos, first);
+  futex_park(rbs[0]->head, observed[0],
+    timeout_ms < 0 || timeout_ms > WAIT_ANY_FALLBACK_MS ? WAIT_ANY_FALLBACK_MS : timeout_ms);
+  return false;
+}
+
+
+static void wake_notify(shared_rb_t* rb)
+{
+  futex_wake(&rb->notified);
+  futex_wake(rb->head);
+}
+
+
+static void park_tail(shared_rb_t* rb, uint32_t observed, int32_t timeout_ms)
+{
+  futex_park(rb->tail, observed, timeout_ms);
+}
+
+
+static void wake_tail(shared_rb_t* rb)
+{
+  futex_wake(rb->tail);
+}
+
+
+/*
+ * Maps the shm object and assigns the layout pointers.
+ *
+ * Plain layout:    [header][buffer]  (one MAP_SHARED view)
+ * Mirrored layout: [header page][buffer][buffer again]
+ *   - Reserve header + 2 * capacity of address space (PROT_NONE)
+ *   - MAP_FIXED the header (offset 0) and the payload (offset = page
+ *     size) twice over the reservation
+ *
+ * SHARED_RB_PREFAULT adds MAP_POPULATE to every view, so the page
+ * tables are filled before the first write.
+ */
+static bool map_region(shared_rb_t* rb, uint32_t flags)
+{
+  const int populate = (flags & SHARED_RB_PREFAULT) ? MAP_POPULATE : 0;
+
+  if (!rb->mirrored)
+  {
+    const size_t totalSize = sizeof(shared_rb_header_t) + static_cast<size_t>(rb->capacity);
+
+    void* base = mmap(nullptr, totalSize, PROT_READ | PROT_WRITE,
+      MAP_SHARED | populate, rb->fd, 0);
+    if (base == MAP_FAILED) return false;
+
+    rb->base = static_cast<uint8_t*>(base);
+    rb->mapped = totalSize;
+    rb->buffer = rb->base + sizeof(shared_rb_header_t);
+  }
+  else
+  {
+    const size_t header = mirror_granularity();
+    const size_t total = header + 2 * static_cast<size_t>(rb->capacity);
+
+    void* base = mmap(nullptr, total, PROT_NONE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) return false;
+
+    auto* at = static_cast<uint8_t*>(base);
+    const int shared = MAP_SHARED | MAP_FIXED | populate;
+
+    if (mmap(at, header, PROT_READ | PROT_WRITE, shared, rb->fd, 0) == MAP_FAILED
+      || mmap(at + header, rb->capacity, PROT_READ | PROT_WRITE, shared, rb->fd, header) == MAP_FAILED
+      || mmap(at + header + rb->capacity, rb->capacity, PROT_READ | PROT_WRITE, shared, rb->fd, header) == MAP_FAILED)
+    {
+      munmap(base, total);
+      return false;
+    }
+
+    rb->base = at;
+    rb->mapped = total;
+    rb->buffer = at + header;
+  }
+
+  bind_header(rb, rb->base);
+
+  if (populate)
+    rb->granted |= SHARED_RB_PREFAULT;
+
+  // Pin the pages; fails without CAP_IPC_LOCK beyond RLIMIT_MEMLOCK
+  if ((flags & SHARED_RB_LOCK) && mlock(rb->base, rb->mapped) == 0)
+    rb->granted |= SHARED_RB_LOCK;
+
+  return true;
+}
+
+
+/*
+ * Creates a new shared-memory ring buffer (POSIX backend).
+ *
+ * Steps:
+ *   - shm_open the object (O_CREAT | O_EXCL: an existing object of that
+ *     name is never reset under a live peer) and size it with ftruncate
+ *   - Map it (see map_region)
+ *   - Initialize head and tail to zero
+ *
+ * Notes:
+ *   - The creator owns the name: shared_rb_close unlinks it, which
+ *     matches the lifetime of a Windows named mapping closely enough
+ *     for a host that outlives its sidecar
+ */
+EXP32 shared_rb_t* shared_rb_create_ex(const char* name, uint32_t capacity, uint32_t flags)
+{
+  const bool mirrored = (flags & SHARED_RB_MIRRORED) != 0;
+  if (mirrored)
+  {
+    capacity = mirror_capacity(capacity);
+    if (!capacity) return nullptr;
+  }
+
+  auto* rb = new shared_rb_t();
+  rb->name = shm_name(name);
+  rb->capacity = capacity;
+  rb->mirrored = mirrored;
+  rb->framed = (flags & SHARED_RB_FRAMED) != 0;
+
+  const size_t totalSize = payload_offset(mirrored) + capacity;
+
+  rb->fd = shm_open(rb->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (rb->fd < 0)
+  {
+    delete rb;
+    return nullptr;
+  }
+  rb->owner = true;
+
+  if (ftruncate(rb->fd, static_cast<off_t>(totalSize)) != 0
+    || !map_region(rb, flags))
+  {
+    close(rb->fd);
+    shm_unlink(rb->name.c_str());
+    delete rb;
+    return nullptr;
+  }
+
+  // Publish the descriptor, initialize indices
+  init_header(rb);
 
-  // Read second segment (wrap-around)
+  return rb;
+}
+
+
+/*
+ * Opens an existing shared-memory ring buffer (POSIX backend).
+ *
+ * Steps:
+ *   - shm_open the object without O_CREAT
+ *   - Map the header alone, validate it and take capacity and layout
+ *     from it (see read_header)
+ *   - Check that the object is large enough, then map exactly what the
+ *     creator mapped (see map_region)
+ */
+EXP32 shared_rb_t* shared_rb_open_ex(const char* name, uint32_t, uint32_t flags)
+{
+  auto* rb = new shared_rb_t();
+  rb->name = shm_name(name);
+
+  rb->fd = shm_open(rb->name.c_str(), O_RDWR, 0);
+  if (rb->fd < 0)
+  {
+    delete rb;
+    return nullptr;
+  }
+
+  struct stat st{};
+  bool ok = fstat(rb->fd, &st) == 0
+    && static_cast<size_t>(st.st_size) >= sizeof(shared_rb_header_t);
+
+  if (ok)
+  {
+    void* h = mmap(nullptr, sizeof(shared_rb_header_t), PROT_READ, MAP_SHARED, rb->fd, 0);
+    ok = h != MAP_FAILED && read_header(rb, static_cast<const shared_rb_header_t*>(h));
+    if (h != MAP_FAILED)
+      munmap(h, sizeof(shared_rb_header_t));
+  }
+
+  ok = ok && static_cast<size_t>(st.st_size) >= payload_offset(rb->mirrored) + rb->capacity;
+
+  if (!ok || !map_region(rb, flags))
+  {
+    close(rb->fd);
+    delete rb;
+    return nullptr;
+  }
+
+  return rb;
+}
+
+
+/*
+ * Closes a shared ring buffer (POSIX backend).
+ *
+ * Steps:
+ *   - Unmap the whole mapping (all views of a mirrored ring at once)
+ *   - Close the descriptor
+ *   - Unlink the name if this side created it
+ */
+EXP32 void shared_rb_close(shared_rb_t* rb)
+{
+  if (!rb) return;
+
+  if (rb->base)
+    munmap(rb->base, rb->mapped);
+
+  if (rb->fd >= 0)
+    close(rb->fd);
+
+  if (rb->owner)
+    shm_unlink(rb->name.c_str());
+
+  delete rb;
+}
+
+#endif
+
+
+/*
+ * Creates a new shared-memory ring buffer with default options.
+ */
+EXP32 shared_rb_t* shared_rb_create(const char* name, uint32_t capacity)
+{
+  return shared_rb_create_ex(name, capacity, SHARED_RB_DEFAULT);
+}
+
+
+/*
+ * Opens an existing shared-memory ring buffer with default options.
+ * Capacity and layout (plain or mirrored) come from the header.
+ */
+EXP32 shared_rb_t* shared_rb_open(const char* name)
+{
+  return shared_rb_open_ex(name, 0, SHARED_RB_DEFAULT);
+}
+
+
+/*
+ * Creates a new mirrored shared-memory ring buffer.
+ */
+EXP32 shared_rb_t* shared_rb_create_mirrored(const char* name, uint32_t capacity)
+{
+  return shared_rb_create_ex(name, capacity, SHARED_RB_MIRRORED);
+}
+
+
+/*
+ * Returns the options actually applied (shared_rb_flags_t).
+ */
+EXP32 uint32_t shared_rb_granted(shared_rb_t* rb)
+{
+  return rb->granted
+    | (rb->mirrored ? uint32_t{ SHARED_RB_MIRRORED } : 0u)
+    | (rb->framed ? uint32_t{ SHARED_RB_FRAMED } : 0u);
+}
+
+
+/*
+ * Returns the payload capacity in bytes.
+ */
+EXP32 uint32_t shared_rb_capacity(shared_rb_t* rb)
+{
+  return rb->capacity;
+}
+
+
+/*
+ * Adds to a statistics counter. Every counter line has a single writer,
+ * so a relaxed load + store suffices (no locked read-modify-write).
+ */
+static inline void stat_add(uint64_t& counter, uint64_t value)
+{
+  std::atomic_ref<uint64_t> c(counter);
+  c.store(c.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+
+/*
+ * Counts one producer call that published written bytes (messages
+ * units) on top of used bytes. truncated: it wanted to write more.
+ */
+static void count_write(shared_rb_t* rb, uint32_t used, uint32_t messages, uint32_t written, bool truncated)
+{
+  shared_rb_stats_t& s = rb->header->stats;
+  if (written == 0)
+  {
+    if (truncated) stat_add(s.full_rejections, 1);
+    return;
+  }
+
+  stat_add(s.messages_written, messages);
+  stat_add(s.bytes_written, written);
+  if (truncated) stat_add(s.partial_writes, 1);
+
+  std::atomic_ref<uint64_t> high(s.high_water);
+  if (used + written > high.load(std::memory_order_relaxed))
+    high.store(used + written, std::memory_order_relaxed);
+}
+
+
+/*
+ * Counts one consumer call that took bytes out of the ring.
+ */
+static void count_read(shared_rb_t* rb, uint32_t bytes)
+{
+  if (bytes == 0) return;
+  stat_add(rb->header->stats.messages_read, 1);
+  stat_add(rb->header->stats.bytes_read, bytes);
+}
+
+
+/*
+ * Returns the statistics block inside the mapped header.
+ */
+EXP32 const shared_rb_stats_t* shared_rb_stats(shared_rb_t* rb)
+{
+  return &rb->header->stats;
+}
+
+
+/*
+ * Adds dispatcher callbacks to the consumer line.
+ */
+EXP32 void shared_rb_stats_add_process(shared_rb_t* rb, uint32_t calls, uint64_t ns)
+{
+  stat_add(rb->header->stats.process_calls, calls);
+  stat_add(rb->header->stats.process_ns, ns);
+}
+
+
+/*
+ * Hints the CPU that the caller is spinning (pause / yield instruction).
+ */
+static inline void cpu_relax()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(_M_ARM64)
+  __yield();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+
+/*
+ * Takes a pending shared_rb_notify of this handle (consumer side only).
+ */
+static bool take_notify(shared_rb_t* rb)
+{
+  const uint32_t notified = rb->notified.load(std::memory_order_acquire);
+  if (notified == rb->notified_seen) return false;
+  rb->notified_seen = notified;
+  return true;
+}
+
+
+/*
+ * Publishes a new head and wakes a parked consumer.
+ *
+ * The fence orders the head store before the read_waiters check and
+ * pairs with the fence in shared_rb_wait_readable: a consumer that is
+ * about to park either sees the new head or is seen here. While the
+ * consumer is running or spinning the write costs no syscall.
+ */
+static void publish_head(shared_rb_t* rb, uint32_t head)
+{
+  rb->head->store(head, std::memory_order_release);
+
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (rb->header->read_waiters.load(std::memory_order_relaxed))
+    wake_head(rb);
+}
+
+
+/*
+ * Publishes a new tail and wakes a parked producer (mirror image of
+ * publish_head, paired with the fence in shared_rb_wait_writable).
+ */
+static void publish_tail(shared_rb_t* rb, uint32_t tail)
+{
+  rb->tail->store(tail, std::memory_order_release);
+
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (rb->header->write_waiters.load(std::memory_order_relaxed))
+    wake_tail(rb);
+}
+
+
+/*
+ * Sets the spin and yield phases of the wait calls.
+ */
+EXP32 void shared_rb_set_wait_strategy(shared_rb_t* rb, uint32_t spins, uint32_t yields)
+{
+  rb->wait_spins = spins;
+  rb->wait_yields = yields;
+}
+
+
+/*
+ * Waits until available() reaches min_bytes (shared by both wait calls).
+ *
+ * Steps:
+ *   - Spin up to wait_spins iterations with a pause instruction
+ *   - Yield the time slice up to wait_yields times
+ *   - Register in waiters and park on word until the other side
+ *     publishes it (see publish_head / publish_tail) or the timeout
+ *     expires; every park is counted in sleeps
+ *   - notifiable: a pending shared_rb_notify, or a wakeup that left
+ *     word unchanged (a notify through another handle, or a spurious
+ *     one), ends the wait, so the caller re-checks its own state (e.g.
+ *     a stop flag) instead of parking again. park returns false if it
+ *     only polled
+ */
+template <typename TAvailable, typename TPark>
+static uint32_t wait_for(shared_rb_t* rb, uint32_t min_bytes, int32_t timeout_ms,
+  std::atomic<uint32_t>* word, std::atomic<uint32_t>& waiters, uint64_t& sleeps,
+  bool notifiable, TAvailable available, TPark park)
+{
+  const auto notified = [rb, notifiable] { return notifiable && take_notify(rb); };
+
+  // Phase 1: bounded spin
+  uint32_t avail = available();
+  for (uint32_t i = 0; i < rb->wait_spins && avail < min_bytes; i++)
+  {
+    if (notified()) return 0;
+    cpu_relax();
+    avail = available();
+  }
+
+  // Phase 2: yield
+  for (uint32_t i = 0; i < rb->wait_yields && avail < min_bytes; i++)
+  {
+    if (notified()) return 0;
+    std::this_thread::yield();
+    avail = available();
+  }
+
+  if (avail >= min_bytes) return avail;
+  if (timeout_ms == 0 || notified()) return 0;
+
+  // Phase 3: park
+  const auto deadline = std::chrono::steady_clock::now() +
+    std::chrono::milliseconds(timeout_ms < 0 ? INT32_MAX : timeout_ms);
+
+  waiters.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  for (;;)
+  {
+    const uint32_t observed = word->load(std::memory_order_acquire);
+
+    avail = available();
+    if (avail >= min_bytes) break;
+
+    const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+      deadline - std::chrono::steady_clock::now()).count();
+    if (remaining <= 0)
+    {
+      avail = 0;
+      break;
+    }
+
+    stat_add(sleeps, 1);
+    if (park(observed, timeout_ms < 0 ? -1 : static_cast<int32_t>(remaining)) &&
+      notifiable && word->load(std::memory_order_acquire) == observed)
+    {
+      take_notify(rb);
+      avail = available();
+      if (avail < min_bytes) avail = 0;
+      break;
+    }
+  }
+
+  waiters.fetch_sub(1, std::memory_order_relaxed);
+  return avail;
+}
+
+
+/*
+ * Waits until at least min_bytes are readable (see wait_for).
+ * A call that does not find enough data right away is an empty poll.
+ */
+EXP32 uint32_t shared_rb_wait_readable(shared_rb_t* rb, uint32_t min_bytes, int32_t timeout_ms)
+{
+  if (min_bytes == 0) min_bytes = 1;
+  if (min_bytes > rb->capacity) return 0;
+
+  shared_rb_header_t* h = rb->header;
+  const uint32_t avail = shared_rb_available_to_read(rb);
+  if (avail >= min_bytes) return avail;
+
+  stat_add(h->stats.empty_polls, 1);
+  return wait_for(rb, min_bytes, timeout_ms, rb->head, h->read_waiters, h->stats.sleeps, true,
+    [rb] { return shared_rb_available_to_read(rb); },
+    [rb](uint32_t observed, int32_t ms) { return park_any(&rb, &observed, 1, ms); });
+}
+
+
+/*
+ * Waits until at least min_bytes are writable (see wait_for).
+ */
+EXP32 uint32_t shared_rb_wait_writable(shared_rb_t* rb, uint32_t min_bytes, int32_t timeout_ms)
+{
+  if (min_bytes == 0) min_bytes = 1;
+  if (min_bytes > rb->capacity) return 0;
+
+  shared_rb_header_t* h = rb->header;
+  return wait_for(rb, min_bytes, timeout_ms, rb->tail, h->write_waiters, h->stats.write_sleeps, false,
+    [rb] { return shared_rb_available_to_write(rb); },
+    [rb](uint32_t observed, int32_t ms) { park_tail(rb, observed, ms); return true; });
+}
+
+
+/*
+ * Waits until one of several rings is readable. Same phases as
+ * wait_for, but the park registers in read_waiters of every ring, so
+ * whichever producer publishes first wakes the consumer.
+ */
+EXP32 int32_t shared_rb_wait_any(shared_rb_t* const* rbs, uint32_t count, int32_t timeout_ms)
+{
+  if (!rbs || count == 0 || count > SHARED_RB_WAIT_ANY_MAX) return -1;
+
+  const auto ready = [rbs, count]() -> int32_t
+  {
+    for (uint32_t i = 0; i < count; i++)
+      if (shared_rb_available_to_read(rbs[i])) return static_cast<int32_t>(i);
+    return -1;
+  };
+
+  const auto notified = [rbs, count]
+  {
+    bool any = false;
+    for (uint32_t i = 0; i < count; i++)
+      any = take_notify(rbs[i]) || any;
+    return any;
+  };
+
+  int32_t index = ready();
+  if (index >= 0) return index;
+
+  for (uint32_t i = 0; i < count; i++)
+    stat_add(rbs[i]->header->stats.empty_polls, 1);
+
+  // Phase 1 + 2: spin and yield with the strategy of the first ring
+  for (uint32_t i = 0; i < rbs[0]->wait_spins && index < 0; i++)
+  {
+    if (notified()) return -1;
+    cpu_relax();
+    index = ready();
+  }
+
+  for (uint32_t i = 0; i < rbs[0]->wait_yields && index < 0; i++)
+  {
+    if (notified()) return -1;
+    std::this_thread::yield();
+    index = ready();
+  }
+
+  if (index >= 0 || timeout_ms == 0 || notified()) return index;
+
+  // Phase 3: park on every ring
+  const auto deadline = std::chrono::steady_clock::now() +
+    std::chrono::milliseconds(timeout_ms < 0 ? INT32_MAX : timeout_ms);
+
+  for (uint32_t i = 0; i < count; i++)
+    rbs[i]->header->read_waiters.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  uint32_t observed[SHARED_RB_WAIT_ANY_MAX];
+  for (;;)
+  {
+    for (uint32_t i = 0; i < count; i++)
+      observed[i] = rbs[i]->head->load(std::memory_order_acquire);
+
+    index = ready();
+    if (index >= 0) break;
+
+    const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+      deadline - std::chrono::steady_clock::now()).count();
+    if (remaining <= 0) break;
+
+    for (uint32_t i = 0; i < count; i++)
+      stat_add(rbs[i]->header->stats.sleeps, 1);
+    if (!park_any(rbs, observed, count, timeout_ms < 0 ? -1 : static_cast<int32_t>(remaining)))
+      continue;
+
+    // No head moved: shared_rb_notify (or a spurious wakeup) ends the wait
+    bool moved = false;
+    for (uint32_t i = 0; i < count && !moved; i++)
+      moved = rbs[i]->head->load(std::memory_order_acquire) != observed[i];
+    if (!moved)
+    {
+      notified();
+      index = ready();
+      break;
+    }
+  }
+
+  for (uint32_t i = 0; i < count; i++)
+    rbs[i]->header->read_waiters.fetch_sub(1, std::memory_order_relaxed);
+  return index;
+}
+
+
+/*
+ * Wakes a consumer parked in shared_rb_wait_readable, regardless of
+ * the ring state (e.g. to make it re-check a stop flag). Raising
+ * notified first means a consumer still spinning, or about to park,
+ * sees it as well.
+ */
+EXP32 void shared_rb_notify(shared_rb_t* rb)
+{
+  rb->notified.fetch_add(1, std::memory_order_release);
+  wake_notify(rb);
+}
+
+
+/*
+ * Returns the number of bytes currently available to read.
+ */
+EXP32 uint32_t shared_rb_available_to_read(shared_rb_t* rb)
+{
+  const uint32_t head = rb->head->load(std::memory_order_acquire);
+  const uint32_t tail = rb->tail->load(std::memory_order_acquire);
+  return head - tail;
+}
+
+
+/*
+ * Returns the number of bytes currently available to write.
+ */
+EXP32 uint32_t shared_rb_available_to_write(shared_rb_t* rb)
+{
+  return rb->capacity - shared_rb_available_to_read(rb);
+}
+
+
+/*
+ * Copies length bytes into the payload at sequence index (wraps with two
+ * memcpy operations, or one for mirrored buffers). Does not publish.
+ */
+static void copy_in(shared_rb_t* rb, uint32_t index, const uint8_t* data, uint32_t length)
+{
+  const uint32_t pos = index % rb->capacity;
+  uint32_t first = rb->mirrored ? length : rb->capacity - pos;
+  if (first > length) first = length;
+
+  std::memcpy(rb->buffer + pos, data, first);
+  std::memcpy(rb->buffer, data + first, length - first);
+}
+
+
+/*
+ * Copies length bytes out of the payload at sequence index.
+ * Does not consume.
+ */
+static void copy_out(const shared_rb_t* rb, uint32_t index, uint8_t* dest, uint32_t length)
+{
+  const uint32_t pos = index % rb->capacity;
+  uint32_t first = rb->mirrored ? length : rb->capacity - pos;
+  if (first > length) first = length;
+
+  std::memcpy(dest, rb->buffer + pos, first);
   std::memcpy(dest + first, rb->buffer, length - first);
+}
+
+
+/*
+ * Writes data into the ring buffer.
+ *
+ * Behavior:
+ *   - Lock-free single-producer logic
+ *   - Computes available space
+ *   - Writes as much as possible (may be less than requested)
+ *   - Handles wrap-around in two memcpy operations
+ */
+EXP32 uint32_t shared_rb_write(shared_rb_t* rb, const uint8_t* data, uint32_t length)
+{
+  const uint32_t head = rb->head->load(std::memory_order_acquire);
+  const uint32_t tail = rb->tail->load(std::memory_order_acquire);
+
+  const uint32_t used = head - tail;
+  const uint32_t free = rb->capacity - used;
+
+  // Clamp to available space
+  const bool truncated = length > free;
+  if (truncated)
+    length = free;
+
+  // One memcpy for mirrored buffers, two across the wrap otherwise
+  copy_in(rb, head, data, length);
+
+  // Publish new head index, wake a parked consumer
+  publish_head(rb, head + length);
+  count_write(rb, used, 1, length, truncated);
+  return length;
+}
+
+
+/*
+ * Writes a batch of segments into the ring buffer.
+ *
+ * Behavior:
+ *   - All or nothing over the total length: a batch that does not fit
+ *     is rejected whole, never clamped (a clamped batch could publish a
+ *     record header without its payload)
+ *   - Copies the segments back to back (each may wrap)
+ *   - Publishes the new head once, so a reader never sees a prefix
+ *     of the batch
+ */
+EXP32 uint32_t shared_rb_writev(shared_rb_t* rb, const shared_rb_segment_t* segments, uint32_t count)
+{
+  const uint32_t head = rb->head->load(std::memory_order_acquire);
+  const uint32_t tail = rb->tail->load(std::memory_order_acquire);
+
+  const uint32_t used = head - tail;
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < count; i++)
+    total += segments[i].length;
+
+  if (total > rb->capacity - used)
+  {
+    count_write(rb, used, 1, 0, true);
+    return 0;
+  }
+
+  uint32_t written = 0;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    copy_in(rb, head + written, segments[i].data, segments[i].length);
+    written += segments[i].length;
+  }
+
+  // Publish the whole batch at once
+  publish_head(rb, head + written);
+  count_write(rb, used, 1, written, false);
+  return written;
+}
+
+
+/*
+ * Applies an all-or-nothing write policy to a message of length bytes.
+ *
+ * Behavior:
+ *   - Returns true if the message fits now, or after parking in
+ *     shared_rb_wait_writable (SHARED_RB_WRITE_BLOCK)
+ *   - Single producer: free space can only grow until the caller writes
+ *   - Otherwise counts a rejection (and a drop) and returns false
+ */
+static bool admit_write(shared_rb_t* rb, uint64_t length, uint32_t policy, int32_t timeout_ms)
+{
+  uint32_t free = shared_rb_available_to_write(rb);
+  if (length > free && policy == SHARED_RB_WRITE_BLOCK && length <= rb->capacity)
+    free = shared_rb_wait_writable(rb, static_cast<uint32_t>(length), timeout_ms);
+
+  if (length <= free) return true;
+
+  stat_add(rb->header->stats.full_rejections, 1);
+  if (policy == SHARED_RB_WRITE_DROP)
+    stat_add(rb->header->stats.dropped, 1);
+  return false;
+}
+
+
+/*
+ * Writes data according to a write policy (see admit_write).
+ */
+EXP32 uint32_t shared_rb_write_ex(shared_rb_t* rb, const uint8_t* data, uint32_t length,
+  uint32_t policy, int32_t timeout_ms)
+{
+  if (policy != SHARED_RB_WRITE_PARTIAL && !admit_write(rb, length, policy, timeout_ms))
+    return 0;
+
+  return shared_rb_write(rb, data, length);
+}
+
+
+/*
+ * Writes a batch of segments according to a write policy; the policy
+ * applies to the total length. shared_rb_writev never splits a batch,
+ * so SHARED_RB_WRITE_PARTIAL writes all of it or nothing as well.
+ */
+EXP32 uint32_t shared_rb_writev_ex(shared_rb_t* rb, const shared_rb_segment_t* segments, uint32_t count,
+  uint32_t policy, int32_t timeout_ms)
+{
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < count; i++)
+    total += segments[i].length;
+
+  if (policy != SHARED_RB_WRITE_PARTIAL && !admit_write(rb, total, policy, timeout_ms))
+    return 0;
+
+  return shared_rb_writev(rb, segments, count);
+}
+
+
+/*
+ * Reads data from the ring buffer.
+ *
+ * Behavior:
+ *   - Lock-free single-consumer logic
+ *   - Computes available data
+ *   - Reads as much as possible (may be less than requested)
+ *   - Handles wrap-around in two memcpy operations
+ */
+EXP32 uint32_t shared_rb_read(shared_rb_t* rb, uint8_t* dest, uint32_t length)
+{
+  const uint32_t head = rb->head->load(std::memory_order_acquire);
+  const uint32_t tail = rb->tail->load(std::memory_order_acquire);
+
+  const uint32_t used = head - tail;
+
+  // Clamp to available data
+  if (length > used)
+    length = used;
+
+  // One memcpy for mirrored buffers, two across the wrap otherwise
+  copy_out(rb, tail, dest, length);
 
-  // Publish new tail index
-  rb->tail->store(tail + length, std::memory_order_release);
+  // Publish new tail index, wake a parked producer
+  publish_tail(rb, tail + length);
+  count_read(rb, length);
   return length;
 }
+
+
+/*
+ * Fills a span for length bytes at sequence index.
+ * Splits the region at the end of the payload, unless mirrored.
+ */
+static void make_span(const shared_rb_t* rb, uint32_t index, uint32_t length, shared_rb_span_t* span)
+{
+  const uint32_t pos = index % rb->capacity;
+  uint32_t first = rb->mirrored ? length : rb->capacity - pos;
+  if (first > length) first = length;
+
+  span->first = rb->buffer + pos;
+  span->first_length = first;
+  span->second = length > first ? rb->buffer : nullptr;
+  span->second_length = length - first;
+}
+
+
+/*
+ * Exposes readable bytes in place.
+ *
+ * Behavior:
+ *   - Same clamping as shared_rb_read
+ *   - Splits the region at the end of the payload, unless mirrored
+ *   - Leaves the tail untouched until shared_rb_consume
+ */
+EXP32 uint32_t shared_rb_peek(shared_rb_t* rb, uint32_t length, shared_rb_span_t* span)
+{
+  const uint32_t head = rb->head->load(std::memory_order_acquire);
+  const uint32_t tail = rb->tail->load(std::memory_order_relaxed);
+
+  // Clamp to available data
+  if (length > head - tail)
+    length = head - tail;
+
+  make_span(rb, tail, length, span);
+  return length;
+}
+
+
+/*
+ * Releases peeked bytes by publishing the advanced tail.
+ */
+EXP32 void shared_rb_consume(shared_rb_t* rb, uint32_t length)
+{
+  const uint32_t tail = rb->tail->load(std::memory_order_relaxed);
+  publish_tail(rb, tail + length);
+  count_read(rb, length);
+}
+
+
+// Size of the header in front of every record; ring indices are 32-bit
+constexpr uint32_t SHARED_RB_RECORD_HDR = sizeof(shared_rb_record_hdr_t);
+
+
+/*
+ * Returns the largest record payload a ring can ever hold.
+ */
+static uint32_t max_record_payload(const shared_rb_t* rb)
+{
+  return rb->capacity > SHARED_RB_RECORD_HDR ? rb->capacity - SHARED_RB_RECORD_HDR : 0;
+}
+
+
+/*
+ * Writes as many whole records as fit, with a single publish.
+ *
+ * Behavior:
+ *   - Stops at the first record that does not fit (records stay in order)
+ *   - Copies header and payload of each record back to back
+ *   - Publishes the new head once, after the last whole record
+ */
+EXP32 uint32_t shared_rb_write_records(shared_rb_t* rb, const shared_rb_record_t* records, uint32_t count)
+{
+  const uint32_t head = rb->head->load(std::memory_order_acquire);
+  const uint32_t tail = rb->tail->load(std::memory_order_acquire);
+
+  const uint32_t used = head - tail;
+  uint32_t free = rb->capacity - used;
+  uint32_t written = 0;
+  uint32_t i = 0;
+
+  for (; i < count; i++)
+  {
+    const shared_rb_record_t& r = records[i];
+    if (r.length > max_record_payload(rb)) break;
+
+    const uint32_t total = SHARED_RB_RECORD_HDR + r.length;
+    if (total > free) break;
+
+    const shared_rb_record_hdr_t hdr{ r.length, r.type, r.flags };
+    copy_in(rb, head + written, reinterpret_cast<const uint8_t*>(&hdr), SHARED_RB_RECORD_HDR);
+    copy_in(rb, head + written + SHARED_RB_RECORD_HDR, r.data, r.length);
+
+    written += total;
+    free -= total;
+  }
+
+  if (written)
+    publish_head(rb, head + written);
+  count_write(rb, used, i, written, i < count);
+  return i;
+}
+
+
+/*
+ * Writes one whole record (see shared_rb_write_records).
+ */
+EXP32 uint32_t shared_rb_write_record(shared_rb_t* rb, uint16_t type, uint16_t flags,
+  const uint8_t* data, uint32_t length)
+{
+  const shared_rb_record_t record{ data, length, type, flags };
+  return shared_rb_write_records(rb, &record, 1);
+}
+
+
+/*
+ * Writes one whole record according to a write policy (see admit_write).
+ * Records are never split, so SHARED_RB_WRITE_PARTIAL needs no check.
+ */
+EXP32 uint32_t shared_rb_write_record_ex(shared_rb_t* rb, uint16_t type, uint16_t flags,
+  const uint8_t* data, uint32_t length, uint32_t policy, int32_t timeout_ms)
+{
+  const uint64_t total = SHARED_RB_RECORD_HDR + static_cast<uint64_t>(length);
+  if (policy != SHARED_RB_WRITE_PARTIAL && !admit_write(rb, total, policy, timeout_ms))
+    return 0;
+
+  return shared_rb_write_record(rb, type, flags, data, length);
+}
+
+
+/*
+ * Locates the record that starts offset bytes after the tail.
+ *
+ * Behavior:
+ *   - Copies its header out (it may wrap on a plain ring)
+ *   - Exposes its payload in place (see make_span)
+ *   - Returns header + payload size, or 0 if no whole record is there
+ */
+EXP32 uint32_t shared_rb_peek_record(shared_rb_t* rb, uint32_t offset,
+  shared_rb_record_hdr_t* hdr, shared_rb_span_t* span)
+{
+  const uint32_t head = rb->head->load(std::memory_order_acquire);
+  const uint32_t tail = rb->tail->load(std::memory_order_relaxed);
+
+  const uint32_t available = head - tail;
+  if (offset > available || available - offset < SHARED_RB_RECORD_HDR) return 0;
+
+  copy_out(rb, tail + offset, reinterpret_cast<uint8_t*>(hdr), SHARED_RB_RECORD_HDR);
+
+  // Writers publish whole records only; anything else is a torn or raw stream
+  const uint32_t total = SHARED_RB_RECORD_HDR + hdr->length;
+  if (hdr->length > max_record_payload(rb) || available - offset < total) return 0;
+
+  if (span)
+    make_span(rb, tail + offset + SHARED_RB_RECORD_HDR, hdr->length, span);
+  return total;
+}
+
+
+/*
+ * Reads exactly one record.
+ *
+ * Behavior:
+ *   - Peeks the record at the tail (see shared_rb_peek_record)
+ *   - Leaves it in the ring if dest is too small, so the caller can
+ *     retry with hdr->length bytes
+ *   - Otherwise copies the payload and consumes header + payload
+ */
+EXP32 int32_t shared_rb_read_record(shared_rb_t* rb, shared_rb_record_hdr_t* hdr,
+  uint8_t* dest, uint32_t capacity)
+{
+  const uint32_t total = shared_rb_peek_record(rb, 0, hdr, nullptr);
+  if (!total) return SHARED_RB_NO_RECORD;
+  if (hdr->length > capacity) return SHARED_RB_BUFFER_TOO_SMALL;
+
+  const uint32_t tail = rb->tail->load(std::memory_order_relaxed);
+  copy_out(rb, tail + SHARED_RB_RECORD_HDR, dest, hdr->length);
+
+  publish_tail(rb, tail + total);
+  count_read(rb, total);
+  return static_cast<int32_t>(hdr->length);
+}
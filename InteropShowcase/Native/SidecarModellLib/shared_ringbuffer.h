@@ -3,11 +3,189 @@
 #include "EXP32IMP32.h"   // Contains EXP32 macro (extern "C" + dllexport)
 
 
+/*
+ * Backend selection (compile time):
+ *   - Windows: named file mapping (CreateFileMappingA + MapViewOfFile)
+ *   - Linux:   POSIX shared memory (shm_open + ftruncate + mmap)
+ * Both backends share the memory layout and the exported API.
+ */
+#ifndef SHARED_RB_POSIX
+#if defined(_WIN32)
+#define SHARED_RB_POSIX 0
+#else
+#define SHARED_RB_POSIX 1
+#endif
+#endif
+
+
+/*
+ * Options for shared_rb_create_ex / shared_rb_open_ex.
+ *
+ *   SHARED_RB_MIRRORED - Map the payload twice, back to back
+ *                        (see shared_rb_create_mirrored)
+ *   SHARED_RB_PREFAULT - Fault in every page while mapping (MAP_POPULATE
+ *                        on Linux, one read per page on Windows), so the
+ *                        first writes after startup do not page-fault
+ *   SHARED_RB_LOCK     - Lock the pages in RAM (mlock / VirtualLock), so
+ *                        they are never paged out; needs RLIMIT_MEMLOCK
+ *                        or CAP_IPC_LOCK on Linux
+ *   SHARED_RB_FRAMED   - The payload carries length-prefixed records
+ *                        (see shared_rb_write_record); recorded in the
+ *                        header, so openers see it in shared_rb_granted
+ *
+ * PREFAULT and LOCK are best effort; shared_rb_granted reports what
+ * was actually applied.
+ */
+enum shared_rb_flags_t : uint32_t
+{
+  SHARED_RB_DEFAULT = 0,
+  SHARED_RB_MIRRORED = 1u << 0,
+  SHARED_RB_PREFAULT = 1u << 1,
+  SHARED_RB_LOCK = 1u << 2,
+  SHARED_RB_FRAMED = 1u << 3,
+};
+
+
 // Forward declaration of the internal ring buffer structure.
 // The actual layout is intentionally hidden to enforce encapsulation.
 struct shared_rb_t;
 
 
+/*
+ * One (pointer, length) segment for shared_rb_writev.
+ */
+struct shared_rb_segment_t
+{
+  const uint8_t* data;  // Segment start
+  uint32_t length;      // Number of bytes in the segment
+};
+
+
+/*
+ * Header of one record on a framed ring, followed by 'length' payload
+ * bytes. Records are packed back to back without padding.
+ */
+struct shared_rb_record_hdr_t
+{
+  uint32_t length;  // Number of payload bytes following the header
+  uint16_t type;    // Application-defined record type
+  uint16_t flags;   // Application-defined record flags
+};
+
+
+/*
+ * One record to write with shared_rb_write_records.
+ */
+struct shared_rb_record_t
+{
+  const uint8_t* data;  // Payload
+  uint32_t length;      // Number of payload bytes
+  uint16_t type;        // Stored in the record header
+  uint16_t flags;       // Stored in the record header
+};
+
+
+/*
+ * Negative results of shared_rb_read_record.
+ */
+enum shared_rb_record_status_t : int32_t
+{
+  SHARED_RB_NO_RECORD = -1,         // No whole record is readable
+  SHARED_RB_BUFFER_TOO_SMALL = -2,  // hdr->length exceeds the destination
+};
+
+
+/*
+ * What the _ex write calls do when a message does not fit into the free
+ * space. Apart from SHARED_RB_WRITE_PARTIAL every policy writes either
+ * the whole message or nothing.
+ */
+enum shared_rb_write_policy_t : uint32_t
+{
+  SHARED_RB_WRITE_PARTIAL = 0,         // Write as much as fits (shared_rb_write)
+  SHARED_RB_WRITE_ALL_OR_NOTHING = 1,  // Whole message or nothing, never wait
+  SHARED_RB_WRITE_BLOCK = 2,           // Park until the consumer frees enough space, or time out
+  SHARED_RB_WRITE_DROP = 3,            // Discard the message and count it (stats: dropped)
+};
+
+
+/*
+ * A readable region inside the ring payload, as exposed by
+ * shared_rb_peek. A region that wraps around the end of a plain ring
+ * consists of two parts; on a mirrored ring it is always one part.
+ */
+struct shared_rb_span_t
+{
+  const uint8_t* first;     // First contiguous part (starts at the tail)
+  uint32_t first_length;    // Number of bytes in the first part
+  const uint8_t* second;    // Wrapped part at the payload start, or nullptr
+  uint32_t second_length;   // Number of bytes in the second part
+};
+
+
+/*
+ * Statistics block, part of the shared memory region of every ring
+ * (SHARED_RB_STATS_OFFSET bytes after the region start).
+ *
+ * All counters only grow. Each cache line has a single writer (producer
+ * or consumer), which updates it with relaxed atomic stores, so counting
+ * costs no locked instruction and no line bouncing. Observers in any
+ * process read the counters with plain aligned 64-bit loads, without a
+ * call into either side; take two samples and diff them for rates.
+ *
+ * Producer line:
+ *   messages_written - Write calls / records that published data
+ *   bytes_written    - Bytes published (record headers included)
+ *   partial_writes   - Writes truncated because the ring was too full
+ *   full_rejections  - Writes that published nothing because the ring
+ *                      was full (or the record can never fit)
+ *   high_water       - Highest occupancy in bytes seen after a write
+ *   dropped          - Messages discarded by SHARED_RB_WRITE_DROP
+ *   write_sleeps     - Parks in shared_rb_wait_writable (futex / event)
+ *
+ * Consumer line:
+ *   messages_read    - Read, read_record and consume calls that took data
+ *   bytes_read       - Bytes taken (record headers included)
+ *   empty_polls      - shared_rb_wait_readable calls that found too little
+ *                      data and had to spin, yield or park
+ *   sleeps           - Parks in shared_rb_wait_readable (futex / event)
+ *   process_calls    - Callbacks run by the consumer's dispatcher (the
+ *                      sidecar loop: one per Process or ProcessBatch call)
+ *   process_ns       - Cumulative time spent in those callbacks
+ */
+struct alignas(64) shared_rb_stats_t
+{
+  alignas(64) uint64_t messages_written;
+  uint64_t bytes_written;
+  uint64_t partial_writes;
+  uint64_t full_rejections;
+  uint64_t high_water;
+  uint64_t dropped;
+  uint64_t write_sleeps;
+
+  alignas(64) uint64_t messages_read;
+  uint64_t bytes_read;
+  uint64_t empty_polls;
+  uint64_t sleeps;
+  uint64_t process_calls;
+  uint64_t process_ns;
+};
+
+
+/*
+ * Offset of shared_rb_stats_t from the start of the shared memory region,
+ * for tools that map the region themselves.
+ */
+constexpr uint32_t SHARED_RB_STATS_OFFSET = 3 * 64;
+
+
+/*
+ * Largest number of rings one shared_rb_wait_any call can watch
+ * (WaitForMultipleObjects handles at most 64 events).
+ */
+constexpr uint32_t SHARED_RB_WAIT_ANY_MAX = 64;
+
+
 /*
  * Creates a new shared-memory ring buffer.
  *
@@ -20,7 +198,8 @@ struct shared_rb_t;
  *   nullptr on failure (e.g., name already in use or allocation error)
  *
  * Notes:
- *   - Allocates a shared memory region (CreateFileMapping + MapViewOfFile)
+ *   - Allocates a shared memory region (CreateFileMapping + MapViewOfFile,
+ *     or shm_open + mmap on Linux, where the name gets a leading '/')
  *   - Initializes head and tail indices to zero
  *   - Typically called by the host process
  */
@@ -39,11 +218,117 @@ EXP32 shared_rb_t* shared_rb_create(const char* name, uint32_t capacity);
  *
  * Notes:
  *   - Typically called by the sidecar process
- *   - Reads the capacity from the shared memory region
+ *   - Validates the versioned header at the start of the region (magic,
+ *     layout version) and maps exactly the capacity and layout
+ *     (plain or mirrored) the creator used
  */
 EXP32 shared_rb_t* shared_rb_open(const char* name);
 
 
+/*
+ * Creates a new mirrored shared-memory ring buffer.
+ *
+ * Parameters:
+ *   name     - Unique name of the shared memory object
+ *   capacity - Minimum size of the ring buffer in bytes
+ *
+ * Returns:
+ *   Pointer to shared_rb_t on success
+ *   nullptr on failure
+ *
+ * Notes:
+ *   - The payload pages are mapped twice, back to back, so any record of
+ *     up to capacity bytes is contiguous in memory, even across the wrap
+ *   - Writes and reads use a single memcpy instead of two
+ *   - The capacity is rounded up to a power of two of at least the
+ *     allocation granularity (64 KB on Windows)
+ *   - Can be opened with shared_rb_open; the header records the layout
+ */
+EXP32 shared_rb_t* shared_rb_create_mirrored(const char* name, uint32_t capacity);
+
+
+/*
+ * Creates a new shared-memory ring buffer with options.
+ *
+ * Parameters:
+ *   name     - Unique name of the shared memory object
+ *   capacity - Size of the ring buffer in bytes (minimum size if mirrored)
+ *   flags    - Combination of shared_rb_flags_t
+ *
+ * Returns:
+ *   Pointer to shared_rb_t on success
+ *   nullptr on failure
+ *
+ * Notes:
+ *   - shared_rb_create and shared_rb_create_mirrored are shorthands
+ *   - Fails if the name is already in use; an existing ring is never
+ *     reinitialized
+ *   - On Linux the creator unlinks the name in shared_rb_close
+ */
+EXP32 shared_rb_t* shared_rb_create_ex(const char* name, uint32_t capacity, uint32_t flags);
+
+
+/*
+ * Opens an existing shared-memory ring buffer with options.
+ *
+ * Parameters:
+ *   name     - Name of the already created ring buffer
+ *   capacity - Ignored; the exact capacity is read from the header
+ *   flags    - SHARED_RB_PREFAULT / SHARED_RB_LOCK; the layout
+ *              (SHARED_RB_MIRRORED) is read from the header
+ *
+ * Returns:
+ *   Pointer to shared_rb_t on success
+ *   nullptr if the ring buffer does not exist or cannot be mapped
+ */
+EXP32 shared_rb_t* shared_rb_open_ex(const char* name, uint32_t capacity, uint32_t flags);
+
+
+/*
+ * Returns the shared_rb_flags_t actually applied to this mapping.
+ */
+EXP32 uint32_t shared_rb_granted(shared_rb_t* rb);
+
+
+/*
+ * Returns the statistics block inside the shared memory region.
+ * The pointer stays valid until shared_rb_close; read it at any time.
+ */
+EXP32 const shared_rb_stats_t* shared_rb_stats(shared_rb_t* rb);
+
+
+/*
+ * Adds dispatcher callbacks to the consumer statistics.
+ *
+ * Parameters:
+ *   rb    - Ring the callbacks consumed from
+ *   calls - Number of callbacks
+ *   ns    - Time spent in them, in nanoseconds
+ *
+ * Notes:
+ *   - Consumer side only (it writes the consumer line)
+ */
+EXP32 void shared_rb_stats_add_process(shared_rb_t* rb, uint32_t calls, uint64_t ns);
+
+
+/*
+ * Returns the payload capacity of the ring buffer in bytes.
+ */
+EXP32 uint32_t shared_rb_capacity(shared_rb_t* rb);
+
+
+/*
+ * Returns the number of bytes currently available to read.
+ */
+EXP32 uint32_t shared_rb_available_to_read(shared_rb_t* rb);
+
+
+/*
+ * Returns the number of bytes currently available to write.
+ */
+EXP32 uint32_t shared_rb_available_to_write(shared_rb_t* rb);
+
+
 /*
  * Closes a previously created or opened ring buffer.
  *
@@ -74,10 +359,69 @@ EXP32 void shared_rb_close(shared_rb_t* rb);
  *   - Zero-copy (only memcpy into shared memory)
  *   - Automatically handles wrap-around
  *   - Non-blocking: if not enough space is available, writes as much as possible
+ *   - Wakes the consumer only if it is parked in shared_rb_wait_readable
  */
 EXP32 uint32_t shared_rb_write(shared_rb_t* rb, const uint8_t* data, uint32_t length);
 
 
+/*
+ * Writes a batch of segments into the ring buffer with a single publish.
+ *
+ * Parameters:
+ *   rb       - Ring buffer handle
+ *   segments - Source segments, written back to back
+ *   count    - Number of segments
+ *
+ * Returns:
+ *   Total number of bytes written: all segments, or 0 if the batch does
+ *   not fit (counted in full_rejections)
+ *
+ * Notes:
+ *   - Never writes part of a batch, and the reader sees either none or
+ *     all of it, so a record split into header + payload segments is
+ *     never torn
+ *   - Callers that need blocking or dropping writes use
+ *     shared_rb_writev_ex
+ */
+EXP32 uint32_t shared_rb_writev(shared_rb_t* rb, const shared_rb_segment_t* segments, uint32_t count);
+
+
+/*
+ * Writes data according to a write policy.
+ *
+ * Parameters:
+ *   rb         - Ring buffer handle (producer side)
+ *   data       - Pointer to the bytes to write
+ *   length     - Number of bytes to write
+ *   policy     - shared_rb_write_policy_t applied when the data does not fit
+ *   timeout_ms - Timeout for SHARED_RB_WRITE_BLOCK; negative waits forever
+ *
+ * Returns:
+ *   length if the data was written, 0 if not (any count for
+ *   SHARED_RB_WRITE_PARTIAL)
+ *
+ * Notes:
+ *   - SHARED_RB_WRITE_BLOCK parks in shared_rb_wait_writable: the
+ *     producer sleeps until the consumer's read wakes it, no polling
+ *   - Data larger than the capacity can never fit and is rejected at once
+ *   - Rejections count as full_rejections, drops additionally as dropped
+ */
+EXP32 uint32_t shared_rb_write_ex(shared_rb_t* rb, const uint8_t* data, uint32_t length,
+  uint32_t policy, int32_t timeout_ms);
+
+
+/*
+ * Writes a batch of segments according to a write policy
+ * (see shared_rb_writev and shared_rb_write_ex).
+ *
+ * Returns:
+ *   Total number of bytes written: all segments or none, for every
+ *   policy (SHARED_RB_WRITE_PARTIAL behaves like shared_rb_writev)
+ */
+EXP32 uint32_t shared_rb_writev_ex(shared_rb_t* rb, const shared_rb_segment_t* segments, uint32_t count,
+  uint32_t policy, int32_t timeout_ms);
+
+
 /*
  * Reads data from the ring buffer.
  *
@@ -96,3 +440,230 @@ EXP32 uint32_t shared_rb_write(shared_rb_t* rb, const uint8_t* data, uint32_t le
  *   - Non-blocking: if not enough data is available, reads as much as possible
  */
 EXP32 uint32_t shared_rb_read(shared_rb_t* rb, uint8_t* dest, uint32_t length);
+
+
+/*
+ * Configures the wait strategy of shared_rb_wait_readable and
+ * shared_rb_wait_writable.
+ *
+ * Parameters:
+ *   rb     - Ring buffer handle (consumer side)
+ *   spins  - Busy-spin iterations with a pause instruction (phase 1)
+ *   yields - Time-slice yields (phase 2)
+ *
+ * Notes:
+ *   - Both default to 0 (park immediately)
+ *   - The setting is local to this handle, not stored in shared memory
+ */
+EXP32 void shared_rb_set_wait_strategy(shared_rb_t* rb, uint32_t spins, uint32_t yields);
+
+
+/*
+ * Blocks the consumer until at least min_bytes are readable.
+ *
+ * Parameters:
+ *   rb         - Ring buffer handle (consumer side)
+ *   min_bytes  - Number of bytes to wait for (0 is treated as 1)
+ *   timeout_ms - Timeout in milliseconds; 0 polls, negative waits forever
+ *
+ * Returns:
+ *   Number of readable bytes, or 0 on timeout or shared_rb_notify
+ *
+ * Notes:
+ *   - Spins, then yields (see shared_rb_set_wait_strategy), then parks
+ *   - Parking uses a futex on the head word in the shared header (Linux)
+ *     or the named event "<name>_wake" (Windows); the producer's write
+ *     only signals it while a consumer is actually parked
+ *   - Idle CPU is near zero once parked; wakeup takes microseconds
+ */
+EXP32 uint32_t shared_rb_wait_readable(shared_rb_t* rb, uint32_t min_bytes, int32_t timeout_ms);
+
+
+/*
+ * Wakes a consumer parked in shared_rb_wait_readable or
+ * shared_rb_wait_any unconditionally, e.g. after setting a stop flag it
+ * should re-check. The wait returns at once (0 / -1 if nothing arrived)
+ * instead of parking again.
+ *
+ * Notes:
+ *   - Call it on the consumer's handle: the notify is then kept until a
+ *     wait takes it, so a consumer that is still spinning, or has not
+ *     started its wait yet, cannot miss it. Through another handle it
+ *     only wakes a consumer that is already parked
+ */
+EXP32 void shared_rb_notify(shared_rb_t* rb);
+
+
+/*
+ * Blocks the consumer of several rings until one of them is readable.
+ *
+ * Parameters:
+ *   rbs        - Ring buffer handles (consumer side), in the order they
+ *                are checked
+ *   count      - Number of handles (1..SHARED_RB_WAIT_ANY_MAX)
+ *   timeout_ms - Timeout in milliseconds; 0 polls, negative waits forever
+ *
+ * Returns:
+ *   Index of the first readable ring in rbs, or -1 on timeout,
+ *   shared_rb_notify, or if count is out of range
+ *
+ * Notes:
+ *   - Spins and yields with the strategy of rbs[0], then parks on all
+ *     rings at once: futex_waitv on the head words (Linux 5.16+) or
+ *     WaitForMultipleObjects on the "<name>_wake" events (Windows).
+ *     Older Linux kernels park on rbs[0] and re-check the others every
+ *     millisecond
+ *   - A write to any of the rings wakes the consumer, as does
+ *     shared_rb_notify on any of them
+ *   - Counts an empty poll, and every park as a sleep, on each ring
+ */
+EXP32 int32_t shared_rb_wait_any(shared_rb_t* const* rbs, uint32_t count, int32_t timeout_ms);
+
+
+/*
+ * Blocks the producer until at least min_bytes are writable.
+ *
+ * Parameters:
+ *   rb         - Ring buffer handle (producer side)
+ *   min_bytes  - Number of bytes to wait for (0 is treated as 1)
+ *   timeout_ms - Timeout in milliseconds; 0 polls, negative waits forever
+ *
+ * Returns:
+ *   Number of writable bytes, or 0 on timeout (or if min_bytes exceeds
+ *   the capacity)
+ *
+ * Notes:
+ *   - Same phases as shared_rb_wait_readable, mirrored: parking uses a
+ *     futex on the tail word (Linux) or the named event "<name>_space"
+ *     (Windows); the consumer's read only signals it while a producer
+ *     is actually parked
+ */
+EXP32 uint32_t shared_rb_wait_writable(shared_rb_t* rb, uint32_t min_bytes, int32_t timeout_ms);
+
+
+/*
+ * Exposes readable bytes in place, without copying or consuming them.
+ *
+ * Parameters:
+ *   rb     - Ring buffer handle (consumer side)
+ *   length - Maximum number of bytes to expose
+ *   span   - Receives the readable region (one or two parts)
+ *
+ * Returns:
+ *   Number of bytes exposed (may be less than requested)
+ *
+ * Notes:
+ *   - The pointers point into the shared mapping; the producer cannot
+ *     overwrite the region until it is released with shared_rb_consume
+ *   - Mirrored rings always return a single contiguous part
+ */
+EXP32 uint32_t shared_rb_peek(shared_rb_t* rb, uint32_t length, shared_rb_span_t* span);
+
+
+/*
+ * Releases bytes previously exposed by shared_rb_peek (advances the tail),
+ * handing the space back to the producer.
+ *
+ * Parameters:
+ *   rb     - Ring buffer handle (consumer side)
+ *   length - Number of bytes to release (at most the peeked count)
+ */
+EXP32 void shared_rb_consume(shared_rb_t* rb, uint32_t length);
+
+
+/*
+ * Writes one whole record into a framed ring.
+ *
+ * Parameters:
+ *   rb     - Ring buffer handle (created with SHARED_RB_FRAMED)
+ *   type   - Record type, stored in the header
+ *   flags  - Record flags, stored in the header
+ *   data   - Payload
+ *   length - Number of payload bytes
+ *
+ * Returns:
+ *   1 if the record was written
+ *   0 if it does not fit right now (or never: length > capacity - 8)
+ *
+ * Notes:
+ *   - All or nothing: header and payload are published together, so a
+ *     reader never sees a partial record
+ *   - Do not mix with shared_rb_write on the same ring
+ */
+EXP32 uint32_t shared_rb_write_record(shared_rb_t* rb, uint16_t type, uint16_t flags,
+  const uint8_t* data, uint32_t length);
+
+
+/*
+ * Writes one whole record according to a write policy
+ * (see shared_rb_write_record and shared_rb_write_ex).
+ *
+ * Returns:
+ *   1 if the record was written, 0 if it was rejected, dropped or the
+ *   wait timed out
+ *
+ * Notes:
+ *   - SHARED_RB_WRITE_PARTIAL behaves like SHARED_RB_WRITE_ALL_OR_NOTHING:
+ *     records are never split
+ */
+EXP32 uint32_t shared_rb_write_record_ex(shared_rb_t* rb, uint16_t type, uint16_t flags,
+  const uint8_t* data, uint32_t length, uint32_t policy, int32_t timeout_ms);
+
+
+/*
+ * Writes several records with a single publish.
+ *
+ * Parameters:
+ *   rb      - Ring buffer handle (created with SHARED_RB_FRAMED)
+ *   records - Records to write, in order
+ *   count   - Number of records
+ *
+ * Returns:
+ *   Number of whole records written (a prefix of the array)
+ *
+ * Notes:
+ *   - Coalesces many small records into one head update without losing
+ *     their boundaries
+ */
+EXP32 uint32_t shared_rb_write_records(shared_rb_t* rb, const shared_rb_record_t* records, uint32_t count);
+
+
+/*
+ * Reads exactly one record from a framed ring.
+ *
+ * Parameters:
+ *   rb       - Ring buffer handle
+ *   hdr      - Receives the record header
+ *   dest     - Destination for the payload
+ *   capacity - Size of dest in bytes
+ *
+ * Returns:
+ *   Payload length (>= 0) on success
+ *   SHARED_RB_NO_RECORD if no whole record is readable
+ *   SHARED_RB_BUFFER_TOO_SMALL if hdr->length > capacity; the record is
+ *   left in the ring
+ */
+EXP32 int32_t shared_rb_read_record(shared_rb_t* rb, shared_rb_record_hdr_t* hdr,
+  uint8_t* dest, uint32_t capacity);
+
+
+/*
+ * Exposes one record in place, without consuming it.
+ *
+ * Parameters:
+ *   rb     - Ring buffer handle
+ *   offset - Byte offset from the tail (0, or the sum of the sizes
+ *            returned for the preceding records)
+ *   hdr    - Receives the record header
+ *   span   - Receives the payload region (may be nullptr)
+ *
+ * Returns:
+ *   Size of header + payload, or 0 if no whole record starts at offset
+ *
+ * Notes:
+ *   - Release records with shared_rb_consume(rb, sum of the sizes)
+ *   - On a plain ring a payload may wrap (two parts); mirrored rings
+ *     always return one contiguous part
+ */
+EXP32 uint32_t shared_rb_peek_record(shared_rb_t* rb, uint32_t offset,
+  shared_rb_record_hdr_t* hdr, shared_rb_span_t* span);
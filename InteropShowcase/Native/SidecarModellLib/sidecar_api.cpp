@@ -1,126 +1,1240 @@
 #include "pch.h"
+#include <algorithm>
 #include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <string>
 #include <thread>
+#include <vector>
 #include "sidecar_api.h"
+#include "shared_arena.h"
 #include "shared_ringbuffer.h"
+#include "sidecar_journal.h"
 
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
-// Global state for the sidecar worker thread.
-// These are intentionally kept internal to this translation unit.
-static std::thread g_thread;                          // Worker thread running the command loop
-static shared_rb_t* g_rb = nullptr;                   // Shared ring buffer handle
-static std::atomic<bool> g_running{ false };          // Controls the lifetime of the worker loop
-static const sidecar_host_vtable_t* g_host = nullptr; // Host-provided callback table
+
+/*
+ * Timestamps of one traced command (sidecar_trace_now clock).
+ */
+struct trace_span_t
+{
+  uint64_t write_ns = 0;    // Host write (sidecar_trace_hdr_t); 0 = not traced
+  uint64_t read_ns = 0;     // Drained from the command ring
+  uint64_t start_ns = 0;    // Callback start
+  uint64_t end_ns = 0;      // Callback end
+  uint64_t emit_ns = 0;     // Ack or response written
+  uint32_t length = 0;      // Payload bytes
+  uint16_t type = 0;        // Record type
+};
+
+
+// HDR-style log-linear histogram: values below 2^TRACE_SUB_BITS are
+// exact, every power of two above is split into 2^TRACE_SUB_BITS buckets.
+constexpr uint32_t TRACE_SUB_BITS = 5;
+constexpr uint32_t TRACE_SUB_COUNT = 1u << TRACE_SUB_BITS;
+constexpr uint32_t TRACE_BUCKETS = (64 - TRACE_SUB_BITS + 1) * TRACE_SUB_COUNT;
+
+struct trace_histogram_t
+{
+  std::atomic<uint64_t> buckets[TRACE_BUCKETS]{};
+  std::atomic<uint64_t> count{ 0 };
+};
+
+
+/*
+ * Tracing state of one instance (sidecar_set_tracing).
+ *
+ * Only the worker thread writes it, so recording is a relaxed load +
+ * store per counter. Spans are append-only into a buffer sized at
+ * enable time; span_count publishes them to sidecar_trace_dump.
+ */
+struct sidecar_trace_t
+{
+  trace_histogram_t stages[SIDECAR_TRACE_STAGES];
+  std::vector<trace_span_t> spans;        // Kept for sidecar_trace_dump
+  std::atomic<uint32_t> span_count{ 0 };  // Valid entries in spans
+  std::vector<trace_span_t> batch;        // Stamps of the batch being dispatched
+};
+
+
+/*
+ * One input lane (sidecar_add_lane). Lane 0 is the command ring.
+ */
+struct sidecar_lane_t
+{
+  shared_rb_t* rb = nullptr;    // Input ring (lane 0: sidecar_t::rb, not owned)
+  bool framed = false;          // Ring granted SHARED_RB_FRAMED
+  int32_t priority = 0;         // SIDECAR_LANES_STRICT: higher first
+  uint32_t weight = 1;          // SIDECAR_LANES_WEIGHTED: batches per round
+};
+
+
+/*
+ * Internal representation of one sidecar instance.
+ *
+ * Every instance owns its rings, its worker thread and a copy of the
+ * host vtable, so any number of sidecars can run side by side (e.g. one
+ * per core or per tenant). The layout is hidden from callers.
+ */
+struct sidecar_t
+{
+  sidecar_host_vtable_t host{};         // Host-provided callback table (copied)
+  shared_rb_t* rb = nullptr;            // Command ring
+  shared_rb_t* events = nullptr;        // Event ring (duplex channel), or nullptr
+  std::vector<sidecar_lane_t> lanes;    // Input lanes; lanes[0].rb == rb
+  int32_t lane_policy = SIDECAR_LANES_STRICT; // sidecar_lane_policy_t
+  std::atomic<uint32_t> batch_count{ 0 }; // Messages per batch (sidecar_set_batch_limits)
+  std::atomic<uint32_t> batch_bytes{ 0 }; // Payload bytes per batch
+  std::atomic<bool> zero_copy{ false }; // Deliver commands in place (sidecar_set_zero_copy)
+  const sidecar_msg_t* batch = nullptr; // Batch being dispatched (sidecar_respond)
+  uint32_t batch_size = 0;              // Number of messages in batch
+  std::vector<uint8_t> answered;        // Per message: RPC response already sent
+  std::unique_ptr<sidecar_trace_t> trace; // Latency tracing, or nullptr (disabled)
+  journal_t* journal = nullptr;         // Command journal, or nullptr (sidecar_set_journal)
+  shared_arena_t* arena = nullptr;      // Payload arena, or nullptr (sidecar_set_arena)
+  std::vector<shared_arena_desc_t> arena_blocks; // Per message: run to release (length 0: none)
+  sidecar_thread_options_t thread_options{}; // Placement of the worker (name unused)
+  std::string thread_name;              // Owned copy of thread_options.name
+  std::atomic<uint32_t> granted{ 0 };   // sidecar_thread_granted_t of the last start
+  std::atomic<bool> applied{ false };   // Worker has applied its thread options
+  std::thread thread;                   // Worker thread running the command loop
+  std::atomic<bool> running{ false };   // Controls the lifetime of the worker loop
+};
+
+
+// Default wait strategy of the worker loop (see sidecar_set_wait_strategy):
+// ~tens of microseconds of spinning, then a short yield phase, then park.
+constexpr uint32_t SIDECAR_WAIT_SPINS = 2000;
+constexpr uint32_t SIDECAR_WAIT_YIELDS = 50;
+
+// Upper bound for one park in the worker loop. Stops are signaled with
+// shared_rb_notify; the bound only limits the damage of a lost wakeup.
+constexpr int32_t SIDECAR_PARK_TIMEOUT_MS = 100;
+
+// Largest single read from the command ring, i.e. the largest message.
+constexpr uint32_t SIDECAR_READ_CHUNK = 1024;
+
+// Default batch limits (see sidecar_set_batch_limits).
+constexpr uint32_t SIDECAR_BATCH_COUNT = 64;
+constexpr uint32_t SIDECAR_BATCH_BYTES = 64 * 1024;
+
+// Default name of the worker thread (see sidecar_set_thread_options).
+constexpr const char* SIDECAR_DEFAULT_THREAD_NAME = "sidecar";
+
+
+// Default instance behind the classic sidecar_start/sidecar_stop calls.
+// Intentionally kept internal to this translation unit.
+static sidecar_t* g_default = nullptr;
+
+// Instance whose batch is being dispatched on this thread (sidecar_respond).
+static thread_local sidecar_t* t_current = nullptr;
+
+
+/*
+ * Sends an event to the host.
+ *
+ * Behavior:
+ *   - Duplex channel: appends a sidecar_event_hdr_t record to the event
+ *     ring; header and payload are published together. Parks in
+ *     shared_rb_wait_writable while the ring is too full, so the host
+ *     applies backpressure; its reads wake the sidecar.
+ *     Records larger than the ring are dropped.
+ *   - Otherwise: calls host->OnEvent on the sidecar thread, if set
+ *
+ * The payload is given as parts (e.g. an RPC header and the response);
+ * they are written back to back as one record.
+ */
+static void post_event(sidecar_t* sc, int eventId, const shared_rb_segment_t* parts, uint32_t count)
+{
+  uint32_t length = 0;
+  for (uint32_t i = 0; i < count; i++)
+    length += parts[i].length;
+
+  if (!sc->events)
+  {
+    if (!sc->host.OnEvent) return;
+    if (count == 1)
+    {
+      sc->host.OnEvent(eventId, parts[0].data, static_cast<int>(length));
+      return;
+    }
+
+    // OnEvent takes one pointer: join the parts
+    std::vector<uint8_t> joined;
+    joined.reserve(length);
+    for (uint32_t i = 0; i < count; i++)
+      joined.insert(joined.end(), parts[i].data, parts[i].data + parts[i].length);
+    sc->host.OnEvent(eventId, joined.data(), static_cast<int>(length));
+    return;
+  }
+
+  const sidecar_event_hdr_t hdr{ eventId, length };
+  const uint32_t total = static_cast<uint32_t>(sizeof(hdr)) + length;
+  if (total > shared_rb_capacity(sc->events)) return;
+
+  // Whole records only: park until the host has drained enough space,
+  // re-checking the stop flag every park timeout
+  while (shared_rb_wait_writable(sc->events, total, SIDECAR_PARK_TIMEOUT_MS) < total)
+  {
+    if (!sc->running.load(std::memory_order_acquire)) return;
+  }
+
+  shared_rb_segment_t segments[4] =
+  {
+    { reinterpret_cast<const uint8_t*>(&hdr), static_cast<uint32_t>(sizeof(hdr)) },
+  };
+  count = (std::min)(count, 3u);
+  std::copy(parts, parts + count, segments + 1);
+  shared_rb_writev(sc->events, segments, count + 1);
+}
 
 
 /*
- * The main worker loop executed by the sidecar thread.
+ * Sends the SIDECAR_EVENT_RPC_RESPONSE for one request.
+ */
+static void post_response(sidecar_t* sc, uint64_t correlation_id, int32_t status,
+  const uint8_t* data, uint32_t length)
+{
+  const sidecar_rpc_hdr_t rpc{ correlation_id, status, 0 };
+  const shared_rb_segment_t parts[2] =
+  {
+    { reinterpret_cast<const uint8_t*>(&rpc), static_cast<uint32_t>(sizeof(rpc)) },
+    { data, length },
+  };
+  post_event(sc, SIDECAR_EVENT_RPC_RESPONSE, parts, 2);
+}
+
+
+/*
+ * Returns the trace clock (see sidecar_trace_now).
+ */
+static uint64_t trace_now()
+{
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+
+/*
+ * Maps a value to its histogram bucket, and a bucket back to the
+ * midpoint of the values it holds.
+ */
+static uint32_t trace_bucket(uint64_t value)
+{
+  if (value < TRACE_SUB_COUNT) return static_cast<uint32_t>(value);
+
+  const uint32_t exponent = static_cast<uint32_t>(std::bit_width(value)) - 1;
+  const uint32_t group = exponent - TRACE_SUB_BITS + 1;
+  const uint32_t sub = static_cast<uint32_t>(value >> (exponent - TRACE_SUB_BITS)) & (TRACE_SUB_COUNT - 1);
+  return group * TRACE_SUB_COUNT + sub;
+}
+
+static uint64_t trace_bucket_value(uint32_t bucket)
+{
+  const uint32_t group = bucket / TRACE_SUB_COUNT;
+  const uint64_t sub = bucket % TRACE_SUB_COUNT;
+  if (group == 0) return sub;
+
+  const uint64_t width = 1ull << (group - 1);
+  return (TRACE_SUB_COUNT + sub) * width + width / 2;
+}
+
+
+/*
+ * Adds one value to a histogram (worker thread only).
+ */
+static void trace_add(trace_histogram_t& h, uint64_t value)
+{
+  std::atomic<uint64_t>& bucket = h.buckets[trace_bucket(value)];
+  bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  h.count.store(h.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+
+/*
+ * Records a completed span: one value per stage, and the span itself
+ * while the dump buffer has room. Clamps stages to 0 if the stamps are
+ * out of order (e.g. a response sent from inside the callback).
+ */
+static void trace_record(sidecar_trace_t* trace, const trace_span_t& s)
+{
+  const auto delta = [](uint64_t from, uint64_t to) { return to > from ? to - from : 0; };
+
+  trace_add(trace->stages[SIDECAR_TRACE_QUEUE], delta(s.write_ns, s.read_ns));
+  trace_add(trace->stages[SIDECAR_TRACE_DISPATCH], delta(s.read_ns, s.start_ns));
+  trace_add(trace->stages[SIDECAR_TRACE_PROCESS], delta(s.start_ns, s.end_ns));
+  trace_add(trace->stages[SIDECAR_TRACE_EMIT], delta(s.end_ns, s.emit_ns));
+  trace_add(trace->stages[SIDECAR_TRACE_TOTAL], delta(s.write_ns, s.emit_ns));
+
+  const uint32_t n = trace->span_count.load(std::memory_order_relaxed);
+  if (n < trace->spans.size())
+  {
+    trace->spans[n] = s;
+    trace->span_count.store(n + 1, std::memory_order_release);
+  }
+}
+
+
+/*
+ * Strips the prefixes of traced commands and RPC requests, in wire order
+ * (sidecar_trace_hdr_t, then sidecar_rpc_hdr_t). Fills correlation_id,
+ * and with tracing enabled the write stamp of every message in
+ * sc->trace->batch. A message too short to carry a prefix loses the flag
+ * and is treated as a plain command. Returns the number of traced
+ * messages (0 while tracing is disabled).
+ *
+ * What remains of an arena message is its shared_arena_desc_t; it is
+ * resolved to the run in place and noted in sc->arena_blocks for the
+ * release after the batch. A descriptor that does not resolve leaves an
+ * empty message.
+ */
+static uint32_t parse_requests(sidecar_t* sc, sidecar_msg_t* messages, uint32_t count)
+{
+  uint32_t traced = 0;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    sidecar_msg_t& m = messages[i];
+    uint64_t write_ns = 0;
+
+    if ((m.flags & SIDECAR_MSG_TRACED) && m.length < static_cast<int32_t>(sizeof(sidecar_trace_hdr_t)))
+      m.flags &= ~SIDECAR_MSG_TRACED;
+
+    if (m.flags & SIDECAR_MSG_TRACED)
+    {
+      sidecar_trace_hdr_t hdr;
+      std::memcpy(&hdr, m.data, sizeof(hdr));
+      write_ns = hdr.write_ns;
+      m.data += sizeof(hdr);
+      m.length -= static_cast<int32_t>(sizeof(hdr));
+    }
+
+    if (sc->trace)
+    {
+      sc->trace->batch[i] = trace_span_t{};
+      sc->trace->batch[i].write_ns = write_ns;
+      traced += write_ns != 0;
+    }
+
+    if ((m.flags & SIDECAR_MSG_RPC) && m.length < static_cast<int32_t>(sizeof(sidecar_rpc_hdr_t)))
+      m.flags &= ~SIDECAR_MSG_RPC;
+
+    if (m.flags & SIDECAR_MSG_RPC)
+    {
+      sidecar_rpc_hdr_t rpc;
+      std::memcpy(&rpc, m.data, sizeof(rpc));
+      m.correlation_id = rpc.correlation_id;
+      m.data += sizeof(rpc);
+      m.length -= static_cast<int32_t>(sizeof(rpc));
+    }
+
+    sc->arena_blocks[i].length = 0;
+    if (!(m.flags & SIDECAR_MSG_ARENA)) continue;
+
+    shared_arena_desc_t desc{};
+    const uint8_t* run = nullptr;
+    if (m.length >= static_cast<int32_t>(sizeof(desc)))
+    {
+      std::memcpy(&desc, m.data, sizeof(desc));
+      if (desc.length <= INT32_MAX)
+        run = shared_arena_resolve(sc->arena, &desc);
+    }
+
+    m.data = run ? run : m.data;
+    m.length = run ? static_cast<int32_t>(desc.length) : 0;
+    if (run) sc->arena_blocks[i] = desc;
+  }
+  return traced;
+}
+
+
+/*
+ * Batch limits and delivery mode of one worker run, copied from the
+ * instance when the worker starts. The batch buffers are sized from
+ * them, so the drain helpers must never read the live (settable) values.
+ */
+struct batch_limits_t
+{
+  uint32_t count = 0;
+  uint32_t bytes = 0;
+  bool zero_copy = false;               // Deliver in place (no copy buffer then)
+};
+
+
+/*
+ * Copies up to limits.count messages / limits.bytes bytes out of a lane's
+ * ring into buffer. Returns the number of messages.
+ *
+ * Framed rings yield one message per record. A record larger than the
+ * byte budget is delivered alone; buffer grows to hold it.
+ */
+static uint32_t drain_copy(const batch_limits_t& limits, const sidecar_lane_t& lane,
+  std::vector<uint8_t>& buffer, sidecar_msg_t* messages)
+{
+  uint32_t count = 0, used = 0;
+  while (count < limits.count && used < limits.bytes)
+  {
+    if (!lane.framed)
+    {
+      const uint32_t chunk = (std::min)(SIDECAR_READ_CHUNK, limits.bytes - used);
+      const uint32_t read = shared_rb_read(lane.rb, buffer.data() + used, chunk);
+      if (read == 0) break;
+
+      messages[count++] = { buffer.data() + used, static_cast<int32_t>(read), 0, 0, 0 };
+      used += read;
+      continue;
+    }
+
+    shared_rb_record_hdr_t hdr{};
+    if (!shared_rb_peek_record(lane.rb, 0, &hdr, nullptr)) break;
+
+    if (hdr.length > limits.bytes - used)
+    {
+      if (count > 0) break;             // Next batch
+      buffer.resize(hdr.length);        // Oversized record, alone
+    }
+
+    const int32_t read = shared_rb_read_record(lane.rb, &hdr, buffer.data() + used,
+      static_cast<uint32_t>(buffer.size()) - used);
+    if (read < 0) break;
+
+    messages[count++] = { buffer.data() + used, read, hdr.type, hdr.flags, 0 };
+    used += static_cast<uint32_t>(read);
+  }
+  return count;
+}
+
+
+/*
+ * Exposes up to limits.count records / limits.bytes bytes in place, one
+ * message per record. A payload that wraps around the end of a plain
+ * ring is copied into scratch (at most one per batch, since a batch
+ * never spans more than the capacity). Stores the number of bytes to
+ * consume after dispatching in *peeked. Returns the number of messages.
+ */
+static uint32_t drain_records_in_place(const batch_limits_t& limits, const sidecar_lane_t& lane,
+  std::vector<uint8_t>& scratch, sidecar_msg_t* messages, uint32_t* peeked)
+{
+  uint32_t count = 0;
+  *peeked = 0;
+
+  while (count < limits.count)
+  {
+    shared_rb_record_hdr_t hdr{};
+    shared_rb_span_t span{};
+    const uint32_t total = shared_rb_peek_record(lane.rb, *peeked, &hdr, &span);
+    if (!total || (count > 0 && *peeked + total > limits.bytes)) break;
+
+    const uint8_t* data = span.first;
+    if (span.second_length)
+    {
+      scratch.resize(hdr.length);
+      std::memcpy(scratch.data(), span.first, span.first_length);
+      std::memcpy(scratch.data() + span.first_length, span.second, span.second_length);
+      data = scratch.data();
+    }
+
+    messages[count++] = { data, static_cast<int32_t>(hdr.length), hdr.type, hdr.flags, 0 };
+    *peeked += total;
+  }
+  return count;
+}
+
+
+/*
+ * Exposes up to limits.bytes readable bytes of a raw ring in place, as
+ * one message (two if the region wraps a plain ring). Stores the number
+ * of bytes to consume after dispatching in *peeked. Returns the number
+ * of messages.
+ */
+static uint32_t drain_in_place(const batch_limits_t& limits, const sidecar_lane_t& lane,
+  sidecar_msg_t* messages, uint32_t* peeked)
+{
+  shared_rb_span_t span{};
+  *peeked = shared_rb_peek(lane.rb, limits.bytes, &span);
+  if (*peeked == 0) return 0;
+
+  messages[0] = { span.first, static_cast<int32_t>(span.first_length), 0, 0, 0 };
+  if (span.second_length == 0) return 1;
+
+  // Wrapped plain ring: second part only if the batch allows two messages
+  if (limits.count < 2)
+  {
+    *peeked = span.first_length;
+    return 1;
+  }
+
+  messages[1] = { span.second, static_cast<int32_t>(span.second_length), 0, 0, 0 };
+  return 2;
+}
+
+
+/*
+ * Drains the next batch of one lane, copied or in place (see above).
+ */
+static uint32_t drain_lane(const batch_limits_t& limits, const sidecar_lane_t& lane,
+  std::vector<uint8_t>& buffer, sidecar_msg_t* messages, uint32_t* peeked)
+{
+  *peeked = 0;
+  return !limits.zero_copy ? drain_copy(limits, lane, buffer, messages)
+    : lane.framed ? drain_records_in_place(limits, lane, buffer, messages, peeked)
+    : drain_in_place(limits, lane, messages, peeked);
+}
+
+
+/*
+ * Lane scheduler state of one worker run.
+ *
+ *   policy - sidecar_lane_policy_t, fixed at start
+ *   order  - Lane indices by descending priority, stable (strict)
+ *   cursor - Lane whose turn it is (weighted)
+ *   credit - Batches the cursor lane may still take this round (weighted)
+ */
+struct lane_schedule_t
+{
+  int32_t policy = SIDECAR_LANES_STRICT;
+  std::vector<uint32_t> order;
+  uint32_t cursor = 0;
+  uint32_t credit = 0;
+};
+
+
+/*
+ * Drains the next batch according to the lane policy. Stores the lane
+ * it came from in *lane. Returns the number of messages, 0 if every
+ * lane is empty.
+ */
+static uint32_t drain_next(sidecar_t* sc, const batch_limits_t& limits, lane_schedule_t& schedule,
+  std::vector<uint8_t>& buffer, sidecar_msg_t* messages, uint32_t* peeked, uint32_t* lane)
+{
+  const uint32_t n = static_cast<uint32_t>(sc->lanes.size());
+
+  if (schedule.policy != SIDECAR_LANES_WEIGHTED)
+  {
+    // Strict: first readable lane in priority order
+    for (const uint32_t i : schedule.order)
+    {
+      const uint32_t count = drain_lane(limits, sc->lanes[i], buffer, messages, peeked);
+      if (count == 0) continue;
+
+      *lane = i;
+      return count;
+    }
+    return 0;
+  }
+
+  // Weighted round-robin: the cursor lane keeps its turn for weight
+  // batches, an empty lane passes it on
+  for (uint32_t visited = 0; visited < n; visited++)
+  {
+    const uint32_t i = schedule.cursor;
+    if (schedule.credit == 0)
+      schedule.credit = (std::max)(sc->lanes[i].weight, 1u);
+
+    const uint32_t count = drain_lane(limits, sc->lanes[i], buffer, messages, peeked);
+    if (count == 0 || --schedule.credit == 0)
+    {
+      schedule.cursor = (i + 1) % n;
+      schedule.credit = 0;
+    }
+    if (count == 0) continue;
+
+    *lane = i;
+    return count;
+  }
+  return 0;
+}
+
+
+/*
+ * Applies placement and scheduling options to the calling thread.
+ * Every step is best effort; returns the sidecar_thread_granted_t bits
+ * of the steps that succeeded.
+ */
+static uint32_t apply_thread_options(const sidecar_thread_options_t& options, const std::string& name)
+{
+  uint32_t granted = 0;
+
+#if defined(_WIN32)
+  HANDLE self = GetCurrentThread();
+
+  if (options.affinity_mask &&
+    SetThreadAffinityMask(self, static_cast<DWORD_PTR>(options.affinity_mask)) != 0)
+    granted |= SIDECAR_THREAD_AFFINITY;
+
+  // Windows has no per-thread policy; map both onto priority levels
+  int level = THREAD_PRIORITY_HIGHEST;
+  if (options.policy == SIDECAR_SCHED_FIFO)
+    level = THREAD_PRIORITY_TIME_CRITICAL;
+  else if (options.policy == SIDECAR_SCHED_OTHER)
+    level = options.priority <= -10 ? THREAD_PRIORITY_HIGHEST
+      : options.priority < 0 ? THREAD_PRIORITY_ABOVE_NORMAL
+      : options.priority == 0 ? THREAD_PRIORITY_NORMAL
+      : options.priority < 10 ? THREAD_PRIORITY_BELOW_NORMAL
+      : THREAD_PRIORITY_LOWEST;
+
+  if (SetThreadPriority(self, level) && options.policy != SIDECAR_SCHED_DEFAULT)
+    granted |= SIDECAR_THREAD_SCHED;
+
+  // SetThreadDescription takes UTF-16
+  wchar_t wide[64]{};
+  if (MultiByteToWideChar(CP_UTF8, 0, name.c_str(), -1, wide, 63) > 0 &&
+    SUCCEEDED(SetThreadDescription(self, wide)))
+    granted |= SIDECAR_THREAD_NAME;
+#else
+  const pthread_t self = pthread_self();
+
+  if (options.affinity_mask)
+  {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; cpu++)
+      if (options.affinity_mask & (1ull << cpu))
+        CPU_SET(cpu, &set);
+
+    if (pthread_setaffinity_np(self, sizeof(set), &set) == 0)
+      granted |= SIDECAR_THREAD_AFFINITY;
+  }
+
+  if (options.policy == SIDECAR_SCHED_FIFO)
+  {
+    sched_param param{};
+    param.sched_priority = std::clamp(options.priority,
+      sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO));
+
+    if (pthread_setschedparam(self, SCHED_FIFO, &param) == 0)
+      granted |= SIDECAR_THREAD_SCHED;
+  }
+  else if (options.policy == SIDECAR_SCHED_OTHER)
+  {
+    // Nice values are per thread on Linux, addressed by the kernel tid
+    const sched_param param{};
+    if (pthread_setschedparam(self, SCHED_OTHER, &param) == 0 &&
+      setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)),
+        std::clamp(options.priority, -20, 19)) == 0)
+      granted |= SIDECAR_THREAD_SCHED;
+  }
+
+  // The kernel limits names to 15 bytes plus the terminator
+  if (pthread_setname_np(self, name.substr(0, 15).c_str()) == 0)
+    granted |= SIDECAR_THREAD_NAME;
+#endif
+
+  return granted;
+}
+
+
+/*
+ * The main worker loop executed by each sidecar thread.
  *
  * Responsibilities:
- *   - Call host->Init() once at startup
- *   - Continuously read commands from the shared ring buffer
- *   - Forward commands to host->Process()
- *   - Send example events back via host->OnEvent()
- *   - Call host->Dispose() before shutting down
+ *   - Call host.Init() once at startup
+ *   - Continuously read commands from the input lanes, waiting with
+ *     spin → yield → park while all of them are empty
+ *   - Pick the lane of each batch by the lane policy (drain_next) and
+ *     drain up to batch_count messages / batch_bytes bytes from it
+ *     (both fixed for the run),
+ *     copied into a private buffer or exposed in place (zero_copy,
+ *     also fixed for the run);
+ *     one message per record if the ring is framed
+ *   - Append the drained messages to the command journal, if enabled
+ *   - Forward the batch to host.ProcessBatch() in one call, or to
+ *     host.Process() message by message; the host answers RPC requests
+ *     with sidecar_respond() during the call
+ *   - Answer the remaining RPC requests, acknowledge plain commands
+ *     (event ring or host.OnEvent(), see post_event)
+ *   - Call host.Dispose() before shutting down
  *
- * This loop runs until g_running becomes false.
+ * This loop runs until sc->running becomes false.
  */
-static void sidecar_loop()
+static void sidecar_loop(sidecar_t* sc)
 {
+  // Placement first, so Init and every command run where they should
+  sc->granted.store(apply_thread_options(sc->thread_options, sc->thread_name),
+    std::memory_order_release);
+  sc->applied.store(true, std::memory_order_release);
+  sc->applied.notify_one();
+
   // Notify host that the sidecar is starting
-  g_host->Init();
+  sc->host.Init();
+
+  // Lane setup: ring flags, strict order, and the rings to wait on
+  lane_schedule_t schedule;
+  schedule.policy = sc->lane_policy;
+  std::vector<shared_rb_t*> rings;
+  for (uint32_t i = 0; i < sc->lanes.size(); i++)
+  {
+    sidecar_lane_t& lane = sc->lanes[i];
+    lane.framed = (shared_rb_granted(lane.rb) & SHARED_RB_FRAMED) != 0;
+    schedule.order.push_back(i);
+    rings.push_back(lane.rb);
+  }
+  std::stable_sort(schedule.order.begin(), schedule.order.end(),
+    [sc](uint32_t a, uint32_t b) { return sc->lanes[a].priority > sc->lanes[b].priority; });
+
+  // Batch limits and mode are fixed for this run; the buffers below depend on them
+  batch_limits_t limits;
+  limits.count = sc->batch_count.load(std::memory_order_relaxed);
+  limits.bytes = sc->batch_bytes.load(std::memory_order_relaxed);
+  limits.zero_copy = sc->zero_copy.load(std::memory_order_relaxed);
 
-  uint8_t buffer[1024];
+  std::vector<uint8_t> buffer(limits.zero_copy ? 0 : limits.bytes);
+  std::vector<sidecar_msg_t> messages(limits.count);
+  sc->arena_blocks.resize(limits.count);
+  if (sc->trace)
+    sc->trace->batch.resize(limits.count);
 
-  while (g_running.load(std::memory_order_acquire))
+  while (sc->running.load(std::memory_order_acquire))
   {
-    // Try to read a command from the ring buffer
-    uint32_t read = shared_rb_read(g_rb, buffer, sizeof(buffer));
-    if (read > 0)
+    // Drain the next lane's messages, within the batch limits
+    uint32_t peeked = 0, lane = 0;
+    const uint32_t count = drain_next(sc, limits, schedule, buffer, messages.data(), &peeked, &lane);
+    shared_rb_t* const rb = sc->lanes[lane].rb;
+
+    if (count > 0)
     {
-      // Forward the command to the host
-      g_host->Process(buffer, static_cast<int>(read));
+      // Journal the commands exactly as drained, prefixes included
+      if (sc->journal)
+      {
+        const uint64_t now = trace_now();
+        for (uint32_t i = 0; i < count; i++)
+          journal_append(sc->journal, now, messages[i].type, messages[i].flags,
+            messages[i].data, static_cast<uint32_t>(messages[i].length));
+      }
+
+      // Traced batch: stamp the read, then the callbacks and emits below
+      const bool tracing = parse_requests(sc, messages.data(), count) > 0;
+      trace_span_t* spans = tracing ? sc->trace->batch.data() : nullptr;
+      if (tracing)
+      {
+        const uint64_t now = trace_now();
+        for (uint32_t i = 0; i < count; i++)
+        {
+          spans[i].read_ns = now;
+          spans[i].length = static_cast<uint32_t>(messages[i].length);
+          spans[i].type = messages[i].type;
+        }
+      }
+
+      // Open the batch for sidecar_respond
+      sc->batch = messages.data();
+      sc->batch_size = count;
+      sc->answered.assign(count, 0);
+      t_current = sc;
+
+      // Forward the batch to the host: one transition, or one per message
+      const uint64_t started = trace_now();
+      if (sc->host.ProcessBatch)
+        sc->host.ProcessBatch(messages.data(), static_cast<int>(count));
+      else
+        for (uint32_t i = 0; i < count; i++)
+        {
+          if (spans) spans[i].start_ns = trace_now();
+          sc->host.Process(messages[i].data, messages[i].length);
+          if (spans) spans[i].end_ns = trace_now();
+        }
+
+      const uint64_t finished = trace_now();
+      shared_rb_stats_add_process(rb, sc->host.ProcessBatch ? 1 : count, finished - started);
+
+      if (spans && sc->host.ProcessBatch)
+        for (uint32_t i = 0; i < count; i++)
+        {
+          spans[i].start_ns = started;
+          spans[i].end_ns = finished;
+        }
+
+      t_current = nullptr;
+      sc->batch = nullptr;
 
-      // Send a simple example event back to the host
+      // In-place messages stay valid until here; now free the space
+      if (peeked)
+        shared_rb_consume(rb, peeked);
+      for (uint32_t i = 0; i < count; i++)
+        if (sc->arena_blocks[i].length)
+          shared_arena_release(sc->arena, &sc->arena_blocks[i]);
+
+      // Every request gets exactly one response; plain commands an ack
       const char msg[] = "OK";
-      g_host->OnEvent(1, reinterpret_cast<const uint8_t*>(msg), 2);
+      const shared_rb_segment_t ack{ reinterpret_cast<const uint8_t*>(msg), 2 };
+      for (uint32_t i = 0; i < count; i++)
+      {
+        if (!(messages[i].flags & SIDECAR_MSG_RPC))
+          post_event(sc, SIDECAR_EVENT_ACK, &ack, 1);
+        else if (!sc->answered[i])
+          post_response(sc, messages[i].correlation_id, 0, nullptr, 0);
+
+        if (spans && spans[i].write_ns)
+        {
+          if (!spans[i].emit_ns) spans[i].emit_ns = trace_now();
+          trace_record(sc->trace.get(), spans[i]);
+        }
+      }
     }
     else
     {
-      // No data available → avoid busy spinning
-      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      // No data on any lane → spin, yield, then park until the host writes
+      shared_rb_wait_any(rings.data(), static_cast<uint32_t>(rings.size()), SIDECAR_PARK_TIMEOUT_MS);
     }
   }
 
   // Notify host that the sidecar is shutting down
-  g_host->Dispose();
+  sc->host.Dispose();
 }
 
 
 /*
- * Starts the sidecar worker thread.
- *
- * Parameters:
- *   host   - Pointer to the host-provided callback table
- *   rbDesc - Descriptor containing the shared ring buffer name and capacity
+ * Creates a sidecar instance.
  *
  * Behavior:
- *   - Opens the shared ring buffer
- *   - Stores the host vtable
- *   - Spawns the worker thread
- *   - Raises the thread priority for more responsive processing
+ *   - Copies the host vtable
+ *   - Opens the command ring (lane 0), and the event ring if one is
+ *     described
+ *   - Applies the default wait strategy, batch limits and thread name
+ *   - Does not start the worker thread (see sidecar_start_ex)
+ */
+EXP32 sidecar_t* sidecar_create(const sidecar_host_vtable_t* host, const sidecar_channel_desc_t* channel)
+{
+  if (!host || !channel || !channel->commands.name) return nullptr;
+
+  auto* sc = new sidecar_t();
+  sc->host = *host;
+
+  // Open the shared ring buffers created by the host
+  sc->rb = shared_rb_open(channel->commands.name);
+  if (channel->events.name)
+    sc->events = shared_rb_open(channel->events.name);
+
+  if (!sc->rb || (channel->events.name && !sc->events))
+  {
+    shared_rb_close(sc->rb);
+    shared_rb_close(sc->events);
+    delete sc;
+    return nullptr;
+  }
+
+  shared_rb_set_wait_strategy(sc->rb, SIDECAR_WAIT_SPINS, SIDECAR_WAIT_YIELDS);
+  sc->lanes.push_back({ sc->rb });
+  sc->batch_count = SIDECAR_BATCH_COUNT;
+  sc->batch_bytes = SIDECAR_BATCH_BYTES;
+  sc->thread_name = SIDECAR_DEFAULT_THREAD_NAME;
+  return sc;
+}
+
+
+/*
+ * Sets the wait strategy of the worker loop while the command ring is
+ * empty (see shared_rb_set_wait_strategy). Takes effect on the next wait.
+ */
+EXP32 void sidecar_set_wait_strategy(sidecar_t* sc, uint32_t spins, uint32_t yields)
+{
+  if (!sc) return;
+  shared_rb_set_wait_strategy(sc->rb, spins, yields);
+}
+
+
+/*
+ * Sets the batch limits of the worker loop. The worker copies them when
+ * it starts and sizes its batch buffers from the copy, so a running
+ * worker keeps its limits until the next start.
+ */
+EXP32 void sidecar_set_batch_limits(sidecar_t* sc, uint32_t max_count, uint32_t max_bytes)
+{
+  if (!sc) return;
+  sc->batch_count.store(max_count ? max_count : 1, std::memory_order_relaxed);
+  sc->batch_bytes.store(max_bytes ? max_bytes : 1, std::memory_order_relaxed);
+}
+
+
+/*
+ * Answers an RPC request of the batch currently being dispatched on
+ * this thread. Looks the id up in the batch (linear; batches are small).
+ */
+EXP32 int sidecar_respond(uint64_t correlation_id, int32_t status, const uint8_t* data, uint32_t length)
+{
+  sidecar_t* sc = t_current;
+  if (!sc || !sc->batch) return 0;
+
+  for (uint32_t i = 0; i < sc->batch_size; i++)
+  {
+    const sidecar_msg_t& m = sc->batch[i];
+    if (!(m.flags & SIDECAR_MSG_RPC) || m.correlation_id != correlation_id) continue;
+    if (sc->answered[i]) return 0;
+
+    sc->answered[i] = 1;
+    post_response(sc, correlation_id, status, data, length);
+    if (sc->trace && sc->trace->batch[i].write_ns)
+      sc->trace->batch[i].emit_ns = trace_now();
+    return 1;
+  }
+  return 0;
+}
+
+
+/*
+ * Switches between copied and in-place command delivery. Like the
+ * batch limits, the worker copies the mode when it starts (the copy
+ * buffer exists only without zero-copy), so a running worker keeps it.
+ */
+EXP32 void sidecar_set_zero_copy(sidecar_t* sc, int enabled)
+{
+  if (!sc) return;
+  sc->zero_copy.store(enabled != 0, std::memory_order_relaxed);
+}
+
+
+/*
+ * Sets the thread options applied by the next start. The name is
+ * copied, so the caller's string need not outlive the call.
+ */
+EXP32 void sidecar_set_thread_options(sidecar_t* sc, const sidecar_thread_options_t* options)
+{
+  if (!sc) return;
+  sc->thread_options = options ? *options : sidecar_thread_options_t{};
+  sc->thread_name = options && options->name ? options->name : SIDECAR_DEFAULT_THREAD_NAME;
+  sc->thread_options.name = nullptr;
+}
+
+
+EXP32 uint32_t sidecar_thread_granted(sidecar_t* sc)
+{
+  return sc ? sc->granted.load(std::memory_order_acquire) : 0;
+}
+
+
+EXP32 uint64_t sidecar_trace_now()
+{
+  return trace_now();
+}
+
+
+/*
+ * Replaces the tracing state; a stopped worker is the only other user.
+ */
+EXP32 void sidecar_set_tracing(sidecar_t* sc, int enabled, uint32_t max_spans)
+{
+  if (!sc || sc->running.load()) return;
+
+  sc->trace.reset();
+  if (!enabled) return;
+
+  sc->trace = std::make_unique<sidecar_trace_t>();
+  sc->trace->spans.resize(max_spans);
+}
+
+
+EXP32 uint64_t sidecar_trace_count(sidecar_t* sc, int32_t stage)
+{
+  if (!sc || !sc->trace || stage < 0 || stage >= SIDECAR_TRACE_STAGES) return 0;
+  return sc->trace->stages[stage].count.load(std::memory_order_relaxed);
+}
+
+
+/*
+ * Walks the buckets until the percentile's rank is covered. The worker
+ * may add values meanwhile; the result is then off by those few.
+ */
+EXP32 uint64_t sidecar_trace_percentile(sidecar_t* sc, int32_t stage, double percentile)
+{
+  const uint64_t total = sidecar_trace_count(sc, stage);
+  if (total == 0) return 0;
+
+  const double clamped = (std::clamp)(percentile, 0.0, 100.0);
+  const uint64_t rank = (std::max)(uint64_t{ 1 }, static_cast<uint64_t>(clamped / 100.0 * total + 0.5));
+
+  const trace_histogram_t& h = sc->trace->stages[stage];
+  uint64_t seen = 0;
+  for (uint32_t b = 0; b < TRACE_BUCKETS; b++)
+  {
+    seen += h.buckets[b].load(std::memory_order_relaxed);
+    if (seen >= rank) return trace_bucket_value(b);
+  }
+  return trace_bucket_value(TRACE_BUCKETS - 1);
+}
+
+
+/*
+ * Writes the spans published so far as Chrome trace events.
  *
- * Requirements:
- *   - Must not be called twice without calling sidecar_stop()
+ * Every command is an async track ("b"/"e" pairs sharing its id):
+ * the "command" slice spans write to emit, the stages nest inside it.
  */
-EXP32 void sidecar_start(const sidecar_host_vtable_t* host, const sidecar_rb_desc_t* rbDesc)
+EXP32 int32_t sidecar_trace_dump(sidecar_t* sc, const char* path)
+{
+  if (!sc || !sc->trace || !path) return -1;
+
+  std::ofstream out(path, std::ios::trunc);
+  if (!out) return -1;
+
+  const uint32_t n = sc->trace->span_count.load(std::memory_order_acquire);
+  out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+
+  bool first = true;
+  const auto event = [&](const char* name, char phase, uint32_t id, uint64_t ns, const trace_span_t* args)
+  {
+    out << (first ? "" : ",\n") << "{\"name\":\"" << name << "\",\"cat\":\"sidecar\",\"ph\":\"" << phase
+      << "\",\"id\":" << id << ",\"pid\":1,\"tid\":1,\"ts\":" << ns / 1000.0;
+    if (args)
+      out << ",\"args\":{\"type\":" << args->type << ",\"bytes\":" << args->length << "}";
+    out << "}";
+    first = false;
+  };
+
+  for (uint32_t i = 0; i < n; i++)
+  {
+    const trace_span_t& s = sc->trace->spans[i];
+    const uint64_t done = (std::max)(s.end_ns, s.emit_ns);
+
+    event("command", 'b', i, s.write_ns, &s);
+    event("queue", 'b', i, s.write_ns, nullptr);
+    event("queue", 'e', i, s.read_ns, nullptr);
+    event("dispatch", 'b', i, s.read_ns, nullptr);
+    event("dispatch", 'e', i, s.start_ns, nullptr);
+    event("process", 'b', i, s.start_ns, nullptr);
+    event("process", 'e', i, s.end_ns, nullptr);
+    event("emit", 'b', i, s.end_ns, nullptr);
+    event("emit", 'e', i, done, nullptr);
+    event("command", 'e', i, done, nullptr);
+  }
+
+  out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+  return out.good() ? static_cast<int32_t>(n) : -1;
+}
+
+
+/*
+ * Swaps the journal; a stopped worker is the only other user.
+ */
+EXP32 int32_t sidecar_set_journal(sidecar_t* sc, const char* path, uint64_t segment_bytes)
+{
+  if (!sc || sc->running.load()) return 0;
+
+  journal_close(sc->journal);
+  sc->journal = nullptr;
+  if (!path) return 1;
+
+  sc->journal = journal_open(path, segment_bytes);
+  return sc->journal ? 1 : 0;
+}
+
+
+EXP32 uint64_t sidecar_journal_count(sidecar_t* sc)
+{
+  return sc ? journal_count(sc->journal) : 0;
+}
+
+
+EXP32 int64_t sidecar_journal_replay(const char* path, shared_rb_t* rb, double speed, int32_t timeout_ms)
+{
+  return journal_replay(path, rb, speed, timeout_ms);
+}
+
+
+/*
+ * Swaps the arena, like the journal only while stopped.
+ */
+EXP32 int32_t sidecar_set_arena(sidecar_t* sc, const char* name)
 {
-  if (g_running.load()) return; // Already running
+  if (!sc || sc->running.load()) return 0;
+
+  shared_arena_close(sc->arena);
+  sc->arena = nullptr;
+  if (!name) return 1;
 
-  g_host = host;
+  sc->arena = shared_arena_open(name);
+  return sc->arena ? 1 : 0;
+}
 
-  // Open the shared ring buffer created by the host
-  g_rb = shared_rb_open(rbDesc->name);
-  if (!g_rb) return;
 
-  g_running.store(true, std::memory_order_release);
+/*
+ * Returns the statistics block of the command ring.
+ */
+EXP32 const shared_rb_stats_t* sidecar_stats(sidecar_t* sc)
+{
+  return sc ? shared_rb_stats(sc->rb) : nullptr;
+}
+
+
+/*
+ * Opens a lane's ring; the worker builds its schedule from the lanes
+ * when it starts, so they only change while it is stopped.
+ */
+EXP32 int32_t sidecar_add_lane(sidecar_t* sc, const sidecar_rb_desc_t* ring, int32_t priority, uint32_t weight)
+{
+  if (!sc || sc->running.load() || !ring || !ring->name) return -1;
+  if (sc->lanes.size() >= SIDECAR_MAX_LANES) return -1;
+
+  shared_rb_t* rb = shared_rb_open(ring->name);
+  if (!rb) return -1;
+
+  sc->lanes.push_back({ rb, false, priority, weight ? weight : 1 });
+  return static_cast<int32_t>(sc->lanes.size() - 1);
+}
+
+
+EXP32 int32_t sidecar_set_lane(sidecar_t* sc, uint32_t lane, int32_t priority, uint32_t weight)
+{
+  if (!sc || sc->running.load() || lane >= sc->lanes.size()) return 0;
+
+  sc->lanes[lane].priority = priority;
+  sc->lanes[lane].weight = weight ? weight : 1;
+  return 1;
+}
+
+
+EXP32 void sidecar_set_lane_policy(sidecar_t* sc, int32_t policy)
+{
+  if (!sc) return;
+  sc->lane_policy = policy == SIDECAR_LANES_WEIGHTED ? SIDECAR_LANES_WEIGHTED : SIDECAR_LANES_STRICT;
+}
+
+
+EXP32 uint32_t sidecar_lane_count(sidecar_t* sc)
+{
+  return sc ? static_cast<uint32_t>(sc->lanes.size()) : 0;
+}
+
+
+EXP32 const shared_rb_stats_t* sidecar_lane_stats(sidecar_t* sc, uint32_t lane)
+{
+  if (!sc || lane >= sc->lanes.size()) return nullptr;
+  return shared_rb_stats(sc->lanes[lane].rb);
+}
+
+
+/*
+ * Starts the worker thread of a sidecar instance.
+ *
+ * Behavior:
+ *   - Spawns the worker thread
+ *   - Waits until the worker has applied its thread options
+ *     (affinity, scheduling policy, name), so sidecar_thread_granted
+ *     is valid on return
+ *   - Does nothing if the instance is already running
+ */
+EXP32 void sidecar_start_ex(sidecar_t* sc)
+{
+  if (!sc || sc->running.load()) return; // Already running
+
+  sc->running.store(true, std::memory_order_release);
+  sc->applied.store(false, std::memory_order_relaxed);
 
   // Launch the worker thread
-  g_thread = std::thread(sidecar_loop);
+  sc->thread = std::thread(sidecar_loop, sc);
 
-  // Optional: Increase thread priority for more responsive IPC
-  // THREAD_PRIORITY_ABOVE_NORMAL is usually enough,
-  // but THREAD_PRIORITY_HIGHEST gives maximum responsiveness.
-  SetThreadPriority(g_thread.native_handle(), THREAD_PRIORITY_HIGHEST);
+  sc->applied.wait(false, std::memory_order_acquire);
 }
 
 
 /*
- * Stops the sidecar worker thread.
+ * Stops the worker thread of a sidecar instance.
  *
  * Behavior:
- *   - Signals the worker loop to exit
+ *   - Signals the worker loop to exit and wakes it if it is parked
  *   - Joins the worker thread
- *   - Closes the shared ring buffer
- *   - Clears global state
+ *   - Keeps the rings open, so the instance can be started again
  *
  * Safe to call multiple times.
  */
-EXP32 void sidecar_stop()
+EXP32 void sidecar_stop_ex(sidecar_t* sc)
 {
-  if (!g_running.load()) return;
+  if (!sc || !sc->running.load()) return;
 
   // Signal the worker loop to exit
-  g_running.store(false, std::memory_order_release);
+  sc->running.store(false, std::memory_order_release);
+  shared_rb_notify(sc->rb);
 
   // Wait for the worker thread to finish
-  if (g_thread.joinable())
-    g_thread.join();
+  if (sc->thread.joinable())
+    sc->thread.join();
+}
+
+
+/*
+ * Destroys a sidecar instance.
+ *
+ * Behavior:
+ *   - Stops the worker thread if it is still running
+ *   - Closes the command journal, the arena, the extra lanes and the
+ *     shared ring buffers
+ *   - Frees the instance
+ */
+EXP32 void sidecar_destroy(sidecar_t* sc)
+{
+  if (!sc) return;
+
+  sidecar_stop_ex(sc);
+  journal_close(sc->journal);
+  shared_arena_close(sc->arena);
 
   // Release shared memory resources
-  shared_rb_close(g_rb);
-  g_rb = nullptr;
+  for (size_t i = 1; i < sc->lanes.size(); i++)
+    shared_rb_close(sc->lanes[i].rb);
+  shared_rb_close(sc->rb);
+  shared_rb_close(sc->events);
+
+  delete sc;
+}
+
+
+/*
+ * Starts the default sidecar instance.
+ *
+ * Parameters:
+ *   host   - Pointer to the host-provided callback table
+ *   rbDesc - Descriptor containing the shared ring buffer name and capacity
+ *
+ * Behavior:
+ *   - Thin wrapper: sidecar_create (command ring only) + sidecar_start_ex
+ *
+ * Requirements:
+ *   - Must not be called twice without calling sidecar_stop()
+ */
+EXP32 void sidecar_start(const sidecar_host_vtable_t* host, const sidecar_rb_desc_t* rbDesc)
+{
+  if (g_default) return; // Already running
 
-  // Clear host callback table
-  g_host = nullptr;
+  const sidecar_channel_desc_t channel{ *rbDesc, { nullptr, 0 } };
+  g_default = sidecar_create(host, &channel);
+  sidecar_start_ex(g_default);
+}
+
+
+/*
+ * Starts the default sidecar instance with a duplex channel.
+ *
+ * Behavior:
+ *   - Thin wrapper: sidecar_create (both rings) + sidecar_start_ex
+ */
+EXP32 void sidecar_start_duplex(const sidecar_host_vtable_t* host, const sidecar_channel_desc_t* channel)
+{
+  if (g_default) return; // Already running
+
+  g_default = sidecar_create(host, channel);
+  sidecar_start_ex(g_default);
+}
+
+
+/*
+ * Stops the default sidecar instance.
+ *
+ * Behavior:
+ *   - Thin wrapper: sidecar_destroy (stops, joins, closes the rings)
+ *
+ * Safe to call multiple times.
+ */
+EXP32 void sidecar_stop()
+{
+  sidecar_destroy(g_default);
+  g_default = nullptr;
 }
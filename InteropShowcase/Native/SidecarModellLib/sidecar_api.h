@@ -3,13 +3,92 @@
 #include "EXP32IMP32.h"
 
 
+/*
+ * One message of a batch handed to sidecar_host_vtable_t::ProcessBatch.
+ */
+struct sidecar_msg_t
+{
+  const uint8_t* data;      // Message payload (valid only during the call)
+  int32_t length;           // Number of bytes in the payload
+  uint16_t type;            // Record type on a framed ring, otherwise 0
+  uint16_t flags;           // Record flags on a framed ring, otherwise 0
+  uint64_t correlation_id;  // Request id if flags has SIDECAR_MSG_RPC, otherwise 0
+};
+
+
+/*
+ * Record flags of a command on a framed ring (sidecar_msg_t::flags).
+ *
+ *   SIDECAR_MSG_RPC    - The payload starts with a sidecar_rpc_hdr_t; the
+ *                        sidecar strips it, fills correlation_id and sends
+ *                        exactly one SIDECAR_EVENT_RPC_RESPONSE back
+ *   SIDECAR_MSG_TRACED - The payload starts with a sidecar_trace_hdr_t
+ *                        (before any sidecar_rpc_hdr_t); the sidecar
+ *                        strips it and, with tracing enabled, times the
+ *                        message (see sidecar_set_tracing)
+ *   SIDECAR_MSG_ARENA  - After the prefixes above, the payload is a
+ *                        shared_arena_desc_t; the sidecar delivers the
+ *                        arena run in place and releases it after the
+ *                        batch (see sidecar_set_arena)
+ */
+enum sidecar_msg_flags_t : uint16_t
+{
+  SIDECAR_MSG_RPC = 1u << 0,
+  SIDECAR_MSG_TRACED = 1u << 1,
+  SIDECAR_MSG_ARENA = 1u << 2,
+};
+
+
+/*
+ * Event ids the sidecar itself emits.
+ *
+ *   SIDECAR_EVENT_ACK          - "OK" after every plain (non-RPC) command
+ *   SIDECAR_EVENT_RPC_RESPONSE - Payload: sidecar_rpc_hdr_t + response bytes
+ */
+enum sidecar_event_id_t : int32_t
+{
+  SIDECAR_EVENT_ACK = 1,
+  SIDECAR_EVENT_RPC_RESPONSE = 2,
+};
+
+
+/*
+ * Prefix of an RPC request payload (command ring) and of an RPC response
+ * payload (SIDECAR_EVENT_RPC_RESPONSE).
+ *
+ * The host picks a unique correlation_id per request and matches the
+ * response by it, so any number of requests can be in flight at once.
+ */
+struct sidecar_rpc_hdr_t
+{
+  uint64_t correlation_id;  // Chosen by the host, echoed in the response
+  int32_t status;           // Response status (0 = success); 0 in requests
+  uint32_t reserved;        // Zero
+};
+
+
+/*
+ * Prefix of a sampled command (SIDECAR_MSG_TRACED).
+ *
+ * The host stamps it right before writing the record, with the clock of
+ * sidecar_trace_now (monotonic, shared by all processes on the machine).
+ */
+struct sidecar_trace_hdr_t
+{
+  uint64_t write_ns;        // sidecar_trace_now() at write
+};
+
+
 /*
  * Host-side virtual function table.
  *
  * The host (managed side) provides a set of callbacks that the sidecar
- * (native worker process) can invoke during its lifecycle.
+ * worker thread invokes during its lifecycle. The worker runs inside the
+ * host process (sidecar_start, sidecar_create), or in the SidecarWorker
+ * process, where a plugin library provides the table
+ * (see sidecar_process_spawn).
  *
- * All function pointers use C ABI and must remain stable across processes.
+ * All function pointers use C ABI.
  */
 struct sidecar_host_vtable_t
 {
@@ -29,6 +108,13 @@ struct sidecar_host_vtable_t
   // 'data'    - pointer to event payload
   // 'length'  - number of bytes in the payload
   void (*OnEvent)(int eventId, const uint8_t* data, int length);
+
+  // Optional: called with every message drained in one loop iteration
+  // (see sidecar_set_batch_limits), one transition for the whole batch.
+  // If nullptr, the sidecar calls Process once per message instead.
+  // 'messages' - array of (pointer, length) entries, in ring order
+  // 'count'    - number of entries
+  void (*ProcessBatch)(const sidecar_msg_t* messages, int count);
 };
 
 
@@ -48,6 +134,32 @@ struct sidecar_rb_desc_t
 };
 
 
+/*
+ * Describes both shared rings of a duplex host <-> sidecar channel.
+ *
+ * The host creates both rings; the sidecar opens them by name.
+ *   - commands: host -> sidecar, byte stream (as with sidecar_start)
+ *   - events:   sidecar -> host, sidecar_event_hdr_t records
+ */
+struct sidecar_channel_desc_t
+{
+  sidecar_rb_desc_t commands; // Command ring (host writes, sidecar reads)
+  sidecar_rb_desc_t events;   // Event ring (sidecar writes, host reads)
+};
+
+
+/*
+ * Header of one record in the event ring, followed by 'length' payload
+ * bytes. Header and payload are published together (shared_rb_writev),
+ * so the host never sees a partial record.
+ */
+struct sidecar_event_hdr_t
+{
+  int32_t  event_id; // Numeric event identifier (as for OnEvent)
+  uint32_t length;   // Number of payload bytes following the header
+};
+
+
 /*
  * Stops the sidecar worker thread.
  *
@@ -81,3 +193,690 @@ EXP32 void sidecar_stop();
  */
 EXP32 void sidecar_start(const sidecar_host_vtable_t* host,
   const sidecar_rb_desc_t* rb);
+
+
+/*
+ * Starts the sidecar worker thread with a duplex channel.
+ *
+ * Parameters:
+ *   host    - Pointer to the host-provided vtable (Init/Dispose/Process/OnEvent)
+ *   channel - Command and event ring descriptors
+ *
+ * Notes:
+ *   - Behaves like sidecar_start, but events are written as records into
+ *     the event ring instead of calling host->OnEvent on the sidecar thread
+ *   - The host drains the event ring in batches on its own thread
+ *   - host->OnEvent may be nullptr; it is only used without an event ring
+ *   - If the event ring is full, the sidecar waits for the host to drain it
+ *     (backpressure) until sidecar_stop is called
+ *   - Stop with sidecar_stop
+ */
+EXP32 void sidecar_start_duplex(const sidecar_host_vtable_t* host,
+  const sidecar_channel_desc_t* channel);
+
+
+/*
+ * Opaque handle of one sidecar instance.
+ *
+ * Each instance owns its rings, its worker thread and a copy of the host
+ * vtable, so a process can run several independent sidecars (e.g. one per
+ * core or per tenant). The classic sidecar_start/sidecar_stop calls drive
+ * a single default instance.
+ */
+struct sidecar_t;
+
+
+/*
+ * Creates a sidecar instance without starting it.
+ *
+ * Parameters:
+ *   host    - Host callbacks; the table is copied, the functions must stay valid
+ *   channel - Command ring, and optionally an event ring (events.name may be
+ *             nullptr: events then go to host->OnEvent)
+ *
+ * Returns:
+ *   Handle on success
+ *   nullptr if a ring cannot be opened
+ *
+ * Notes:
+ *   - The callbacks carry no instance argument; hosts running several
+ *     sidecars with the same callbacks tell them apart by their rings
+ */
+EXP32 sidecar_t* sidecar_create(const sidecar_host_vtable_t* host,
+  const sidecar_channel_desc_t* channel);
+
+
+/*
+ * Starts the worker thread of a sidecar instance.
+ * Does nothing if it is already running.
+ */
+EXP32 void sidecar_start_ex(sidecar_t* sc);
+
+
+/*
+ * Stops the worker thread of a sidecar instance (signal + join).
+ * The rings stay open; the instance can be started again.
+ * Safe to call multiple times.
+ */
+EXP32 void sidecar_stop_ex(sidecar_t* sc);
+
+
+/*
+ * Stops a sidecar instance if needed, closes its rings and frees it.
+ */
+EXP32 void sidecar_destroy(sidecar_t* sc);
+
+
+/*
+ * Configures how the worker loop waits while the command ring is empty.
+ *
+ * Parameters:
+ *   sc     - Sidecar instance
+ *   spins  - Busy-spin iterations with a pause instruction
+ *   yields - Time-slice yields after spinning
+ *
+ * Notes:
+ *   - After both phases the worker parks until the host writes a command;
+ *     the host's shared_rb_write only signals it while it is parked
+ *   - Defaults: 2000 spins, 50 yields; (0, 0) parks immediately and
+ *     keeps idle CPU at zero, larger values trade CPU for latency
+ */
+EXP32 void sidecar_set_wait_strategy(sidecar_t* sc, uint32_t spins, uint32_t yields);
+
+
+/*
+ * Limits how much one loop iteration drains before dispatching.
+ *
+ * Parameters:
+ *   sc        - Sidecar instance
+ *   max_count - Maximum number of messages per batch (at least 1)
+ *   max_bytes - Maximum number of payload bytes per batch (at least 1)
+ *
+ * Notes:
+ *   - On a framed command ring (SHARED_RB_FRAMED) a message is exactly
+ *     one record; a record larger than max_bytes forms a batch of its own
+ *   - On a raw ring a message is one read of up to 1024 bytes, as before
+ *     batching; commands written back to back may share one
+ *     (see sidecar_set_zero_copy for in-place delivery without the cap)
+ *   - The batch is handed to host->ProcessBatch, or to host->Process
+ *     message by message if ProcessBatch is nullptr
+ *   - Defaults: 64 messages, 64 KB; takes effect on the next
+ *     sidecar_start_ex
+ */
+EXP32 void sidecar_set_batch_limits(sidecar_t* sc, uint32_t max_count, uint32_t max_bytes);
+
+
+/*
+ * Enables or disables zero-copy delivery of commands.
+ *
+ * Parameters:
+ *   sc      - Sidecar instance
+ *   enabled - Non-zero: Process/ProcessBatch receive pointers straight
+ *             into the shared command ring; zero: commands are copied
+ *             into a private buffer first (default)
+ *
+ * Notes:
+ *   - The tail is advanced only after the callback returns, so the data
+ *     stays valid (and the host cannot overwrite it) during the call
+ *   - Framed ring: one message per record; a record whose payload wraps
+ *     around the end of a plain ring is copied once into a scratch buffer
+ *   - Raw ring: no 1024-byte message cap; one message is the whole
+ *     readable region, up to the batch byte budget. A region that wraps
+ *     around the end of a plain ring arrives as two messages
+ *   - Create the ring with SHARED_RB_MIRRORED to never copy
+ *   - Takes effect on the next sidecar_start_ex
+ */
+EXP32 void sidecar_set_zero_copy(sidecar_t* sc, int enabled);
+
+
+/*
+ * Answers an RPC request.
+ *
+ * Parameters:
+ *   correlation_id - sidecar_msg_t::correlation_id of the request
+ *   status         - Application status (0 = success)
+ *   data           - Response payload (may be nullptr if length is 0)
+ *   length         - Number of payload bytes
+ *
+ * Returns:
+ *   1 if the response was sent
+ *   0 if not called from Process/ProcessBatch on the sidecar thread, if
+ *     the id is not part of the current batch or was already answered
+ *
+ * Notes:
+ *   - Call from inside Process/ProcessBatch; the sidecar answers every
+ *     request left unanswered when the callback returns with an empty
+ *     status-0 response, so each request gets exactly one response
+ *   - Responses travel on the event ring (or host->OnEvent without one)
+ *     as SIDECAR_EVENT_RPC_RESPONSE
+ */
+EXP32 int sidecar_respond(uint64_t correlation_id, int32_t status, const uint8_t* data, uint32_t length);
+
+/*
+ * Scheduling policies of the worker thread (sidecar_thread_options_t).
+ *
+ *   SIDECAR_SCHED_DEFAULT - Platform default: THREAD_PRIORITY_HIGHEST on
+ *                           Windows, the inherited policy on Linux
+ *   SIDECAR_SCHED_OTHER   - Time-sharing; priority is a nice value
+ *                           (-20..19, lower = more CPU share)
+ *   SIDECAR_SCHED_FIFO    - Real-time FIFO; priority is 1..99 on Linux
+ *                           (needs CAP_SYS_NICE or RLIMIT_RTPRIO),
+ *                           THREAD_PRIORITY_TIME_CRITICAL on Windows
+ */
+enum sidecar_sched_policy_t : int32_t
+{
+  SIDECAR_SCHED_DEFAULT = 0,
+  SIDECAR_SCHED_OTHER = 1,
+  SIDECAR_SCHED_FIFO = 2,
+};
+
+
+/*
+ * Settings reported by sidecar_thread_granted.
+ */
+enum sidecar_thread_granted_t : uint32_t
+{
+  SIDECAR_THREAD_AFFINITY = 1u << 0,
+  SIDECAR_THREAD_SCHED = 1u << 1,
+  SIDECAR_THREAD_NAME = 1u << 2,
+};
+
+
+/*
+ * Placement and scheduling of the worker thread.
+ *
+ * Fields:
+ *   affinity_mask - Bit n allows logical CPU n; 0 keeps every CPU
+ *   policy        - sidecar_sched_policy_t
+ *   priority      - Nice value (OTHER) or real-time priority (FIFO);
+ *                   ignored for DEFAULT
+ *   name          - Thread name shown by debuggers, top and perf;
+ *                   nullptr keeps "sidecar". Linux truncates to 15 bytes
+ */
+struct sidecar_thread_options_t
+{
+  uint64_t affinity_mask;
+  int32_t policy;
+  int32_t priority;
+  const char* name;
+};
+
+
+/*
+ * Sets the placement and scheduling of the worker thread.
+ *
+ * Parameters:
+ *   sc      - Sidecar instance
+ *   options - Options to apply; nullptr restores the defaults
+ *
+ * Notes:
+ *   - The worker applies the options to itself before host->Init, so
+ *     the whole command loop runs with them; sidecar_start_ex returns
+ *     once they are applied
+ *   - Best effort: a mask without an online CPU, a missing privilege
+ *     for SIDECAR_SCHED_FIFO or a negative nice value is not an error;
+ *     sidecar_thread_granted reports what took effect
+ *   - Windows: the mask covers processor group 0 (up to 64 CPUs); a
+ *     nice value maps to the nearest THREAD_PRIORITY_* level
+ *   - Pin the worker to a core the host threads do not use (ideally an
+ *     isolated one) for stable tail latency
+ *   - Takes effect on the next sidecar_start_ex
+ */
+EXP32 void sidecar_set_thread_options(sidecar_t* sc, const sidecar_thread_options_t* options);
+
+
+/*
+ * Returns the sidecar_thread_granted_t bits that the worker applied when
+ * it was last started (0 before the first start).
+ */
+EXP32 uint32_t sidecar_thread_granted(sidecar_t* sc);
+
+
+/*
+ * Returns the statistics block of the command ring (see shared_rb_stats_t):
+ * host writes, sidecar reads, idle polls and parks, and the number and
+ * duration of Process/ProcessBatch calls.
+ *
+ * Notes:
+ *   - The block lives in shared memory; the host can equally read it
+ *     through its own shared_rb_stats, and external tools by mapping the
+ *     ring, without any call into the sidecar
+ *   - The event ring (duplex channel) has its own block; there the
+ *     sidecar is the producer, so full_rejections counts dropped events
+ */
+struct shared_rb_stats_t;
+EXP32 const shared_rb_stats_t* sidecar_stats(sidecar_t* sc);
+
+
+/*
+ * Input lanes: extra command rings, each with a priority and a weight.
+ *
+ * Lane 0 is the command ring of the channel (priority 0, weight 1);
+ * sidecar_add_lane adds more. Every lane is an ordinary command ring
+ * (framed or raw, copied or zero-copy delivery as configured), and one
+ * batch never mixes lanes. Lanes let small control commands bypass a
+ * queue of bulk work instead of waiting behind it.
+ */
+constexpr uint32_t SIDECAR_MAX_LANES = 8;
+
+
+/*
+ * How the worker picks the lane of the next batch (sidecar_set_lane_policy).
+ *
+ *   SIDECAR_LANES_STRICT   - The readable lane with the highest priority
+ *                            (ties: lowest index). A busy high lane
+ *                            starves the lower ones by design
+ *   SIDECAR_LANES_WEIGHTED - Weighted round-robin: each readable lane in
+ *                            turn gets up to weight batches in a row
+ */
+enum sidecar_lane_policy_t : int32_t
+{
+  SIDECAR_LANES_STRICT = 0,
+  SIDECAR_LANES_WEIGHTED = 1,
+};
+
+
+/*
+ * Adds an input lane.
+ *
+ * Parameters:
+ *   sc       - Sidecar instance (stopped)
+ *   ring     - Ring created by the host; the sidecar opens it by name
+ *   priority - Higher is served first (SIDECAR_LANES_STRICT)
+ *   weight   - Batches per round (SIDECAR_LANES_WEIGHTED); 0 counts as 1
+ *
+ * Returns:
+ *   Index of the new lane (1..SIDECAR_MAX_LANES-1), or -1 if the
+ *   instance is running, the lane limit is reached or the ring cannot
+ *   be opened
+ *
+ * Notes:
+ *   - The worker waits on all lanes at once (shared_rb_wait_any), with
+ *     the wait strategy of lane 0; a write to any lane wakes it
+ *   - Lanes stay open until sidecar_destroy
+ */
+EXP32 int32_t sidecar_add_lane(sidecar_t* sc, const sidecar_rb_desc_t* ring, int32_t priority, uint32_t weight);
+
+
+/*
+ * Changes the priority and weight of a lane (lane 0 included).
+ *
+ * Returns:
+ *   1 on success, 0 if the lane does not exist or the instance is running
+ */
+EXP32 int32_t sidecar_set_lane(sidecar_t* sc, uint32_t lane, int32_t priority, uint32_t weight);
+
+
+/*
+ * Selects the sidecar_lane_policy_t (default SIDECAR_LANES_STRICT).
+ * Takes effect on the next sidecar_start_ex.
+ */
+EXP32 void sidecar_set_lane_policy(sidecar_t* sc, int32_t policy);
+
+
+/*
+ * Returns the number of lanes, lane 0 included.
+ */
+EXP32 uint32_t sidecar_lane_count(sidecar_t* sc);
+
+
+/*
+ * Returns the statistics block of a lane's ring (see sidecar_stats,
+ * which equals lane 0), or nullptr if the lane does not exist.
+ *
+ * Notes:
+ *   - messages_read, empty_polls and process_calls / process_ns are
+ *     counted per lane, so the blocks show how the worker splits its
+ *     time; high_water and full_rejections show which lane backs up
+ */
+EXP32 const shared_rb_stats_t* sidecar_lane_stats(sidecar_t* sc, uint32_t lane);
+
+
+/*
+ * Latency stages of a traced command (sidecar_trace_percentile).
+ *
+ *   SIDECAR_TRACE_QUEUE    - Host write -> sidecar read (time in the ring,
+ *                            including the sidecar's wakeup)
+ *   SIDECAR_TRACE_DISPATCH - Sidecar read -> callback start
+ *   SIDECAR_TRACE_PROCESS  - Process / ProcessBatch call
+ *   SIDECAR_TRACE_EMIT     - Callback end -> ack or response written
+ *                            (0 for responses sent from inside the callback)
+ *   SIDECAR_TRACE_TOTAL    - Host write -> ack or response written
+ */
+enum sidecar_trace_stage_t : int32_t
+{
+  SIDECAR_TRACE_QUEUE = 0,
+  SIDECAR_TRACE_DISPATCH = 1,
+  SIDECAR_TRACE_PROCESS = 2,
+  SIDECAR_TRACE_EMIT = 3,
+  SIDECAR_TRACE_TOTAL = 4,
+  SIDECAR_TRACE_STAGES = 5,
+};
+
+
+/*
+ * Returns the trace clock in nanoseconds (steady_clock: CLOCK_MONOTONIC
+ * on Linux, QueryPerformanceCounter on Windows). Comparable across
+ * processes on the same machine; hosts stamp sidecar_trace_hdr_t with it.
+ */
+EXP32 uint64_t sidecar_trace_now();
+
+
+/*
+ * Enables or disables latency tracing.
+ *
+ * Parameters:
+ *   sc        - Sidecar instance (must be stopped)
+ *   enabled   - Non-zero: time every SIDECAR_MSG_TRACED command; zero:
+ *               strip the trace prefix and ignore it (default)
+ *   max_spans - Number of traced commands kept for sidecar_trace_dump;
+ *               later ones only feed the histograms
+ *
+ * Notes:
+ *   - Sampling is the host's choice: it flags and stamps every n-th
+ *     command. Untraced commands cost one flag test; with tracing
+ *     disabled the loop takes no timestamps at all
+ *   - The worker is the only writer of the histograms (HDR-style,
+ *     log-linear, < 3.2% relative error), so recording is lock-free
+ *     and readers on other threads never block it
+ *   - Enabling resets histograms and spans; takes effect on the next
+ *     sidecar_start_ex
+ */
+EXP32 void sidecar_set_tracing(sidecar_t* sc, int enabled, uint32_t max_spans);
+
+
+/*
+ * Returns the number of traced commands recorded for a stage.
+ */
+EXP32 uint64_t sidecar_trace_count(sidecar_t* sc, int32_t stage);
+
+
+/*
+ * Returns a latency percentile of a stage in nanoseconds.
+ *
+ * Parameters:
+ *   sc         - Sidecar instance
+ *   stage      - sidecar_trace_stage_t
+ *   percentile - 0..100 (e.g. 50, 99, 99.9)
+ *
+ * Returns:
+ *   The value at the percentile (midpoint of its bucket)
+ *   0 if tracing is disabled or nothing was recorded
+ */
+EXP32 uint64_t sidecar_trace_percentile(sidecar_t* sc, int32_t stage, double percentile);
+
+
+/*
+ * Writes the recorded spans as Chrome trace JSON (chrome://tracing,
+ * ui.perfetto.dev).
+ *
+ * Parameters:
+ *   sc   - Sidecar instance; may be running
+ *   path - Output file
+ *
+ * Returns:
+ *   Number of commands written, or -1 if tracing is disabled or the
+ *   file cannot be written
+ *
+ * Notes:
+ *   - One async track per command: queue, dispatch, process and emit
+ *     slices nested in a "command" slice, timestamps in microseconds
+ */
+EXP32 int32_t sidecar_trace_dump(sidecar_t* sc, const char* path);
+
+
+/*
+ * Records every command the worker drains into a command journal.
+ *
+ * Parameters:
+ *   sc            - Sidecar instance (must be stopped)
+ *   path          - File prefix of the journal, or nullptr to stop
+ *                   journaling; segments are "<path>.000000", ...
+ *   segment_bytes - Size of one segment file (0: 64 MB, at least 64 KB)
+ *
+ * Returns:
+ *   1 if journaling is on (or was switched off), 0 if the first segment
+ *   cannot be created
+ *
+ * Notes:
+ *   - One entry per command as drained: timestamp (sidecar_trace_now),
+ *     record type and flags, and the payload with its trace / RPC
+ *     prefixes, so a replay reproduces the exact command stream
+ *   - Segments are memory-mapped files written front to back by the
+ *     worker (no syscall per command); a full segment is truncated to
+ *     its used size and the next one is created
+ *   - Replaces the segments of an earlier journal at the same path;
+ *     the journal stays open across restarts until switched off
+ *   - With several lanes, the commands of all lanes share the journal
+ *     in the order they were served; a replay feeds them into one ring
+ *   - Arena messages are journaled as their descriptors, not the block
+ *     contents; replayed, they no longer resolve and arrive empty
+ */
+EXP32 int32_t sidecar_set_journal(sidecar_t* sc, const char* path, uint64_t segment_bytes);
+
+
+/*
+ * Returns the number of commands journaled since sidecar_set_journal.
+ */
+EXP32 uint64_t sidecar_journal_count(sidecar_t* sc);
+
+
+struct shared_rb_t;
+
+/*
+ * Replays a command journal into a command ring.
+ *
+ * Parameters:
+ *   path       - File prefix given to sidecar_set_journal
+ *   rb         - Command ring of the sidecar under test (producer side)
+ *   speed      - 1.0 keeps the recorded gaps between commands, 2.0 plays
+ *                twice as fast, etc.; 0 writes flat out (as fast as the
+ *                sidecar drains)
+ *   timeout_ms - Longest wait for ring space per command; negative
+ *                waits forever
+ *
+ * Returns:
+ *   Number of commands written, or -1 if the journal cannot be opened
+ *
+ * Notes:
+ *   - Runs on the calling thread until the journal ends; the caller
+ *     drains acks and responses elsewhere (or the event ring fills up)
+ *   - Writes block on ring space (SHARED_RB_WRITE_BLOCK), so no command
+ *     is lost; a wait that times out ends the replay early
+ *   - Traced commands are re-stamped at write time
+ */
+EXP32 int64_t sidecar_journal_replay(const char* path, shared_rb_t* rb, double speed, int32_t timeout_ms);
+
+
+/*
+ * Attaches a payload arena (see shared_arena.h) for SIDECAR_MSG_ARENA
+ * commands.
+ *
+ * Parameters:
+ *   sc   - Sidecar instance (must be stopped)
+ *   name - Name of an arena the host created, or nullptr to detach
+ *
+ * Returns:
+ *   1 if the arena is attached (or was detached), 0 if it cannot be
+ *   opened
+ *
+ * Notes:
+ *   - Large payloads stay in the arena; only the 16-byte descriptor
+ *     passes through the command ring, which keeps room for small
+ *     commands while a large one is in flight
+ *   - Process/ProcessBatch receive a pointer into the arena, valid
+ *     during the call; the run is released after the batch, before the
+ *     ack or response is written, so a host that waits for the ack can
+ *     reuse the blocks right away
+ *   - A descriptor that does not resolve (no arena attached, stale or
+ *     out of range) is delivered as an empty message
+ */
+EXP32 int32_t sidecar_set_arena(sidecar_t* sc, const char* name);
+
+
+/*
+ * Out-of-process sidecar.
+ *
+ * SidecarWorker (Native/SidecarWorker) is a standalone executable that
+ * opens the host's named rings and runs the worker loop in a process of
+ * its own: own address space, no contention with the host runtime's GC
+ * and threads, and a pid that can be pinned, reniced or put into a
+ * cgroup / job object on its own. The ring protocol is the same as for
+ * an in-process sidecar, so the host writes commands and drains events
+ * unchanged.
+ *
+ * Callbacks cannot cross the process boundary: the worker processes
+ * commands with a plugin library (SIDECAR_PLUGIN_ENTRY), or without one
+ * with its built-in handler, which echoes every RPC request back as its
+ * response. Plain commands are acknowledged as usual.
+ *
+ * Command line:
+ *   SidecarWorker --commands <name> [--events <name>] [--plugin <library>]
+ *                 [--lane <name>:<priority>:<weight>]... [--lane-policy strict|weighted]
+ *                 [--batch <count>:<bytes>] [--zero-copy] [--affinity <mask>]
+ *                 [--arena <name>]
+ *
+ * The worker runs until its standard input reaches end of file: when the
+ * launcher closes the pipe, or when the host process dies, so a worker
+ * never outlives its host.
+ */
+
+
+/*
+ * Exit codes of SidecarWorker. The launcher does not restart a worker
+ * that exits with one of the configuration errors: a restart would fail
+ * the same way.
+ */
+enum sidecar_worker_exit_t : int32_t
+{
+  SIDECAR_EXIT_OK = 0,        // Stopped through its standard input
+  SIDECAR_EXIT_USAGE = 2,     // Invalid command line
+  SIDECAR_EXIT_PLUGIN = 3,    // Plugin not found or without entry point
+  SIDECAR_EXIT_RINGS = 4,     // A ring (command, event or lane) or the arena cannot be opened
+};
+
+
+/*
+ * Entry point a plugin library exports under the name
+ * SIDECAR_PLUGIN_ENTRY (extern "C"). Returns the callback table the
+ * worker runs with; Init, Dispose and Process or ProcessBatch are
+ * required, OnEvent is only used without an event ring. The table must
+ * stay valid until the worker exits.
+ */
+typedef const sidecar_host_vtable_t* (*sidecar_plugin_entry_t)();
+constexpr const char* SIDECAR_PLUGIN_ENTRY = "sidecar_plugin_vtable";
+
+
+/*
+ * Describes a SidecarWorker process for sidecar_process_spawn.
+ *
+ * Fields:
+ *   executable       - Path of the SidecarWorker executable
+ *   channel          - Rings created by the host; passed as --commands
+ *                      and --events (events.name may be nullptr)
+ *   plugin           - Plugin library passed as --plugin, or nullptr
+ *   args             - Further arguments (lanes, batch limits, affinity),
+ *                      or nullptr
+ *   arg_count        - Number of entries in args
+ *   max_restarts     - Restarts after unexpected exits before giving up;
+ *                      UINT32_MAX restarts forever
+ *   restart_delay_ms - Delay before the first restart (0: 100 ms); it
+ *                      doubles for every worker that dies within 10 s of
+ *                      its start, up to 5 s
+ */
+struct sidecar_process_desc_t
+{
+  const char* executable;
+  sidecar_channel_desc_t channel;
+  const char* plugin;
+  const char* const* args;
+  uint32_t arg_count;
+  uint32_t max_restarts;
+  uint32_t restart_delay_ms;
+};
+
+
+/*
+ * States of a supervised worker (sidecar_process_state).
+ */
+enum sidecar_process_state_t : int32_t
+{
+  SIDECAR_PROCESS_STOPPED = 0,     // sidecar_process_stop was called
+  SIDECAR_PROCESS_RUNNING = 1,     // Worker process alive
+  SIDECAR_PROCESS_RESTARTING = 2,  // Worker died; waiting out the restart delay
+  SIDECAR_PROCESS_FAILED = 3,      // Restarts used up, or a configuration error
+};
+
+
+/*
+ * Opaque handle of a supervised worker process.
+ */
+struct sidecar_process_t;
+
+
+/*
+ * Starts a SidecarWorker process and supervises it.
+ *
+ * Parameters:
+ *   desc - Process description; copied, so it need not outlive the call
+ *
+ * Returns:
+ *   Handle of the supervised worker, or nullptr if the executable
+ *   cannot be started
+ *
+ * Notes:
+ *   - Create the rings before the call; the worker opens them by name
+ *   - The worker's standard input is a pipe held by the launcher; its
+ *     output and error streams are the host's
+ *   - A supervisor thread waits for the worker to exit. After an exit
+ *     that sidecar_process_stop did not ask for, it restarts the worker
+ *     with the same arguments after the restart delay. The rings keep
+ *     their contents, so the new worker continues at the tail the old
+ *     one left: commands the dead worker had drained but not finished
+ *     are lost with copied delivery, and delivered again with zero-copy
+ *     delivery (the tail only moves after processing)
+ */
+EXP32 sidecar_process_t* sidecar_process_spawn(const sidecar_process_desc_t* desc);
+
+
+/*
+ * Returns the sidecar_process_state_t of a supervised worker.
+ */
+EXP32 int32_t sidecar_process_state(sidecar_process_t* proc);
+
+
+/*
+ * Returns the pid of the current worker process, or 0 while none runs.
+ */
+EXP32 int64_t sidecar_process_pid(sidecar_process_t* proc);
+
+
+/*
+ * Returns the number of restarts so far.
+ */
+EXP32 uint32_t sidecar_process_restarts(sidecar_process_t* proc);
+
+
+/*
+ * Returns the exit code of the last worker that exited (128 + signal
+ * number if a signal ended it on Linux), or -1 if none has exited yet.
+ */
+EXP32 int32_t sidecar_process_exit_code(sidecar_process_t* proc);
+
+
+/*
+ * Stops a supervised worker and frees the handle.
+ *
+ * Parameters:
+ *   proc       - Handle returned by sidecar_process_spawn
+ *   timeout_ms - Time the worker gets to finish its batch and exit;
+ *                negative waits forever
+ *
+ * Notes:
+ *   - Closes the worker's standard input; the worker stops its loop
+ *     (host->Dispose runs) and exits. A worker still running after
+ *     timeout_ms is killed
+ *   - Ends the supervision: no restart follows
+ *   - The rings stay open; the host closes them
+ */
+EXP32 void sidecar_process_stop(sidecar_process_t* proc, int32_t timeout_ms);
@@ -0,0 +1,407 @@
+#include "pch.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sidecar_journal.h"
+#include "sidecar_api.h"
+#include "shared_ringbuffer.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+/*
+ * One mapped segment file.
+ */
+struct journal_file_t
+{
+#if defined(_WIN32)
+  HANDLE file = INVALID_HANDLE_VALUE;  // Segment file
+  HANDLE mapping = nullptr;            // File mapping of it
+#else
+  int fd = -1;                         // Segment file
+#endif
+  uint8_t* base = nullptr;             // Start of the mapping (segment header)
+  uint64_t size = 0;                   // Mapped size in bytes
+};
+
+
+/*
+ * Internal representation of a journal writer.
+ */
+struct journal_t
+{
+  std::string path;                    // File prefix
+  uint64_t segment_bytes = 0;          // Size of a new segment
+  uint32_t index = 0;                  // Current segment number
+  journal_file_t file;                 // Current segment, or base == nullptr
+  uint64_t used = 0;                   // Entry bytes in the current segment
+  std::atomic<uint64_t> count{ 0 };    // Entries appended (journal_count)
+};
+
+
+/*
+ * Returns the file name of segment index.
+ */
+static std::string segment_path(const std::string& path, uint32_t index)
+{
+  char suffix[16];
+  std::snprintf(suffix, sizeof(suffix), ".%06u", index);
+  return path + suffix;
+}
+
+
+/*
+ * Returns the journal bytes taken by an entry with length payload bytes.
+ */
+static uint64_t entry_size(uint32_t length)
+{
+  return (sizeof(journal_entry_hdr_t) + uint64_t{ length } + JOURNAL_ALIGN - 1) & ~uint64_t{ JOURNAL_ALIGN - 1 };
+}
+
+
+#if defined(_WIN32)
+
+/*
+ * Creates (or replaces) a segment file of size bytes and maps it
+ * writable. FILE_FLAG_SEQUENTIAL_SCAN tunes the cache manager for the
+ * front-to-back access of both the writer and the replay.
+ */
+static bool create_file(const std::string& path, uint64_t size, journal_file_t* f)
+{
+  f->file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+    CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (f->file == INVALID_HANDLE_VALUE) return false;
+
+  f->mapping = CreateFileMappingA(f->file, nullptr, PAGE_READWRITE,
+    static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+  f->base = f->mapping ? static_cast<uint8_t*>(MapViewOfFile(f->mapping, FILE_MAP_WRITE, 0, 0, 0)) : nullptr;
+  f->size = size;
+  return f->base != nullptr;
+}
+
+
+/*
+ * Maps an existing segment file read-only.
+ */
+static bool open_file(const std::string& path, journal_file_t* f)
+{
+  f->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (f->file == INVALID_HANDLE_VALUE) return false;
+
+  LARGE_INTEGER size{};
+  if (!GetFileSizeEx(f->file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(journal_segment_hdr_t)))
+    return false;
+
+  f->mapping = CreateFileMappingA(f->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  f->base = f->mapping ? static_cast<uint8_t*>(MapViewOfFile(f->mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+  f->size = static_cast<uint64_t>(size.QuadPart);
+  return f->base != nullptr;
+}
+
+
+/*
+ * Unmaps and closes a segment file. keep: truncate the file to keep
+ * bytes (after unmapping, which Windows requires), or UINT64_MAX.
+ */
+static void close_file(journal_file_t* f, uint64_t keep)
+{
+  if (f->base)
+    UnmapViewOfFile(f->base);
+  if (f->mapping)
+    CloseHandle(f->mapping);
+
+  if (f->file != INVALID_HANDLE_VALUE)
+  {
+    LARGE_INTEGER end{};
+    end.QuadPart = static_cast<LONGLONG>(keep);
+    if (keep != UINT64_MAX && SetFilePointerEx(f->file, end, nullptr, FILE_BEGIN))
+      SetEndOfFile(f->file);
+    CloseHandle(f->file);
+  }
+
+  *f = journal_file_t{};
+}
+
+#else
+
+/*
+ * Creates (or replaces) a segment file of size bytes and maps it
+ * writable. ftruncate leaves a sparse file; MADV_SEQUENTIAL lets the
+ * kernel write back and drop pages behind the writer early.
+ */
+static bool create_file(const std::string& path, uint64_t size, journal_file_t* f)
+{
+  f->fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (f->fd < 0 || ftruncate(f->fd, static_cast<off_t>(size)) != 0) return false;
+
+  void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, f->fd, 0);
+  if (base == MAP_FAILED) return false;
+
+  madvise(base, size, MADV_SEQUENTIAL);
+  f->base = static_cast<uint8_t*>(base);
+  f->size = size;
+  return true;
+}
+
+
+/*
+ * Maps an existing segment file read-only.
+ */
+static bool open_file(const std::string& path, journal_file_t* f)
+{
+  f->fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (f->fd < 0) return false;
+
+  struct stat st{};
+  if (fstat(f->fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(journal_segment_hdr_t)))
+    return false;
+
+  const size_t size = static_cast<size_t>(st.st_size);
+  void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, f->fd, 0);
+  if (base == MAP_FAILED) return false;
+
+  madvise(base, size, MADV_SEQUENTIAL);
+  f->base = static_cast<uint8_t*>(base);
+  f->size = size;
+  return true;
+}
+
+
+/*
+ * Unmaps and closes a segment file. keep: truncate the file to keep
+ * bytes, or UINT64_MAX.
+ */
+static void close_file(journal_file_t* f, uint64_t keep)
+{
+  if (f->base)
+    munmap(f->base, f->size);
+
+  if (f->fd >= 0)
+  {
+    if (keep != UINT64_MAX)
+    {
+      // Best effort: a failed truncate only leaves zero padding behind used
+      [[maybe_unused]] const int truncated = ftruncate(f->fd, static_cast<off_t>(keep));
+    }
+    close(f->fd);
+  }
+
+  *f = journal_file_t{};
+}
+
+#endif
+
+
+/*
+ * Creates the current segment with room for at least one entry of
+ * min_entry bytes and initializes its header.
+ */
+static bool open_segment(journal_t* j, uint64_t min_entry)
+{
+  const uint64_t size = (std::max)(j->segment_bytes, sizeof(journal_segment_hdr_t) + min_entry);
+  if (!create_file(segment_path(j->path, j->index), size, &j->file))
+  {
+    close_file(&j->file, 0);
+    return false;
+  }
+
+  auto* h = reinterpret_cast<journal_segment_hdr_t*>(j->file.base);
+  h->magic = JOURNAL_MAGIC;
+  h->version = JOURNAL_VERSION;
+  h->index = j->index;
+  h->used.store(0, std::memory_order_release);
+  j->used = 0;
+  return true;
+}
+
+
+/*
+ * Checks the header of a mapped segment.
+ */
+static bool segment_valid(const journal_file_t& f, uint32_t index)
+{
+  const auto* h = reinterpret_cast<const journal_segment_hdr_t*>(f.base);
+  return h->magic == JOURNAL_MAGIC && h->version == JOURNAL_VERSION && h->index == index;
+}
+
+
+/*
+ * Closes the current segment, truncated to its header and entries.
+ */
+static void close_segment(journal_t* j)
+{
+  if (!j->file.base) return;
+  close_file(&j->file, sizeof(journal_segment_hdr_t) + j->used);
+}
+
+
+journal_t* journal_open(const char* path, uint64_t segment_bytes)
+{
+  if (!path || !*path) return nullptr;
+
+  auto* j = new journal_t();
+  j->path = path;
+  j->segment_bytes = (std::max)(segment_bytes ? segment_bytes : JOURNAL_SEGMENT_BYTES, JOURNAL_MIN_SEGMENT_BYTES);
+
+  // Segments of an earlier journal are contiguous from 0
+  for (uint32_t i = 0; std::remove(segment_path(j->path, i).c_str()) == 0; i++) {}
+
+  if (!open_segment(j, 0))
+  {
+    delete j;
+    return nullptr;
+  }
+  return j;
+}
+
+
+bool journal_append(journal_t* j, uint64_t time_ns, uint16_t type, uint16_t flags,
+  const uint8_t* data, uint32_t length)
+{
+  const uint64_t size = entry_size(length);
+
+  // Rotate: the current segment is full (or the last rotation failed)
+  if (!j->file.base || sizeof(journal_segment_hdr_t) + j->used + size > j->file.size)
+  {
+    if (j->file.base)
+    {
+      close_segment(j);
+      j->index++;
+    }
+    if (!open_segment(j, size)) return false;
+  }
+
+  auto* h = reinterpret_cast<journal_segment_hdr_t*>(j->file.base);
+  uint8_t* at = j->file.base + sizeof(journal_segment_hdr_t) + j->used;
+
+  const journal_entry_hdr_t entry{ time_ns, length, type, flags };
+  std::memcpy(at, &entry, sizeof(entry));
+  std::memcpy(at + sizeof(entry), data, length);
+
+  if (j->used == 0)
+    h->first_ns = time_ns;
+
+  // Publish the whole entry to concurrent readers
+  j->used += size;
+  h->used.store(j->used, std::memory_order_release);
+  j->count.store(j->count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  return true;
+}
+
+
+uint64_t journal_count(const journal_t* j)
+{
+  return j ? j->count.load(std::memory_order_relaxed) : 0;
+}
+
+
+void journal_close(journal_t* j)
+{
+  if (!j) return;
+  close_segment(j);
+  delete j;
+}
+
+
+/*
+ * Waits until due: sleeps through long gaps, yields through the last
+ * stretch (timer slack is ~1 ms on Windows, ~50 µs on Linux).
+ */
+static void pace_until(std::chrono::steady_clock::time_point due)
+{
+  constexpr auto slack = std::chrono::milliseconds(2);
+  if (due - std::chrono::steady_clock::now() > slack)
+    std::this_thread::sleep_until(due - slack);
+
+  while (std::chrono::steady_clock::now() < due)
+    std::this_thread::yield();
+}
+
+
+int64_t journal_replay(const char* path, shared_rb_t* rb, double speed, int32_t timeout_ms)
+{
+  if (!path || !rb) return -1;
+
+  const bool framed = (shared_rb_granted(rb) & SHARED_RB_FRAMED) != 0;
+  std::vector<uint8_t> scratch;
+  int64_t written = 0;
+
+  // Origin of the recorded and the replayed timeline
+  bool started = false;
+  uint64_t origin_ns = 0;
+  std::chrono::steady_clock::time_point origin;
+
+  for (uint32_t index = 0;; index++)
+  {
+    // The first missing (or foreign) segment ends the journal
+    journal_file_t file;
+    if (!open_file(segment_path(path, index), &file) || !segment_valid(file, index))
+    {
+      close_file(&file, UINT64_MAX);
+      return index == 0 ? -1 : written;
+    }
+
+    const auto* h = reinterpret_cast<const journal_segment_hdr_t*>(file.base);
+    const uint8_t* entries = file.base + sizeof(journal_segment_hdr_t);
+    const uint64_t used = (std::min)(h->used.load(std::memory_order_acquire),
+      file.size - sizeof(journal_segment_hdr_t));
+
+    for (uint64_t pos = 0; pos + sizeof(journal_entry_hdr_t) <= used;)
+    {
+      journal_entry_hdr_t entry;
+      std::memcpy(&entry, entries + pos, sizeof(entry));
+      if (pos + entry_size(entry.length) > used) break;
+
+      const uint8_t* data = entries + pos + sizeof(entry);
+      pos += entry_size(entry.length);
+
+      if (speed > 0)
+      {
+        if (!started)
+        {
+          started = true;
+          origin_ns = entry.time_ns;
+          origin = std::chrono::steady_clock::now();
+        }
+
+        const double gap = static_cast<double>(entry.time_ns - origin_ns) / speed;
+        pace_until(origin + std::chrono::nanoseconds(static_cast<int64_t>(gap)));
+      }
+
+      // Traced command: the recorded write stamp belongs to the old run
+      if ((entry.flags & SIDECAR_MSG_TRACED) && entry.length >= sizeof(sidecar_trace_hdr_t))
+      {
+        scratch.assign(data, data + entry.length);
+        const sidecar_trace_hdr_t stamp{ sidecar_trace_now() };
+        std::memcpy(scratch.data(), &stamp, sizeof(stamp));
+        data = scratch.data();
+      }
+
+      const bool ok = framed
+        ? shared_rb_write_record_ex(rb, entry.type, entry.flags, data, entry.length,
+          SHARED_RB_WRITE_BLOCK, timeout_ms) != 0
+        : shared_rb_write_ex(rb, data, entry.length, SHARED_RB_WRITE_BLOCK, timeout_ms) == entry.length;
+
+      if (!ok)
+      {
+        close_file(&file, UINT64_MAX);
+        return written;
+      }
+      written++;
+    }
+
+    close_file(&file, UINT64_MAX);
+  }
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+struct shared_rb_t;
+
+
+/*
+ * Command journal: the command stream a sidecar drained, recorded into
+ * memory-mapped segment files for later replay (sidecar_set_journal,
+ * sidecar_journal_replay). Internal to the library.
+ *
+ * Files:
+ *   <path>.000000, <path>.000001, ...  one per segment, in order
+ *
+ * Segment layout:
+ *   [journal_segment_hdr_t]            64 bytes
+ *   [journal_entry_hdr_t][payload]     entries back to back, each padded
+ *                                      to JOURNAL_ALIGN bytes
+ *
+ * A segment is created at its full size and filled front to back, so
+ * the writer only ever touches the next pages of one mapping (sequential
+ * writes, no syscall per entry). used is published after every entry;
+ * a reader that maps a segment while it is being written, or after a
+ * crash, sees every whole entry up to it. Closing a segment truncates
+ * the file to its used size.
+ */
+constexpr uint32_t JOURNAL_MAGIC = 0x314A4353;   // "SCJ1"
+constexpr uint32_t JOURNAL_VERSION = 1;
+constexpr uint32_t JOURNAL_ALIGN = 8;
+
+// Default and smallest segment size (see sidecar_set_journal).
+constexpr uint64_t JOURNAL_SEGMENT_BYTES = 64ull << 20;
+constexpr uint64_t JOURNAL_MIN_SEGMENT_BYTES = 64ull << 10;
+
+struct journal_segment_hdr_t
+{
+  uint32_t magic;                 // JOURNAL_MAGIC
+  uint32_t version;               // JOURNAL_VERSION
+  uint32_t index;                 // Segment number, from 0
+  uint32_t reserved;              // Zero
+  std::atomic<uint64_t> used;     // Entry bytes after this header (release)
+  uint64_t first_ns;              // Timestamp of the first entry
+  uint8_t pad[32];                // Zero
+};
+
+static_assert(sizeof(journal_segment_hdr_t) == 64, "journal_segment_hdr_t is part of the file format");
+
+
+/*
+ * One journaled command: a record of the command ring, or a raw read
+ * chunk (type and flags 0) if the ring is not framed.
+ */
+struct journal_entry_hdr_t
+{
+  uint64_t time_ns;               // sidecar_trace_now() when the sidecar drained it
+  uint32_t length;                // Payload bytes (trace / RPC prefixes included)
+  uint16_t type;                  // Record type
+  uint16_t flags;                 // Record flags (sidecar_msg_flags_t)
+};
+
+
+/*
+ * Opaque journal writer. Single writer: only the sidecar worker appends.
+ */
+struct journal_t;
+
+
+/*
+ * Creates a journal at path, starting with segment 0.
+ *
+ * Parameters:
+ *   path          - File prefix; segments are "<path>.NNNNNN"
+ *   segment_bytes - Size of one segment (at least JOURNAL_MIN_SEGMENT_BYTES)
+ *
+ * Returns:
+ *   Journal handle, or nullptr if the first segment cannot be created
+ *
+ * Notes:
+ *   - Removes the segments of an earlier journal at the same path, so a
+ *     replay never continues into stale files
+ */
+journal_t* journal_open(const char* path, uint64_t segment_bytes);
+
+
+/*
+ * Appends one entry; rotates to the next segment when the current one
+ * is full. An entry larger than a segment gets a segment of its own.
+ *
+ * Returns:
+ *   false if the next segment cannot be created (the entry is lost)
+ */
+bool journal_append(journal_t* j, uint64_t time_ns, uint16_t type, uint16_t flags,
+  const uint8_t* data, uint32_t length);
+
+
+/*
+ * Returns the number of entries appended so far.
+ */
+uint64_t journal_count(const journal_t* j);
+
+
+/*
+ * Closes the current segment (truncated to its used size) and frees
+ * the journal.
+ */
+void journal_close(journal_t* j);
+
+
+/*
+ * Writes every entry of a journal into a ring, in order.
+ *
+ * Parameters:
+ *   path       - File prefix given to journal_open
+ *   rb         - Target ring (producer side); framed rings get one record
+ *                per entry, raw rings the payload bytes
+ *   speed      - 1.0 keeps the recorded gaps between entries, 2.0 halves
+ *                them, etc.; 0 or negative writes as fast as the ring drains
+ *   timeout_ms - Longest wait for ring space per entry; negative waits
+ *                forever
+ *
+ * Returns:
+ *   Number of entries written, or -1 if segment 0 cannot be opened
+ *
+ * Notes:
+ *   - Entries are written with SHARED_RB_WRITE_BLOCK, so none is lost;
+ *     a wait that times out ends the replay early
+ *   - Traced commands (SIDECAR_MSG_TRACED) are re-stamped right before
+ *     the write, so tracing measures the replayed run
+ */
+int64_t journal_replay(const char* path, shared_rb_t* rb, double speed, int32_t timeout_ms);
@@ -0,0 +1,412 @@
+#include "pch.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sidecar_api.h"
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+
+// Restart backoff of the supervisor (see sidecar_process_desc_t).
+constexpr uint32_t SIDECAR_RESTART_DELAY_MS = 100;
+constexpr uint32_t SIDECAR_RESTART_MAX_DELAY_MS = 5000;
+
+// A worker that ran at least this long resets the backoff.
+constexpr auto SIDECAR_RESTART_STABLE = std::chrono::seconds(10);
+
+
+/*
+ * One worker process: its handle and the write end of its standard
+ * input pipe. Only the supervisor thread replaces it; the pid stays
+ * valid until reap_child, so kill_child never hits a recycled pid.
+ */
+struct child_t
+{
+#if defined(_WIN32)
+  HANDLE process = nullptr;     // Process handle (waitable)
+  HANDLE input = nullptr;       // Write end of the stdin pipe
+  DWORD pid = 0;
+#else
+  pid_t pid = 0;
+  int input = -1;               // Write end of the stdin pipe
+#endif
+};
+
+
+/*
+ * Internal representation of a supervised worker.
+ *
+ * lock guards child, alive and stopping; changed signals the supervisor
+ * (stop requested) and sidecar_process_stop (worker reaped).
+ */
+struct sidecar_process_t
+{
+  std::vector<std::string> argv;        // Executable and arguments
+  uint32_t max_restarts = 0;
+  uint32_t restart_delay_ms = 0;
+
+  std::mutex lock;
+  std::condition_variable changed;
+  child_t child;                        // Current worker
+  bool alive = false;                   // child not reaped yet
+  bool stopping = false;                // sidecar_process_stop was called
+
+  std::atomic<int32_t> state{ SIDECAR_PROCESS_STOPPED };
+  std::atomic<int64_t> pid{ 0 };
+  std::atomic<uint32_t> restarts{ 0 };
+  std::atomic<int32_t> exit_code{ -1 };
+  std::thread supervisor;
+};
+
+
+#if defined(_WIN32)
+
+/*
+ * Quotes one argument so that CommandLineToArgvW / the CRT parse it
+ * back unchanged (backslashes are only special before a quote).
+ */
+static std::string quote_arg(const std::string& arg)
+{
+  if (!arg.empty() && arg.find_first_of(" \t\"") == std::string::npos) return arg;
+
+  std::string quoted = "\"";
+  size_t slashes = 0;
+  for (const char c : arg)
+  {
+    if (c == '\\')
+    {
+      slashes++;
+      continue;
+    }
+    quoted.append(c == '"' ? slashes * 2 + 1 : slashes, '\\');
+    quoted += c;
+    slashes = 0;
+  }
+  quoted.append(slashes * 2, '\\');
+  quoted += '"';
+  return quoted;
+}
+
+
+/*
+ * Starts the worker with an inheritable read end of a new pipe as its
+ * standard input; the write end stays with the launcher only.
+ */
+static bool spawn_child(const std::vector<std::string>& argv, child_t* child)
+{
+  SECURITY_ATTRIBUTES inherit{ static_cast<DWORD>(sizeof(inherit)), nullptr, TRUE };
+  HANDLE read = nullptr, write = nullptr;
+  if (!CreatePipe(&read, &write, &inherit, 0)) return false;
+  SetHandleInformation(write, HANDLE_FLAG_INHERIT, 0);
+
+  std::string line;
+  for (const std::string& arg : argv)
+    line += (line.empty() ? "" : " ") + quote_arg(arg);
+
+  STARTUPINFOA startup{};
+  startup.cb = sizeof(startup);
+  startup.dwFlags = STARTF_USESTDHANDLES;
+  startup.hStdInput = read;
+  startup.hStdOutput = GetStdHandle(STD_OUTPUT_HANDLE);
+  startup.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+  PROCESS_INFORMATION info{};
+  const BOOL started = CreateProcessA(argv[0].c_str(), line.data(), nullptr, nullptr, TRUE, 0,
+    nullptr, nullptr, &startup, &info);
+
+  CloseHandle(read);
+  if (!started)
+  {
+    CloseHandle(write);
+    return false;
+  }
+
+  CloseHandle(info.hThread);
+  child->process = info.hProcess;
+  child->input = write;
+  child->pid = info.dwProcessId;
+  return true;
+}
+
+
+static void wait_child(const child_t& child)
+{
+  WaitForSingleObject(child.process, INFINITE);
+}
+
+
+static void close_input(child_t* child)
+{
+  if (!child->input) return;
+  CloseHandle(child->input);
+  child->input = nullptr;
+}
+
+
+static void kill_child(const child_t& child)
+{
+  TerminateProcess(child.process, 1);
+}
+
+
+/*
+ * Collects the exit code of an exited worker and releases its handles.
+ */
+static int32_t reap_child(child_t* child)
+{
+  DWORD code = 0;
+  GetExitCodeProcess(child->process, &code);
+  CloseHandle(child->process);
+  close_input(child);
+  *child = child_t{};
+  return static_cast<int32_t>(code);
+}
+
+#else
+
+/*
+ * Starts the worker with the read end of a new pipe as its standard
+ * input. Both ends are close-on-exec, so no other child inherits them;
+ * dup2 onto fd 0 clears the flag for the worker.
+ */
+static bool spawn_child(const std::vector<std::string>& argv, child_t* child)
+{
+  int fds[2];
+  if (pipe2(fds, O_CLOEXEC) != 0) return false;
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, fds[0], STDIN_FILENO);
+
+  std::vector<char*> args;
+  for (const std::string& arg : argv)
+    args.push_back(const_cast<char*>(arg.c_str()));
+  args.push_back(nullptr);
+
+  pid_t pid = 0;
+  const int result = posix_spawn(&pid, args[0], &actions, nullptr, args.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+
+  close(fds[0]);
+  if (result != 0)
+  {
+    close(fds[1]);
+    return false;
+  }
+
+  child->pid = pid;
+  child->input = fds[1];
+  return true;
+}
+
+
+/*
+ * Waits for the worker to exit without reaping it (WNOWAIT): the pid
+ * stays reserved until reap_child runs under the lock.
+ */
+static void wait_child(const child_t& child)
+{
+  siginfo_t info{};
+  while (waitid(P_PID, static_cast<id_t>(child.pid), &info, WEXITED | WNOWAIT) != 0 && errno == EINTR) {}
+}
+
+
+static void close_input(child_t* child)
+{
+  if (child->input < 0) return;
+  close(child->input);
+  child->input = -1;
+}
+
+
+static void kill_child(const child_t& child)
+{
+  kill(child.pid, SIGKILL);
+}
+
+
+static int32_t reap_child(child_t* child)
+{
+  int status = 0;
+  int32_t code = -1;
+  if (waitpid(child->pid, &status, 0) == child->pid)
+    code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+
+  close_input(child);
+  *child = child_t{};
+  return code;
+}
+
+#endif
+
+
+/*
+ * Returns false for the exit codes a restart cannot fix.
+ */
+static bool restartable(int32_t code)
+{
+  return code != SIDECAR_EXIT_USAGE && code != SIDECAR_EXIT_PLUGIN && code != SIDECAR_EXIT_RINGS;
+}
+
+
+/*
+ * The supervisor thread of one worker.
+ *
+ * Waits for the worker to exit, reaps it, and unless a stop was
+ * requested restarts it after the backoff delay. A failed spawn counts
+ * as a restart and backs off again. Ends when stopping, on a
+ * configuration error, or when the restarts are used up.
+ */
+static void supervise(sidecar_process_t* proc)
+{
+  uint32_t delay = proc->restart_delay_ms;
+  auto started = std::chrono::steady_clock::now();
+
+  for (;;)
+  {
+    wait_child(proc->child);
+
+    std::unique_lock<std::mutex> guard(proc->lock);
+    const int32_t code = reap_child(&proc->child);
+    proc->alive = false;
+    proc->pid.store(0);
+    proc->exit_code.store(code);
+    proc->changed.notify_all();
+
+    if (proc->stopping) break;
+    if (!restartable(code))
+    {
+      proc->state.store(SIDECAR_PROCESS_FAILED);
+      return;
+    }
+
+    // A worker that ran for a while restarts quickly again
+    if (std::chrono::steady_clock::now() - started >= SIDECAR_RESTART_STABLE)
+      delay = proc->restart_delay_ms;
+
+    proc->state.store(SIDECAR_PROCESS_RESTARTING);
+
+    bool spawned = false;
+    while (!spawned && proc->restarts.load() < proc->max_restarts)
+    {
+      if (proc->changed.wait_for(guard, std::chrono::milliseconds(delay), [proc] { return proc->stopping; }))
+        break;
+
+      delay = (std::min)(delay * 2, SIDECAR_RESTART_MAX_DELAY_MS);
+      proc->restarts.fetch_add(1);
+      spawned = spawn_child(proc->argv, &proc->child);
+    }
+
+    if (!spawned)
+    {
+      proc->state.store(proc->stopping ? SIDECAR_PROCESS_STOPPED : SIDECAR_PROCESS_FAILED);
+      return;
+    }
+
+    proc->alive = true;
+    proc->pid.store(static_cast<int64_t>(proc->child.pid));
+    proc->state.store(SIDECAR_PROCESS_RUNNING);
+    started = std::chrono::steady_clock::now();
+  }
+
+  proc->state.store(SIDECAR_PROCESS_STOPPED);
+}
+
+
+/*
+ * Builds the worker's command line, starts it and hands it to a new
+ * supervisor thread.
+ */
+EXP32 sidecar_process_t* sidecar_process_spawn(const sidecar_process_desc_t* desc)
+{
+  if (!desc || !desc->executable || !desc->channel.commands.name) return nullptr;
+
+  auto* proc = new sidecar_process_t();
+  proc->max_restarts = desc->max_restarts;
+  proc->restart_delay_ms = desc->restart_delay_ms ? desc->restart_delay_ms : SIDECAR_RESTART_DELAY_MS;
+
+  proc->argv = { desc->executable, "--commands", desc->channel.commands.name };
+  if (desc->channel.events.name)
+    proc->argv.insert(proc->argv.end(), { "--events", desc->channel.events.name });
+  if (desc->plugin)
+    proc->argv.insert(proc->argv.end(), { "--plugin", desc->plugin });
+  for (uint32_t i = 0; desc->args && i < desc->arg_count; i++)
+    proc->argv.emplace_back(desc->args[i]);
+
+  if (!spawn_child(proc->argv, &proc->child))
+  {
+    delete proc;
+    return nullptr;
+  }
+
+  proc->alive = true;
+  proc->pid.store(static_cast<int64_t>(proc->child.pid));
+  proc->state.store(SIDECAR_PROCESS_RUNNING);
+  proc->supervisor = std::thread(supervise, proc);
+  return proc;
+}
+
+
+EXP32 int32_t sidecar_process_state(sidecar_process_t* proc)
+{
+  return proc ? proc->state.load() : SIDECAR_PROCESS_STOPPED;
+}
+
+
+EXP32 int64_t sidecar_process_pid(sidecar_process_t* proc)
+{
+  return proc ? proc->pid.load() : 0;
+}
+
+
+EXP32 uint32_t sidecar_process_restarts(sidecar_process_t* proc)
+{
+  return proc ? proc->restarts.load() : 0;
+}
+
+
+EXP32 int32_t sidecar_process_exit_code(sidecar_process_t* proc)
+{
+  return proc ? proc->exit_code.load() : -1;
+}
+
+
+/*
+ * Closes the worker's stdin (its stop signal), waits for the supervisor
+ * to reap it, and kills it if the timeout expires first.
+ */
+EXP32 void sidecar_process_stop(sidecar_process_t* proc, int32_t timeout_ms)
+{
+  if (!proc) return;
+
+  {
+    std::unique_lock<std::mutex> guard(proc->lock);
+    proc->stopping = true;
+    proc->changed.notify_all();
+    close_input(&proc->child);
+
+    const auto reaped = [proc] { return !proc->alive; };
+    if (timeout_ms < 0)
+      proc->changed.wait(guard, reaped);
+    else if (!proc->changed.wait_for(guard, std::chrono::milliseconds(timeout_ms), reaped))
+      kill_child(proc->child);
+  }
+
+  proc->supervisor.join();
+  delete proc;
+}
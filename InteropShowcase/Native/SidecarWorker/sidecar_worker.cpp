@@ -0,0 +1,230 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "sidecar_api.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+
+/*
+ * SidecarWorker: runs one sidecar instance in a process of its own
+ * (see "Out-of-process sidecar" in sidecar_api.h for the command line).
+ *
+ * Started by sidecar_process_spawn, or by hand for debugging; the
+ * worker stops when its standard input reaches end of file (Ctrl+D,
+ * Ctrl+Z on Windows).
+ */
+
+
+/*
+ * Built-in handler, used without --plugin: plain commands are acked by
+ * the worker loop, RPC requests are echoed back as their response.
+ */
+static void echo_init() {}
+static void echo_dispose() {}
+static void echo_process(const uint8_t*, int) {}
+
+static void echo_batch(const sidecar_msg_t* messages, int count)
+{
+  for (int i = 0; i < count; i++)
+    if (messages[i].flags & SIDECAR_MSG_RPC)
+      sidecar_respond(messages[i].correlation_id, 0, messages[i].data, static_cast<uint32_t>(messages[i].length));
+}
+
+static const sidecar_host_vtable_t g_echo{ echo_init, echo_dispose, echo_process, nullptr, echo_batch };
+
+
+/*
+ * One --lane argument.
+ */
+struct worker_lane_t
+{
+  std::string name;
+  int32_t priority = 0;
+  uint32_t weight = 1;
+};
+
+
+/*
+ * Parsed command line.
+ */
+struct worker_options_t
+{
+  const char* commands = nullptr;
+  const char* events = nullptr;
+  const char* plugin = nullptr;
+  std::vector<worker_lane_t> lanes;
+  int32_t lane_policy = SIDECAR_LANES_STRICT;
+  uint32_t batch_count = 0;       // 0: library default
+  uint32_t batch_bytes = 0;
+  bool zero_copy = false;
+  uint64_t affinity = 0;          // 0: every CPU
+  const char* arena = nullptr;
+};
+
+
+/*
+ * Parses "<name>:<priority>:<weight>"; the name may contain colons
+ * itself, so the numbers are split off from the right.
+ */
+static bool parse_lane(const char* text, worker_lane_t* lane)
+{
+  const std::string value = text;
+  const size_t second = value.rfind(':');
+  const size_t first = second == std::string::npos || second == 0 ? std::string::npos : value.rfind(':', second - 1);
+  if (first == std::string::npos || first == 0) return false;
+
+  lane->name = value.substr(0, first);
+  lane->priority = std::atoi(value.c_str() + first + 1);
+  lane->weight = static_cast<uint32_t>(std::strtoul(value.c_str() + second + 1, nullptr, 10));
+  return true;
+}
+
+
+/*
+ * Parses argv into options. Returns false on an unknown option, a
+ * missing value or without --commands.
+ */
+static bool parse_options(int argc, char** argv, worker_options_t* options)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    const char* option = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+    if (std::strcmp(option, "--zero-copy") == 0)
+    {
+      options->zero_copy = true;
+      continue;
+    }
+
+    if (!value) return false;
+    i++;
+
+    if (std::strcmp(option, "--commands") == 0)
+      options->commands = value;
+    else if (std::strcmp(option, "--events") == 0)
+      options->events = value;
+    else if (std::strcmp(option, "--plugin") == 0)
+      options->plugin = value;
+    else if (std::strcmp(option, "--lane") == 0)
+    {
+      worker_lane_t lane;
+      if (!parse_lane(value, &lane)) return false;
+      options->lanes.push_back(lane);
+    }
+    else if (std::strcmp(option, "--lane-policy") == 0)
+    {
+      if (std::strcmp(value, "weighted") == 0) options->lane_policy = SIDECAR_LANES_WEIGHTED;
+      else if (std::strcmp(value, "strict") == 0) options->lane_policy = SIDECAR_LANES_STRICT;
+      else return false;
+    }
+    else if (std::strcmp(option, "--batch") == 0)
+    {
+      char* end = nullptr;
+      options->batch_count = static_cast<uint32_t>(std::strtoul(value, &end, 10));
+      if (*end != ':') return false;
+      options->batch_bytes = static_cast<uint32_t>(std::strtoul(end + 1, nullptr, 10));
+    }
+    else if (std::strcmp(option, "--affinity") == 0)
+      options->affinity = std::strtoull(value, nullptr, 0);
+    else if (std::strcmp(option, "--arena") == 0)
+      options->arena = value;
+    else
+      return false;
+  }
+  return options->commands != nullptr;
+}
+
+
+/*
+ * Loads a plugin library and returns its callback table, or nullptr.
+ * The library stays loaded until the process exits.
+ */
+static const sidecar_host_vtable_t* load_plugin(const char* path)
+{
+#if defined(_WIN32)
+  HMODULE library = LoadLibraryA(path);
+  if (!library) return nullptr;
+  auto entry = reinterpret_cast<sidecar_plugin_entry_t>(GetProcAddress(library, SIDECAR_PLUGIN_ENTRY));
+#else
+  void* library = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+  if (!library) return nullptr;
+  auto entry = reinterpret_cast<sidecar_plugin_entry_t>(dlsym(library, SIDECAR_PLUGIN_ENTRY));
+#endif
+  return entry ? entry() : nullptr;
+}
+
+
+int main(int argc, char** argv)
+{
+  worker_options_t options;
+  if (!parse_options(argc, argv, &options))
+  {
+    std::fprintf(stderr, "usage: %s --commands <name> [--events <name>] [--plugin <library>]\n"
+      "  [--lane <name>:<priority>:<weight>]... [--lane-policy strict|weighted]\n"
+      "  [--batch <count>:<bytes>] [--zero-copy] [--affinity <mask>]\n"
+      "  [--arena <name>]\n", argv[0]);
+    return SIDECAR_EXIT_USAGE;
+  }
+
+  const sidecar_host_vtable_t* host = options.plugin ? load_plugin(options.plugin) : &g_echo;
+  if (!host)
+  {
+    std::fprintf(stderr, "SidecarWorker: cannot load plugin '%s'\n", options.plugin);
+    return SIDECAR_EXIT_PLUGIN;
+  }
+
+  // The host created the rings; open them by name (capacity is read from the header)
+  const sidecar_channel_desc_t channel{ { options.commands, 0 }, { options.events, 0 } };
+  sidecar_t* sc = sidecar_create(host, &channel);
+  if (!sc)
+  {
+    std::fprintf(stderr, "SidecarWorker: cannot open the rings of '%s'\n", options.commands);
+    return SIDECAR_EXIT_RINGS;
+  }
+
+  for (const worker_lane_t& lane : options.lanes)
+  {
+    const sidecar_rb_desc_t ring{ lane.name.c_str(), 0 };
+    if (sidecar_add_lane(sc, &ring, lane.priority, lane.weight) < 0)
+    {
+      std::fprintf(stderr, "SidecarWorker: cannot open lane '%s'\n", lane.name.c_str());
+      sidecar_destroy(sc);
+      return SIDECAR_EXIT_RINGS;
+    }
+  }
+
+  if (options.arena && !sidecar_set_arena(sc, options.arena))
+  {
+    std::fprintf(stderr, "SidecarWorker: cannot open arena '%s'\n", options.arena);
+    sidecar_destroy(sc);
+    return SIDECAR_EXIT_RINGS;
+  }
+
+  sidecar_set_lane_policy(sc, options.lane_policy);
+  if (options.batch_count)
+    sidecar_set_batch_limits(sc, options.batch_count, options.batch_bytes);
+  sidecar_set_zero_copy(sc, options.zero_copy ? 1 : 0);
+
+  if (options.affinity)
+  {
+    const sidecar_thread_options_t thread{ options.affinity, SIDECAR_SCHED_DEFAULT, 0, nullptr };
+    sidecar_set_thread_options(sc, &thread);
+  }
+
+  sidecar_start_ex(sc);
+
+  // Run until the launcher closes our standard input, or the host dies
+  while (std::getchar() != EOF) {}
+
+  sidecar_destroy(sc);
+  return SIDECAR_EXIT_OK;
+}